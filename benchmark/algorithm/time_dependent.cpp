@@ -0,0 +1,167 @@
+#include "algorithm/dijkstra.hpp"
+#include "algorithm/time_dependent_dijkstra.hpp"
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "graph/profile.hpp"
+#include "graph/routing.hpp"
+#include "graph/time_dependent.hpp"
+#include "suite/measurement.hpp"
+#include "suite/synthetic_graph.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Measures the overhead of time-dependent queries over static ones. Both
+// engines run the same random queries on the synthetic graphs of the suite
+// (see suite/synthetic_graph.hpp), the static Dijkstra on the static travel
+// times, the time-dependent one with every edge referring to one of a few
+// shared profiles. Usage: bench-time-dependent [grid width] [queries]
+//
+// Results are printed as JSON lines, see suite/measurement.hpp. The overhead
+// is the ratio of the throughputs, it is printed to stderr as well.
+//
+// Build in release mode (-DCMAKE_BUILD_TYPE=Release).
+
+using namespace project_x;
+
+namespace {
+using benchmark::Measurement;
+using location_type = algorithm::Location<graph::WeightTimeDistance>;
+
+struct Edge {
+  NodeID source, target;
+  graph::WeightTimeDistance cost;
+  graph::ProfileID profile;
+};
+
+// quarter hour profiles with a morning and an evening peak
+graph::ProfileTable make_profiles(std::mt19937 &generator) {
+  graph::ProfileTable profiles;
+  std::uniform_real_distribution<double> peak(1.2, 3.0);
+  for (int profile = 0; profile < 16; ++profile) {
+    std::vector<double> factors(96, 1.0);
+    auto const morning = peak(generator), evening = peak(generator);
+    for (int sample = 28; sample < 40; ++sample)
+      factors[sample] = morning;
+    for (int sample = 64; sample < 76; ++sample)
+      factors[sample] = evening;
+    profiles.add(factors);
+  }
+  return profiles;
+}
+
+// the synthetic graph, every edge referring to a random profile
+graph::TimeDependentGraph
+make_time_dependent_graph(benchmark::SyntheticGraph const &synthetic,
+                          std::mt19937 &generator) {
+  auto profiles = make_profiles(generator);
+  std::uniform_int_distribution<graph::ProfileID> profile(0,
+                                                          profiles.size() - 1);
+  std::vector<Edge> edges;
+  edges.reserve(synthetic.edges.size());
+  for (auto const &edge : synthetic.edges)
+    edges.push_back({edge.source, edge.target, edge.cost, profile(generator)});
+
+  graph::TimeDependentGraph graph =
+      graph::ForwardStarFactory::produce_directed_from_edges(
+          synthetic.number_of_nodes, edges);
+  graph::DecoratorFactory factory;
+  factory.decorate_layers(
+      graph, edges,
+      factory.layer<graph::RoutingGraph>(
+          [](auto const &edge) { return edge.cost; }),
+      factory.layer<graph::TimeDependentGraph>(
+          [](auto const &edge) { return edge.profile; }));
+  factory.attach_profiles(graph, std::move(profiles));
+  return graph;
+}
+
+void bench_queries(benchmark::SyntheticGraph const &synthetic,
+                   std::size_t const queries, std::uint64_t &checksum) {
+  std::mt19937 generator(42);
+  auto const graph = make_time_dependent_graph(synthetic, generator);
+
+  std::uniform_int_distribution<NodeID> node(0, synthetic.number_of_nodes - 1);
+  std::uniform_int_distribution<std::uint32_t> departure(
+      0, graph::ProfileTable::period - 1);
+  std::vector<std::pair<NodeID, NodeID>> pairs;
+  std::vector<std::uint32_t> departures;
+  for (std::size_t query = 0; query < queries; ++query) {
+    pairs.emplace_back(node(generator), node(generator));
+    departures.push_back(departure(generator));
+  }
+
+  Measurement static_query("time_dependent/static_query", synthetic.name,
+                           "query");
+  {
+    algorithm::Dijkstra<graph::RoutingGraph> dijkstra(graph);
+    for (auto const &pair : pairs)
+      static_query.sample(1, [&] {
+        checksum += dijkstra(location_type{pair.first, {0, 0, 0}},
+                             location_type{pair.second, {0, 0, 0}})
+                        .segments.size();
+      });
+  }
+  static_query.report();
+
+  Measurement query("time_dependent/query", synthetic.name, "query");
+  {
+    algorithm::TimeDependentDijkstra<graph::TimeDependentGraph> dijkstra(
+        graph);
+    for (std::size_t index = 0; index < queries; ++index)
+      query.sample(1, [&] {
+        checksum += dijkstra({pairs[index].first, 0},
+                             {pairs[index].second, 0}, departures[index])
+                        .segments.size();
+      });
+  }
+  query.report();
+  std::cerr << synthetic.name << " overhead: " << std::fixed
+            << std::setprecision(2)
+            << query.total().seconds / static_query.total().seconds << "x"
+            << std::endl;
+
+  // the profile evaluation alone, for all edges at once
+  std::vector<graph::ProfileID> ids(graph.number_of_edges());
+  std::vector<std::uint32_t> times(ids.size()), result(ids.size());
+  for (EdgeID eid = 0; eid < ids.size(); ++eid) {
+    ids[eid] = graph.profile_id(eid);
+    times[eid] = graph.cost(eid).time;
+  }
+  Measurement evaluation("profile_table/travel_times", synthetic.name, "edge");
+  for (auto const at : departures) {
+    evaluation.sample(ids.size(), [&] {
+      graph.profiles().travel_times(ids.size(), ids.data(), times.data(), at,
+                                    result.data());
+    });
+    checksum += result[at % result.size()];
+  }
+  evaluation.report();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  NodeID const width = argc > 1 ? std::stoull(argv[1]) : 300;
+  std::size_t const queries = argc > 2 ? std::stoull(argv[2]) : 100;
+  benchmark::report_run("time-dependent",
+                        {{"width", width}, {"queries", queries}});
+
+  // checksums keep the queries from being optimised away
+  std::uint64_t checksum = 0;
+  std::vector<benchmark::SyntheticGraph> const inputs = {
+      benchmark::make_grid(width),
+      benchmark::make_random_geometric(width * width),
+      benchmark::make_road_like(width)};
+  for (auto const &synthetic : inputs)
+    bench_queries(synthetic, queries, checksum);
+
+  std::cerr << "checksum: " << checksum << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#include "algorithm/dijkstra.hpp"
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+#include "graph/traffic_overlay.hpp"
+#include "suite/measurement.hpp"
+#include "suite/synthetic_graph.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Measures the overhead of querying through a live traffic overlay. The same
+// random queries run on the synthetic graphs of the suite (see
+// suite/synthetic_graph.hpp) without overlay, through an overlay without
+// updates and through one with a few thousand updated edges.
+// Usage: bench-traffic-overlay [grid width] [queries] [updates]
+//
+// Results are printed as JSON lines, see suite/measurement.hpp. The overheads
+// are printed to stderr as well.
+//
+// Build in release mode (-DCMAKE_BUILD_TYPE=Release).
+
+using namespace project_x;
+
+namespace {
+using benchmark::Measurement;
+using location_type = algorithm::Location<graph::WeightTimeDistance>;
+
+template <typename graph_type>
+Measurement run(std::string const &name, std::string const &input,
+                graph_type const &graph,
+                std::vector<std::pair<NodeID, NodeID>> const &pairs,
+                std::uint64_t &checksum) {
+  Measurement measurement(name, input, "query");
+  algorithm::Dijkstra<graph_type> dijkstra(graph);
+  for (auto const &pair : pairs)
+    measurement.sample(1, [&] {
+      checksum += dijkstra(location_type{pair.first, {0, 0, 0}},
+                           location_type{pair.second, {0, 0, 0}})
+                      .segments.size();
+    });
+  measurement.report();
+  return measurement;
+}
+
+void bench_overlay(benchmark::SyntheticGraph const &synthetic,
+                   std::size_t const queries, std::size_t const updates,
+                   std::uint64_t &checksum) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<NodeID> node(0, synthetic.number_of_nodes - 1);
+  std::vector<std::pair<NodeID, NodeID>> pairs;
+  for (std::size_t query = 0; query < queries; ++query)
+    pairs.emplace_back(node(generator), node(generator));
+
+  auto graph = benchmark::make_routing_graph(synthetic);
+  auto const plain = run("traffic_overlay/baseline_query", synthetic.name,
+                         graph, pairs, checksum);
+
+  // large enough for all updates, so they are not folded implicitly
+  graph::TrafficOverlay<graph::RoutingGraph> overlay(
+      std::move(graph), std::max<std::size_t>(1, 2 * updates));
+  auto const empty = run("traffic_overlay/query", synthetic.name, overlay,
+                         pairs, checksum);
+
+  std::uniform_int_distribution<EdgeID> edge(0, synthetic.edges.size() - 1);
+  Measurement update("traffic_overlay/update", synthetic.name, "update");
+  for (std::size_t index = 0; index < updates; ++index) {
+    auto const eid = edge(generator);
+    auto const cost = overlay.cost(eid) * 1.5;
+    update.sample(1, [&] { overlay.update(eid, cost); });
+  }
+  update.report();
+  auto const updated = run("traffic_overlay/updated_query", synthetic.name,
+                           overlay, pairs, checksum);
+
+  Measurement fold("traffic_overlay/fold", synthetic.name, "fold");
+  fold.sample(1, [&] { overlay.fold(); });
+  fold.report();
+
+  auto const overhead = [&plain](Measurement const &measurement) {
+    return measurement.total().seconds / plain.total().seconds;
+  };
+  std::cerr << synthetic.name << " overhead: " << std::fixed
+            << std::setprecision(2) << overhead(empty) << "x without, "
+            << overhead(updated) << "x with updates" << std::endl;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  NodeID const width = argc > 1 ? std::stoull(argv[1]) : 300;
+  std::size_t const queries = argc > 2 ? std::stoull(argv[2]) : 100;
+  std::size_t const updates = argc > 3 ? std::stoull(argv[3]) : 5000;
+  benchmark::report_run(
+      "traffic-overlay",
+      {{"width", width}, {"queries", queries}, {"updates", updates}});
+
+  // checksums keep the queries from being optimised away
+  std::uint64_t checksum = 0;
+  std::vector<benchmark::SyntheticGraph> const inputs = {
+      benchmark::make_grid(width),
+      benchmark::make_random_geometric(width * width),
+      benchmark::make_road_like(width)};
+  for (auto const &synthetic : inputs)
+    bench_overlay(synthetic, queries, updates, checksum);
+
+  std::cerr << "checksum: " << checksum << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include "geometry/polyline.hpp"
+#include "suite/measurement.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Measures polyline encoding and decoding on a long random walk, comparing the
+// block encoder to the textbook loop appending character by character.
+// Usage: bench-polyline [coordinates] [repetitions]
+//
+// Results are printed as JSON lines, see suite/measurement.hpp.
+//
+// Build in release mode (-DCMAKE_BUILD_TYPE=Release).
+
+using namespace project_x;
+
+namespace {
+using benchmark::Measurement;
+
+// the reference algorithm of the format description
+void encode_textbook(std::vector<std::int32_t> const &latitudes,
+                     std::vector<std::int32_t> const &longitudes,
+                     std::string &output) {
+  auto const add = [&output](std::int64_t const delta) {
+    std::uint64_t value = delta < 0 ? ~(delta << 1) : delta << 1;
+    while (value >= 0x20) {
+      output.push_back(static_cast<char>((0x20 | (value & 0x1F)) + 63));
+      value >>= 5;
+    }
+    output.push_back(static_cast<char>(value + 63));
+  };
+  std::int64_t previous_latitude = 0, previous_longitude = 0;
+  for (std::size_t index = 0; index < latitudes.size(); ++index) {
+    add(latitudes[index] - previous_latitude);
+    add(longitudes[index] - previous_longitude);
+    previous_latitude = latitudes[index];
+    previous_longitude = longitudes[index];
+  }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::size_t const count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+  std::size_t const repetitions = argc > 2 ? std::stoull(argv[2]) : 10;
+  benchmark::report_run("polyline", {{"coordinates", count},
+                                     {"repetitions", repetitions}});
+
+  // a route through a city: steps of a few meters
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::int32_t> step(-200, 200);
+  std::vector<std::int32_t> latitudes(count), longitudes(count);
+  std::int32_t latitude = 5252000, longitude = 1340500;
+  for (std::size_t index = 0; index < count; ++index) {
+    latitude += step(generator);
+    longitude += step(generator);
+    latitudes[index] = latitude;
+    longitudes[index] = longitude;
+  }
+
+  // checksums keep the work from being optimised away
+  std::uint64_t checksum = 0;
+  std::string textbook;
+  Measurement reference("polyline/textbook_encode", "random_walk",
+                        "coordinate");
+  for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+    reference.sample(count, [&] {
+      textbook.clear();
+      encode_textbook(latitudes, longitudes, textbook);
+    });
+    checksum += textbook.size();
+  }
+  reference.report();
+
+  using geometry::polyline::Precision;
+  std::vector<char> encoded(geometry::polyline::max_encoded_size(count));
+  std::size_t size = 0;
+  for (auto const precision : {Precision::polyline5, Precision::polyline6}) {
+    auto const digits = precision == Precision::polyline5 ? std::string("5")
+                                                          : std::string("6");
+    Measurement encode("polyline/encode" + digits, "random_walk",
+                       "coordinate");
+    for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+      encode.sample(count, [&] {
+        size = geometry::polyline::encode(count, latitudes.data(),
+                                          longitudes.data(), encoded.data(),
+                                          precision);
+      });
+      checksum += size;
+    }
+    encode.report();
+    if (precision == Precision::polyline5 &&
+        std::string(encoded.data(), size) != textbook) {
+      std::cerr << "polyline5 differs from the textbook encoding" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::vector<std::int32_t> decoded_latitudes(size / 2),
+        decoded_longitudes(size / 2);
+    Measurement decode("polyline/decode" + digits, "random_walk",
+                       "coordinate");
+    for (std::size_t repetition = 0; repetition < repetitions; ++repetition)
+      decode.sample(count, [&] {
+        checksum += geometry::polyline::decode(
+            encoded.data(), size, decoded_latitudes.data(),
+            decoded_longitudes.data(), precision);
+      });
+    decode.report();
+  }
+
+  std::cerr << "polyline5 bytes: " << textbook.size() << std::endl;
+  std::cerr << "checksum: " << checksum << std::endl;
+  return EXIT_SUCCESS;
+}
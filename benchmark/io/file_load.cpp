@@ -0,0 +1,125 @@
+#include "container/default_init_allocator.hpp"
+#include "io/file.hpp"
+#include "suite/measurement.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// Measures the throughput of loading large POD containers from a file. The
+// raw read of the file into uninitialised memory serves as baseline for the
+// container reads. The containers hold the uint64 sequence of the io
+// measurements of the suite (see suite/hot_paths.cpp).
+// Usage: bench-file-load [size in MiB] [rounds] [path]
+//
+// Results are printed as JSON lines, see suite/measurement.hpp.
+//
+// The file is read repeatedly, so results usually reflect the page cache. To
+// measure the disk, drop the caches between runs (or use a file larger than
+// the main memory). Build in release mode (-DCMAKE_BUILD_TYPE=Release).
+
+using namespace project_x;
+
+namespace {
+using benchmark::Measurement;
+
+// the former implementation, resizing (and zeroing) the full container first
+template <typename container_type>
+void read_resized(std::string const &path, container_type &container) {
+  std::ifstream in(path, std::ios::binary);
+  std::uint64_t size = 0;
+  in.read(reinterpret_cast<char *>(&size), sizeof(size));
+  container.resize(size);
+  in.read(reinterpret_cast<char *>(&container[0]),
+          size * sizeof(typename container_type::value_type));
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::uint64_t const mebibytes = argc > 1 ? std::stoull(argv[1]) : 512;
+  std::size_t const rounds = argc > 2 ? std::stoull(argv[2]) : 3;
+  std::string const path = argc > 3 ? argv[3] : "bench-file-load.tmp";
+  std::uint64_t const count = mebibytes * 1024 * 1024 / sizeof(std::uint64_t);
+  std::uint64_t const bytes = count * sizeof(std::uint64_t);
+  benchmark::report_run("file-load",
+                        {{"mebibytes", mebibytes}, {"rounds", rounds}});
+
+  std::vector<std::uint64_t> data(count);
+  std::iota(data.begin(), data.end(), 0);
+  using uninitialised_vector =
+      std::vector<std::uint64_t,
+                  container::DefaultInitAllocator<std::uint64_t>>;
+
+  // checksums keep the reads from being optimised away
+  std::uint64_t checksum = 0;
+  Measurement write("file_load/write_pod_container", "uint64", "byte");
+  Measurement raw("file_load/raw_read", "uint64", "byte");
+  Measurement resized("file_load/resize_and_read", "uint64", "byte");
+  Measurement read("file_load/read_pod_container", "uint64", "byte");
+  Measurement uninitialised("file_load/read_pod_container_no_init", "uint64",
+                            "byte");
+  for (std::size_t round = 0; round < rounds; ++round) {
+    write.sample(bytes, [&] {
+      io::File file(path, io::mode::mWRITE | io::mode::mBINARY);
+      file.write_pod_container(data);
+      file.close();
+    });
+    raw.sample(bytes, [&] {
+      std::unique_ptr<char[]> buffer(new char[bytes + sizeof(std::uint64_t)]);
+      std::ifstream in(path, std::ios::binary);
+      in.read(buffer.get(), bytes + sizeof(std::uint64_t));
+      checksum += buffer[bytes];
+    });
+    resized.sample(bytes, [&] {
+      std::vector<std::uint64_t> loaded;
+      read_resized(path, loaded);
+      checksum += loaded.back();
+    });
+    read.sample(bytes, [&] {
+      std::vector<std::uint64_t> loaded;
+      io::File file(path, io::mode::mREAD | io::mode::mBINARY);
+      file.read_pod_container(loaded);
+      checksum += loaded.back();
+    });
+    uninitialised.sample(bytes, [&] {
+      uninitialised_vector loaded;
+      io::File file(path, io::mode::mREAD | io::mode::mBINARY);
+      file.read_pod_container(loaded);
+      checksum += loaded.back();
+    });
+  }
+  write.report();
+  raw.report();
+  resized.report();
+  read.report();
+  uninitialised.report();
+
+  {
+    io::File file(path, io::mode::mWRITE | io::mode::mBINARY);
+    file.write_compressed_container(data);
+    std::cerr << "compressed to " << std::fixed << std::setprecision(2)
+              << 100.0 * file.tell() / bytes << "% of the raw size"
+              << std::endl;
+  }
+  Measurement compressed("file_load/read_compressed_container", "uint64",
+                         "byte");
+  for (std::size_t round = 0; round < rounds; ++round)
+    compressed.sample(bytes, [&] {
+      uninitialised_vector loaded;
+      io::File file(path, io::mode::mREAD | io::mode::mBINARY);
+      file.read_compressed_container(loaded);
+      checksum += loaded.back();
+    });
+  compressed.report();
+
+  std::remove(path.c_str());
+  std::cerr << "checksum: " << checksum << std::endl;
+  return EXIT_SUCCESS;
+}
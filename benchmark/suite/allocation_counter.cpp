@@ -0,0 +1,19 @@
+#include "measurement.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions to count allocations for the
+// measurements of measurement.hpp
+
+void *operator new(std::size_t const size) {
+  using namespace project_x::benchmark;
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (auto memory = std::malloc(size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
@@ -0,0 +1,237 @@
+#include "algorithm/dijkstra.hpp"
+#include "container/kary_heap.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+#include "io/file.hpp"
+#include "measurement.hpp"
+#include "route/route.hpp"
+#include "synthetic_graph.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Microbenchmarks of the hot paths of routing: the heap, Dijkstra's edge
+// relaxation, building forward star graphs and file io. Graph based
+// measurements run on a grid, a random geometric and a road-like synthetic
+// graph (see synthetic_graph.hpp).
+// Usage: bench-hot-paths [grid width] [queries] [rounds]
+//
+// Results are printed as JSON lines, see measurement.hpp.
+//
+// Build in release mode (-DCMAKE_BUILD_TYPE=Release).
+
+using namespace project_x;
+
+namespace {
+using benchmark::Measurement;
+using location_type = algorithm::Location<graph::WeightTimeDistance>;
+
+// Counts the edges Dijkstra relaxes, each relaxation looks up a single cost.
+// Only used for an untimed pass, so the count does not disturb the timing.
+class CountingGraph : public graph::RoutingGraph {
+public:
+  explicit CountingGraph(graph::RoutingGraph const &graph)
+      : graph::RoutingGraph(graph) {}
+
+  cost_type const &cost(EdgeID const eid) const {
+    ++relaxed;
+    return graph::RoutingGraph::cost(eid);
+  }
+
+  mutable std::uint64_t relaxed = 0;
+};
+
+// push all keys in random order, update all of them to new random weights and
+// pop them, in batches
+void bench_heap(std::uint64_t const keys, std::size_t const rounds,
+                std::uint64_t &checksum) {
+  std::size_t const batch = 1024;
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::uint32_t> weight(0, 1 << 30);
+  std::vector<NodeID> order(keys);
+  std::iota(order.begin(), order.end(), 0);
+
+  Measurement push("kary_heap/push", "uniform_keys", "push");
+  Measurement update("kary_heap/update", "uniform_keys", "update");
+  Measurement pop("kary_heap/pop", "uniform_keys", "pop");
+  container::KAryHeap<NodeID, std::uint32_t, 2> heap;
+  std::vector<std::uint32_t> weights(keys);
+  for (std::size_t round = 0; round < rounds; ++round) {
+    heap.clear();
+    std::shuffle(order.begin(), order.end(), generator);
+    for (auto &value : weights)
+      value = weight(generator);
+    for (std::uint64_t begin = 0; begin < keys; begin += batch) {
+      auto const end = std::min(keys, begin + batch);
+      push.sample(end - begin, [&] {
+        for (auto index = begin; index < end; ++index)
+          heap.push(order[index], weights[index]);
+      });
+    }
+    std::shuffle(order.begin(), order.end(), generator);
+    for (auto &value : weights)
+      value = weight(generator);
+    for (std::uint64_t begin = 0; begin < keys; begin += batch) {
+      auto const end = std::min(keys, begin + batch);
+      update.sample(end - begin, [&] {
+        for (auto index = begin; index < end; ++index)
+          heap.update(order[index], weights[index]);
+      });
+    }
+    while (!heap.empty()) {
+      auto const count = std::min<std::uint64_t>(batch, heap.size());
+      pop.sample(count, [&] {
+        for (std::uint64_t index = 0; index < count; ++index)
+          checksum += heap.pop().weight;
+      });
+    }
+  }
+  push.report();
+  update.report();
+  pop.report();
+}
+
+// Random queries, reusing the route. Reported per query and per relaxed edge,
+// the edges counted in a separate untimed pass.
+void bench_dijkstra(benchmark::SyntheticGraph const &synthetic,
+                    graph::RoutingGraph const &graph, std::size_t const queries,
+                    std::uint64_t &checksum) {
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<NodeID> node(0, synthetic.number_of_nodes - 1);
+  std::vector<std::pair<NodeID, NodeID>> pairs;
+  for (std::size_t query = 0; query < queries; ++query)
+    pairs.emplace_back(node(generator), node(generator));
+
+  std::vector<std::uint64_t> relaxed;
+  {
+    CountingGraph counting(graph);
+    algorithm::Dijkstra<CountingGraph> dijkstra(counting);
+    route::Route<graph::WeightTimeDistance> route;
+    for (auto const &pair : pairs) {
+      counting.relaxed = 0;
+      dijkstra(location_type{pair.first, {0, 0, 0}},
+               location_type{pair.second, {0, 0, 0}}, route);
+      relaxed.push_back(counting.relaxed);
+    }
+  }
+
+  Measurement query("dijkstra/query", synthetic.name, "query");
+  Measurement relax("dijkstra/relax", synthetic.name, "edge");
+  algorithm::Dijkstra<graph::RoutingGraph> dijkstra(graph);
+  route::Route<graph::WeightTimeDistance> route;
+  for (std::size_t index = 0; index < pairs.size(); ++index) {
+    auto sample = query.sample(1, [&] {
+      dijkstra(location_type{pairs[index].first, {0, 0, 0}},
+               location_type{pairs[index].second, {0, 0, 0}}, route);
+    });
+    checksum += route.segments.size();
+    sample.operations = relaxed[index];
+    relax.add(sample);
+  }
+  query.report();
+  relax.report();
+}
+
+// building the graph from its edges and loading it from a file, per edge
+void bench_forward_star(benchmark::SyntheticGraph const &synthetic,
+                        graph::RoutingGraph const &graph,
+                        std::size_t const rounds, std::string const &path,
+                        std::uint64_t &checksum) {
+  auto const edges = synthetic.edges.size();
+  Measurement produce("forward_star_factory/produce_directed", synthetic.name,
+                      "edge");
+  for (std::size_t round = 0; round < rounds; ++round) {
+    auto copy = synthetic.edges;
+    produce.sample(edges, [&] {
+      auto const produced =
+          graph::ForwardStarFactory::produce_directed_from_edges(
+              synthetic.number_of_nodes, copy);
+      checksum += produced.number_of_edges();
+    });
+  }
+  produce.report();
+
+  {
+    io::File file(path, io::mode::mWRITE | io::mode::mBINARY |
+                            io::mode::mVERSIONED);
+    static_cast<graph::ForwardStar const &>(graph).serialise(file);
+  }
+  Measurement load("forward_star_factory/produce_from_file", synthetic.name,
+                   "edge");
+  for (std::size_t round = 0; round < rounds; ++round)
+    load.sample(edges, [&] {
+      auto const loaded = graph::ForwardStarFactory::produce_from_file(path);
+      checksum += loaded.number_of_edges();
+    });
+  load.report();
+}
+
+// writing and reading sized containers, per byte
+void bench_file(std::uint64_t const values, std::size_t const rounds,
+                std::string const &path, std::uint64_t &checksum) {
+  std::vector<std::uint64_t> data(values);
+  std::iota(data.begin(), data.end(), 0);
+  auto const bytes = values * sizeof(std::uint64_t);
+
+  Measurement write("io/write_pod_container", "uint64", "byte");
+  Measurement read("io/read_pod_container", "uint64", "byte");
+  for (std::size_t round = 0; round < rounds; ++round) {
+    write.sample(bytes, [&] {
+      io::File file(path, io::mode::mWRITE | io::mode::mBINARY);
+      file.write_pod_container(data);
+      file.close();
+    });
+    read.sample(bytes, [&] {
+      std::vector<std::uint64_t,
+                  container::DefaultInitAllocator<std::uint64_t>>
+          loaded;
+      io::File file(path, io::mode::mREAD | io::mode::mBINARY);
+      file.read_pod_container(loaded);
+      checksum += loaded.back();
+    });
+  }
+  write.report();
+  read.report();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  NodeID const width = argc > 1 ? std::stoull(argv[1]) : 256;
+  std::size_t const queries = argc > 2 ? std::stoull(argv[2]) : 200;
+  std::size_t const rounds = argc > 3 ? std::stoull(argv[3]) : 10;
+  std::string const path = "bench-hot-paths.tmp";
+
+  benchmark::report_run("hot-paths", {{"width", width},
+                                     {"queries", queries},
+                                     {"rounds", rounds}});
+
+  // checksums keep the measured work from being optimised away
+  std::uint64_t checksum = 0;
+  bench_heap(width * width, rounds, checksum);
+
+  std::vector<benchmark::SyntheticGraph> const inputs = {
+      benchmark::make_grid(width),
+      benchmark::make_random_geometric(width * width),
+      benchmark::make_road_like(width)};
+  for (auto const &synthetic : inputs) {
+    auto const graph = benchmark::make_routing_graph(synthetic);
+    bench_dijkstra(synthetic, graph, queries, checksum);
+    bench_forward_star(synthetic, graph, rounds, path, checksum);
+  }
+
+  bench_file(8 * width * width, rounds, path, checksum);
+  std::remove(path.c_str());
+
+  std::cerr << "checksum: " << checksum << std::endl;
+  return EXIT_SUCCESS;
+}
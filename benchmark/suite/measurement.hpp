@@ -0,0 +1,163 @@
+#ifndef PROJECT_X_BENCHMARK_MEASUREMENT_HPP_
+#define PROJECT_X_BENCHMARK_MEASUREMENT_HPP_
+
+#include "version.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Measurements of benchmarks, printed as JSON lines to track them across
+// versions. The first line describes the run, every further line a
+// measurement:
+//   {"benchmark":"dijkstra/query","input":"grid","unit":"query",
+//    "samples":200,"operations":200,"seconds":1.2,"throughput":166.6,
+//    "p50_ns":...,"p90_ns":...,"p99_ns":...,"max_ns":...,
+//    "allocations_per_operation":...,"bytes_per_operation":...}
+// Throughput is in operations per second. Percentiles are taken over the
+// samples, each sample timing a batch of operations (a query, a round of
+// pushes, a file, ...) and giving its time per operation.
+//
+// Allocations are counted by the global operator new of
+// allocation_counter.cpp, which has to be linked into the benchmark.
+namespace project_x {
+namespace benchmark {
+
+inline std::atomic<std::uint64_t> allocations{0};
+inline std::atomic<std::uint64_t> allocated_bytes{0};
+
+struct Sample {
+  double seconds;
+  std::uint64_t operations;
+  std::uint64_t allocations;
+  std::uint64_t bytes;
+};
+
+// the samples of a single benchmark on a single input
+class Measurement {
+public:
+  Measurement(std::string name, std::string input, std::string unit);
+
+  // times a single call of function, performing the given operations
+  template <typename function_type>
+  Sample sample(std::uint64_t const operations, function_type function);
+
+  void add(Sample const &sample);
+
+  // the sum of all samples
+  Sample total() const;
+
+  // prints the measurement as a line of JSON
+  void report() const;
+
+private:
+  std::string name;
+  std::string input;
+  std::string unit;
+  std::vector<Sample> samples;
+};
+
+// prints the line describing a run: the suite, the version and build of the
+// library and the parameters of the run
+void report_run(
+    std::string const &suite,
+    std::vector<std::pair<std::string, std::uint64_t>> const &parameters);
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+inline Measurement::Measurement(std::string name, std::string input,
+                                std::string unit)
+    : name(std::move(name)), input(std::move(input)), unit(std::move(unit)) {}
+
+template <typename function_type>
+Sample Measurement::sample(std::uint64_t const operations,
+                           function_type function) {
+  auto const allocations_before = allocations.load();
+  auto const bytes_before = allocated_bytes.load();
+  auto const start = std::chrono::steady_clock::now();
+  function();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  Sample const result{elapsed.count(), operations,
+                      allocations.load() - allocations_before,
+                      allocated_bytes.load() - bytes_before};
+  add(result);
+  return result;
+}
+
+inline void Measurement::add(Sample const &sample) {
+  samples.push_back(sample);
+}
+
+inline Sample Measurement::total() const {
+  Sample total{0, 0, 0, 0};
+  for (auto const &sample : samples) {
+    total.seconds += sample.seconds;
+    total.operations += sample.operations;
+    total.allocations += sample.allocations;
+    total.bytes += sample.bytes;
+  }
+  return total;
+}
+
+inline void Measurement::report() const {
+  auto const total = this->total();
+  std::vector<double> nanoseconds;
+  for (auto const &sample : samples)
+    if (sample.operations)
+      nanoseconds.push_back(1e9 * sample.seconds / sample.operations);
+  std::sort(nanoseconds.begin(), nanoseconds.end());
+  // nearest rank percentiles
+  auto const percentile = [&nanoseconds](double const fraction) {
+    if (nanoseconds.empty())
+      return 0.0;
+    auto const rank = std::ceil(fraction * nanoseconds.size());
+    return nanoseconds[std::max<std::size_t>(1, rank) - 1];
+  };
+  auto const per_operation = [&total](double const value) {
+    return total.operations ? value / total.operations : 0.0;
+  };
+
+  std::cout << "{\"benchmark\":\"" << name << "\",\"input\":\"" << input
+            << "\",\"unit\":\"" << unit << "\",\"samples\":" << samples.size()
+            << ",\"operations\":" << total.operations
+            << ",\"seconds\":" << total.seconds << ",\"throughput\":"
+            << (total.seconds > 0 ? total.operations / total.seconds : 0.0)
+            << ",\"p50_ns\":" << percentile(0.5)
+            << ",\"p90_ns\":" << percentile(0.9)
+            << ",\"p99_ns\":" << percentile(0.99)
+            << ",\"max_ns\":" << percentile(1.0)
+            << ",\"allocations_per_operation\":"
+            << per_operation(total.allocations)
+            << ",\"bytes_per_operation\":" << per_operation(total.bytes) << "}"
+            << std::endl;
+}
+
+inline void report_run(
+    std::string const &suite,
+    std::vector<std::pair<std::string, std::uint64_t>> const &parameters) {
+  std::cout << "{\"suite\":\"" << suite << "\",\"version\":\""
+            << version_major << "." << version_minor << "." << version_patch
+            << "\",\"build\":"
+#ifdef NDEBUG
+            << "\"release\"";
+#else
+            << "\"debug\"";
+#endif
+  for (auto const &parameter : parameters)
+    std::cout << ",\"" << parameter.first << "\":" << parameter.second;
+  std::cout << "}" << std::endl;
+}
+
+} // namespace benchmark
+} // namespace project_x
+
+#endif // PROJECT_X_BENCHMARK_MEASUREMENT_HPP_
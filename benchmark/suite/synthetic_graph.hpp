@@ -0,0 +1,205 @@
+#ifndef PROJECT_X_BENCHMARK_SYNTHETIC_GRAPH_HPP_
+#define PROJECT_X_BENCHMARK_SYNTHETIC_GRAPH_HPP_
+
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Generators of synthetic graphs for benchmarks. All graphs are reproducible
+// from their seed and carry travel costs derived from the (planar) length of
+// their edges and a speed.
+namespace project_x {
+namespace benchmark {
+
+struct SyntheticEdge {
+  NodeID source, target;
+  graph::WeightTimeDistance cost;
+};
+
+struct SyntheticGraph {
+  std::string name;
+  std::uint64_t number_of_nodes;
+  std::vector<SyntheticEdge> edges;
+};
+
+// width x width nodes about 100m apart, connected to their four neighbours in
+// both directions
+SyntheticGraph make_grid(NodeID const width, std::uint32_t const seed = 42);
+
+// nodes placed uniformly at the density of the grid, connected in both
+// directions to all nodes within a radius chosen for the requested average
+// degree
+SyntheticGraph make_random_geometric(NodeID const number_of_nodes,
+                                     double const degree = 6,
+                                     std::uint32_t const seed = 42);
+
+// A grid of slow local streets, some of them missing or one-way, crossed by
+// arterials on every 8th and motorways on every 32nd row and column.
+SyntheticGraph make_road_like(NodeID const width,
+                              std::uint32_t const seed = 42);
+
+// the routing graph of a synthetic graph, edges carrying their costs
+graph::RoutingGraph make_routing_graph(SyntheticGraph const &synthetic);
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+namespace detail {
+// costs of an edge of the given length (m) at a speed (m/s), times in
+// deciseconds
+inline graph::WeightTimeDistance travel_cost(double const length,
+                                             double const speed) {
+  auto const distance = std::max<std::uint32_t>(1, std::lround(length));
+  auto const time =
+      std::max<std::uint32_t>(1, std::lround(10 * length / speed));
+  return {time, time, distance};
+}
+
+inline void add_edge(SyntheticGraph &graph, NodeID const source,
+                     NodeID const target, double const length,
+                     double const speed) {
+  graph.edges.push_back({source, target, travel_cost(length, speed)});
+}
+
+inline void add_both(SyntheticGraph &graph, NodeID const source,
+                     NodeID const target, double const length,
+                     double const speed) {
+  add_edge(graph, source, target, length, speed);
+  add_edge(graph, target, source, length, speed);
+}
+
+const constexpr double spacing = 100;
+const constexpr double local_speed = 8;
+const constexpr double arterial_speed = 14;
+const constexpr double motorway_speed = 33;
+} // namespace detail
+
+inline SyntheticGraph make_grid(NodeID const width, std::uint32_t const seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> length(0.8 * detail::spacing,
+                                                1.2 * detail::spacing);
+  SyntheticGraph graph{"grid", width * width, {}};
+  graph.edges.reserve(4 * width * width);
+  for (NodeID row = 0; row < width; ++row)
+    for (NodeID column = 0; column < width; ++column) {
+      auto const node = row * width + column;
+      if (column + 1 < width)
+        detail::add_both(graph, node, node + 1, length(generator),
+                         detail::arterial_speed);
+      if (row + 1 < width)
+        detail::add_both(graph, node, node + width, length(generator),
+                         detail::arterial_speed);
+    }
+  return graph;
+}
+
+inline SyntheticGraph make_random_geometric(NodeID const number_of_nodes,
+                                            double const degree,
+                                            std::uint32_t const seed) {
+  std::mt19937 generator(seed);
+  double const side = std::sqrt(double(number_of_nodes)) * detail::spacing;
+  double const radius =
+      side * std::sqrt(degree / (M_PI * std::max<NodeID>(number_of_nodes, 1)));
+  std::uniform_real_distribution<double> position(0, side);
+  std::vector<double> x(number_of_nodes), y(number_of_nodes);
+  for (NodeID node = 0; node < number_of_nodes; ++node) {
+    x[node] = position(generator);
+    y[node] = position(generator);
+  }
+
+  // bucket nodes into cells of the radius, so only neighbouring cells are
+  // searched for close nodes
+  auto const cells = std::max<std::size_t>(1, std::ceil(side / radius));
+  auto const cell_of = [&](double const coordinate) {
+    return std::min<std::size_t>(cells - 1, coordinate / radius);
+  };
+  std::vector<std::vector<NodeID>> buckets(cells * cells);
+  for (NodeID node = 0; node < number_of_nodes; ++node)
+    buckets[cell_of(y[node]) * cells + cell_of(x[node])].push_back(node);
+
+  SyntheticGraph graph{"random_geometric", number_of_nodes, {}};
+  graph.edges.reserve(degree * number_of_nodes * 1.1);
+  for (NodeID node = 0; node < number_of_nodes; ++node) {
+    auto const row = cell_of(y[node]), column = cell_of(x[node]);
+    for (auto r = row ? row - 1 : row; r <= std::min(row + 1, cells - 1); ++r)
+      for (auto c = column ? column - 1 : column;
+           c <= std::min(column + 1, cells - 1); ++c)
+        for (auto const other : buckets[r * cells + c]) {
+          if (other <= node)
+            continue;
+          auto const length =
+              std::hypot(x[node] - x[other], y[node] - y[other]);
+          if (length <= radius)
+            detail::add_both(graph, node, other, length,
+                             detail::arterial_speed);
+        }
+  }
+  return graph;
+}
+
+inline SyntheticGraph make_road_like(NodeID const width,
+                                     std::uint32_t const seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> length(0.8 * detail::spacing,
+                                                1.2 * detail::spacing);
+  std::uniform_real_distribution<double> chance(0, 1);
+  auto const speed_of = [](NodeID const line) {
+    if (line % 32 == 0)
+      return detail::motorway_speed;
+    if (line % 8 == 0)
+      return detail::arterial_speed;
+    return detail::local_speed;
+  };
+
+  SyntheticGraph graph{"road_like", width * width, {}};
+  graph.edges.reserve(4 * width * width);
+  auto const connect = [&](NodeID const from, NodeID const to,
+                           double const speed) {
+    auto const segment = length(generator);
+    if (speed == detail::local_speed) {
+      // a quarter of the local streets is missing, some are one-way
+      auto const kind = chance(generator);
+      if (kind < 0.25)
+        return;
+      if (kind < 0.35) {
+        detail::add_edge(graph, from, to, segment, speed);
+        return;
+      }
+    }
+    detail::add_both(graph, from, to, segment, speed);
+  };
+  for (NodeID row = 0; row < width; ++row)
+    for (NodeID column = 0; column < width; ++column) {
+      auto const node = row * width + column;
+      if (column + 1 < width)
+        connect(node, node + 1, speed_of(row));
+      if (row + 1 < width)
+        connect(node, node + width, speed_of(column));
+    }
+  return graph;
+}
+
+inline graph::RoutingGraph make_routing_graph(SyntheticGraph const &synthetic) {
+  // the factory sorts the edges it is given
+  auto edges = synthetic.edges;
+  graph::RoutingGraph graph =
+      graph::ForwardStarFactory::produce_directed_from_edges(
+          synthetic.number_of_nodes, edges);
+  graph::DecoratorFactory().decorate<graph::RoutingGraph>(
+      graph, edges, [](auto const &edge) { return edge.cost; });
+  return graph;
+}
+
+} // namespace benchmark
+} // namespace project_x
+
+#endif // PROJECT_X_BENCHMARK_SYNTHETIC_GRAPH_HPP_
@@ -0,0 +1,319 @@
+#ifndef PROJECT_X_ALGORITHM_ALTERNATIVE_ROUTES_HPP_
+#define PROJECT_X_ALGORITHM_ALTERNATIVE_ROUTES_HPP_
+
+#include "algorithm/shortest_path_interface.hpp"
+#include "container/kary_heap.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "route/route.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace algorithm {
+
+// Limits on the routes reported in addition to the shortest one
+struct AlternativeParameters {
+  // number of routes reported, including the shortest one
+  std::size_t max_routes = 3;
+  // an alternative may be at most this much longer than the shortest route
+  // (0.25 allows 25% longer routes)
+  double max_stretch = 0.25;
+  // the weight of edges shared with already chosen routes, relative to the
+  // weight of the shortest route. A route is never reported twice, even if the
+  // limit is 1 or above
+  double max_sharing = 0.8;
+  // the shared part of both search trees an alternative runs through
+  // (plateau), relative to the weight of the shortest route. Longer plateaus
+  // avoid detours that a driver would not take.
+  double min_plateau = 0.1;
+};
+
+// Alternative routes via plateaus (choice routing). A forward search from the
+// source and a backward search towards the target, both bounded by the
+// maximal stretch, form two shortest path trees. Paths contained in both
+// trees (plateaus) are locally optimal, and every plateau describes a via
+// route: the forward tree up to the plateau, the backward tree from there.
+// Plateaus are checked in order of the weight of their route, longer plateaus
+// first on ties. All alternatives come from the same two searches.
+template <typename graph_type> class AlternativeRoutes {
+public:
+  using weight_type = typename graph_type::cost_type;
+  using location_type = Location<weight_type>;
+
+  // builds the reverse graph for the backward search, reuse the engine for
+  // multiple queries
+  AlternativeRoutes(graph_type const &graph,
+                    AlternativeParameters parameters = {});
+
+  // the shortest route, followed by up to max_routes - 1 alternatives ordered
+  // by weight. Empty if the target cannot be reached.
+  std::vector<route::Route<weight_type>> operator()(location_type const &from,
+                                                    location_type const &to);
+
+private:
+  struct ParentData {
+    NodeID parent_node;
+    EdgeID via_edge;
+  };
+  using heap_type = container::KAryHeap<NodeID, weight_type, 2>;
+  using parent_map = std::unordered_map<NodeID, ParentData>;
+
+  struct Plateau {
+    // the first node of the plateau along the route
+    NodeID via_node;
+    weight_type route_weight;
+    weight_type length;
+  };
+
+  // settles the closest node. Backward searches scan the reverse graph, with
+  // parents pointing towards the target.
+  void settle(heap_type &heap, parent_map &parents, bool const backward);
+  // settles all nodes up to the bound
+  template <typename bound_type>
+  void search(heap_type &heap, parent_map &parents, bool const backward,
+              bound_type const &bound);
+
+  // the edges of the route via a node, empty if the forward and backward
+  // path intersect
+  std::vector<EdgeID> via_route(NodeID const via_node) const;
+
+  // all plateaus, in the order they are checked
+  std::vector<Plateau> plateaus() const;
+
+  graph_type const &graph;
+  AlternativeParameters const parameters;
+
+  // reverse graph, with the ID of the original edge for every reverse edge
+  graph::ForwardStar reverse;
+  std::vector<EdgeID> reverse_edges;
+
+  heap_type forward_heap, backward_heap;
+  parent_map forward_parents, backward_parents;
+};
+
+template <typename graph_type>
+AlternativeRoutes<graph_type>::AlternativeRoutes(
+    graph_type const &graph, AlternativeParameters parameters)
+    : graph(graph), parameters(std::move(parameters)) {
+  struct ReverseEdge {
+    NodeID source;
+    NodeID target;
+    EdgeID edge;
+  };
+  std::vector<ReverseEdge> edges;
+  edges.reserve(graph.number_of_edges());
+  for (NodeID node = 0; node < graph.number_of_nodes(); ++node) {
+    auto itr = graph.edges_begin(node);
+    auto eid = graph.edge_id(itr);
+    auto const end_id = graph.edge_id(graph.edges_end(node));
+    for (; eid != end_id; ++eid, ++itr)
+      edges.push_back({*itr, node, eid});
+  }
+  reverse = graph::ForwardStarFactory::produce_directed_from_edges(
+      graph.number_of_nodes(), edges);
+  // the factory sorts the edges into the order of the reverse graph
+  reverse_edges.reserve(edges.size());
+  for (auto const &edge : edges)
+    reverse_edges.push_back(edge.edge);
+}
+
+template <typename graph_type>
+void AlternativeRoutes<graph_type>::settle(heap_type &heap,
+                                           parent_map &parents,
+                                           bool const backward) {
+  auto const settled = heap.pop();
+  auto const relax = [&](NodeID const target, EdgeID const eid) {
+    auto const weight = settled.weight + graph.cost(eid);
+    auto const entry = heap.entry(target);
+    if (!entry) {
+      heap.push(target, weight);
+      parents[target] = {settled.key, eid};
+    } else if (weight < entry->weight) {
+      heap.update(target, weight);
+      parents[target] = {settled.key, eid};
+    }
+  };
+
+  if (backward) {
+    auto itr = reverse.edges_begin(settled.key);
+    auto eid = reverse.edge_id(itr);
+    auto const end_id = reverse.edge_id(reverse.edges_end(settled.key));
+    for (; eid != end_id; ++eid, ++itr)
+      relax(*itr, reverse_edges[eid]);
+  } else {
+    auto itr = graph.edges_begin(settled.key);
+    auto eid = graph.edge_id(itr);
+    auto const end_id = graph.edge_id(graph.edges_end(settled.key));
+    for (; eid != end_id; ++eid, ++itr)
+      relax(*itr, eid);
+  }
+}
+
+template <typename graph_type>
+template <typename bound_type>
+void AlternativeRoutes<graph_type>::search(heap_type &heap,
+                                           parent_map &parents,
+                                           bool const backward,
+                                           bound_type const &bound) {
+  while (!heap.empty() && !(bound < heap.peek().weight))
+    settle(heap, parents, backward);
+}
+
+template <typename graph_type>
+std::vector<EdgeID>
+AlternativeRoutes<graph_type>::via_route(NodeID const via_node) const {
+  std::vector<EdgeID> edges;
+  std::unordered_set<NodeID> visited = {via_node};
+
+  auto itr = forward_parents.find(via_node);
+  for (; itr != forward_parents.end();
+       itr = forward_parents.find(itr->second.parent_node)) {
+    edges.push_back(itr->second.via_edge);
+    visited.insert(itr->second.parent_node);
+  }
+  std::reverse(edges.begin(), edges.end());
+
+  itr = backward_parents.find(via_node);
+  for (; itr != backward_parents.end();
+       itr = backward_parents.find(itr->second.parent_node)) {
+    // both halves meet in a node other than the via node
+    if (!visited.insert(itr->second.parent_node).second)
+      return {};
+    edges.push_back(itr->second.via_edge);
+  }
+  return edges;
+}
+
+template <typename graph_type>
+std::vector<typename AlternativeRoutes<graph_type>::Plateau>
+AlternativeRoutes<graph_type>::plateaus() const {
+  // an edge is part of a plateau, if it is in both trees. Every node has at
+  // most a single plateau edge leaving (its backward parent) and arriving (its
+  // forward parent), so plateaus are disjoint paths. Nodes in both trees
+  // without any plateau edge form plateaus of their own.
+  auto const on_plateau = [this](NodeID const node) {
+    auto const backward = backward_parents.find(node);
+    if (backward == backward_parents.end())
+      return false;
+    auto const forward = forward_parents.find(backward->second.parent_node);
+    return forward != forward_parents.end() &&
+           forward->second.via_edge == backward->second.via_edge;
+  };
+  auto const starts_plateau = [this](NodeID const node) {
+    auto const forward = forward_parents.find(node);
+    if (forward == forward_parents.end())
+      return true;
+    auto const previous = backward_parents.find(forward->second.parent_node);
+    return previous == backward_parents.end() ||
+           previous->second.via_edge != forward->second.via_edge;
+  };
+
+  std::vector<Plateau> result;
+  for (auto const &parent : backward_parents) {
+    auto const first = parent.first;
+    auto const forward = forward_heap.entry(first);
+    if (!forward || !starts_plateau(first))
+      continue;
+
+    auto const route_weight =
+        forward->weight + backward_heap.entry(first)->weight;
+
+    auto last = first;
+    while (on_plateau(last))
+      last = backward_parents.find(last)->second.parent_node;
+    result.push_back({first, route_weight,
+                      forward_heap.entry(last)->weight - forward->weight});
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](auto const &lhs, auto const &rhs) {
+              if (lhs.route_weight != rhs.route_weight)
+                return lhs.route_weight < rhs.route_weight;
+              return rhs.length < lhs.length;
+            });
+  return result;
+}
+
+template <typename graph_type>
+std::vector<route::Route<typename graph_type::cost_type>>
+AlternativeRoutes<graph_type>::operator()(location_type const &from,
+                                          location_type const &to) {
+  forward_heap.clear();
+  backward_heap.clear();
+  forward_parents.clear();
+  backward_parents.clear();
+
+  // the shortest route, then the forward tree up to the maximal stretch
+  forward_heap.push(from.node, from.offset);
+  while (!forward_heap.empty() && forward_heap.peek().key != to.node)
+    settle(forward_heap, forward_parents, false);
+  if (forward_heap.empty())
+    return {};
+
+  auto const shortest = forward_heap.peek().weight + to.offset;
+  auto const bound = shortest * (1 + parameters.max_stretch);
+  search(forward_heap, forward_parents, false, bound);
+  backward_heap.push(to.node, to.offset);
+  search(backward_heap, backward_parents, true, bound);
+
+  std::vector<route::Route<weight_type>> routes;
+  std::unordered_set<EdgeID> used_edges;
+  std::vector<std::vector<EdgeID>> chosen;
+  auto const add_route = [&](std::vector<EdgeID> const &edges) {
+    chosen.push_back(edges);
+    route::Route<weight_type> route;
+    auto weight = from.offset;
+    for (auto const eid : edges) {
+      weight = weight + graph.cost(eid);
+      route.segments.push_back({weight, eid});
+      used_edges.insert(eid);
+    }
+    routes.push_back(std::move(route));
+  };
+  auto const edge_weight = [this](std::vector<EdgeID> const &edges,
+                                  auto const &predicate) {
+    weight_type sum{};
+    for (auto const eid : edges)
+      if (predicate(eid))
+        sum = sum + graph.cost(eid);
+    return sum;
+  };
+
+  auto const shortest_edges = via_route(to.node);
+  add_route(shortest_edges);
+  // sharing is measured on edges only, ignoring the offsets
+  auto const max_shared =
+      edge_weight(shortest_edges, [](EdgeID) { return true; }) *
+      parameters.max_sharing;
+  auto const min_length = shortest * parameters.min_plateau;
+  for (auto const &plateau : plateaus()) {
+    if (routes.size() >= parameters.max_routes || bound < plateau.route_weight)
+      break;
+    if (plateau.length < min_length)
+      continue;
+
+    auto const edges = via_route(plateau.via_node);
+    // a limit on sharing of 1 or above would admit routes chosen before
+    if (edges.empty() ||
+        std::find(chosen.begin(), chosen.end(), edges) != chosen.end())
+      continue;
+    auto const shared = edge_weight(edges, [&used_edges](EdgeID const eid) {
+      return used_edges.count(eid) != 0;
+    });
+    if (!(max_shared < shared))
+      add_route(edges);
+  }
+  return routes;
+}
+
+} // namespace algorithm
+} // namespace project_x
+
+#endif // PROJECT_X_ALGORITHM_ALTERNATIVE_ROUTES_HPP_
@@ -0,0 +1,344 @@
+#ifndef PROJECT_X_ALGORITHM_CONTRACTION_HPP_
+#define PROJECT_X_ALGORITHM_CONTRACTION_HPP_
+
+#include "container/kary_heap.hpp"
+#include "graph/decorator.hpp"
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "io/file.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace algorithm {
+
+// A contraction hierarchy, with nodes renumbered in descending order of their
+// rank (the most important node has ID 0). Every edge of the hierarchy
+// (original edge or shortcut) connects a node to a higher ranked one:
+//   - upward holds the edges leaving a node towards higher ranks
+//   - downward holds the edges arriving at a node from higher ranks, as edges
+//     from the node to their sources
+// Scanning downward in order of the IDs visits all edges in topological order
+// of the downward graph. Only distances are supported, shortcuts do not
+// remember the edges they replace.
+template <typename weight_type> struct Hierarchy {
+  static_assert(std::is_arithmetic<weight_type>::value,
+                "Hierarchies require arithmetic weights.");
+  using graph_type =
+      graph::edge::CostDecorator<weight_type, graph::ForwardStar>;
+
+  graph_type upward;
+  graph_type downward;
+  // translation between the IDs of the original graph and the hierarchy
+  std::vector<NodeID> hierarchy_id;
+  std::vector<NodeID> original_id;
+
+  std::size_t number_of_nodes() const { return original_id.size(); }
+
+  void serialise(io::File &file) const;
+  void deserialise(io::File &file);
+};
+
+// Contract a graph by repeatedly removing the node with the smallest edge
+// difference (shortcuts added minus edges removed, plus the number of already
+// contracted neighbours). Shortcuts are only added when a bounded witness
+// search finds no path of at most the same weight. The weight function turns
+// the cost of an edge into an arithmetic weight, e.g. for
+// graph::WeightTimeDistance: [](auto const &cost) { return cost.weight; }
+template <typename graph_type, typename weight_function_type>
+auto contract(graph_type const &graph, weight_function_type weight_function)
+    -> Hierarchy<std::decay_t<decltype(
+        weight_function(std::declval<typename graph_type::cost_type>()))>>;
+
+// graphs with arithmetic costs are contracted on their cost
+template <typename graph_type>
+Hierarchy<typename graph_type::cost_type> contract(graph_type const &graph);
+
+namespace detail {
+template <typename weight_type> class Contractor {
+public:
+  Contractor(std::size_t const number_of_nodes);
+
+  // parallel edges are reduced to the lightest one, loops are dropped
+  void add_edge(NodeID const source, NodeID const target,
+                weight_type const weight);
+
+  Hierarchy<weight_type> run();
+
+private:
+  // witness searches stop after settling this many nodes, adding possibly
+  // unnecessary shortcuts instead of searching large parts of the graph
+  static constexpr std::size_t witness_settle_limit = 500;
+
+  struct Arc {
+    NodeID node;
+    weight_type weight;
+  };
+
+  struct HierarchyEdge {
+    NodeID source;
+    NodeID target;
+    weight_type weight;
+  };
+
+  static void insert(std::vector<Arc> &arcs, NodeID const node,
+                     weight_type const weight);
+  static void remove(std::vector<Arc> &arcs, NodeID const node);
+
+  // calls add_shortcut(from, to, weight) for every shortcut required to
+  // contract the node
+  template <typename callback_type>
+  void shortcuts(NodeID const node, callback_type add_shortcut);
+  std::int64_t priority(NodeID const node);
+  void contract(NodeID const node, std::vector<HierarchyEdge> &upward,
+                std::vector<HierarchyEdge> &downward);
+
+  // the remaining graph, only holding uncontracted nodes
+  std::vector<std::vector<Arc>> outgoing;
+  std::vector<std::vector<Arc>> incoming;
+  std::vector<std::uint32_t> contracted_neighbours;
+
+  // witness search state, reset after every search
+  std::vector<weight_type> distance;
+  std::vector<NodeID> touched;
+};
+} // namespace detail
+
+template <typename weight_type>
+void Hierarchy<weight_type>::serialise(io::File &file) const {
+  upward.serialise(file);
+  downward.serialise(file);
+  file.write_container(hierarchy_id);
+  file.write_container(original_id);
+}
+
+template <typename weight_type>
+void Hierarchy<weight_type>::deserialise(io::File &file) {
+  upward.deserialise(file);
+  downward.deserialise(file);
+  file.read_container(hierarchy_id);
+  file.read_container(original_id);
+}
+
+namespace detail {
+template <typename weight_type>
+Contractor<weight_type>::Contractor(std::size_t const number_of_nodes)
+    : outgoing(number_of_nodes), incoming(number_of_nodes),
+      contracted_neighbours(number_of_nodes, 0),
+      distance(number_of_nodes, std::numeric_limits<weight_type>::max()) {}
+
+template <typename weight_type>
+void Contractor<weight_type>::insert(std::vector<Arc> &arcs,
+                                     NodeID const node,
+                                     weight_type const weight) {
+  auto arc = std::find_if(arcs.begin(), arcs.end(),
+                          [node](auto const &arc) { return arc.node == node; });
+  if (arc == arcs.end())
+    arcs.push_back({node, weight});
+  else
+    arc->weight = std::min(arc->weight, weight);
+}
+
+template <typename weight_type>
+void Contractor<weight_type>::remove(std::vector<Arc> &arcs,
+                                     NodeID const node) {
+  arcs.erase(std::remove_if(arcs.begin(), arcs.end(),
+                            [node](auto const &arc) {
+                              return arc.node == node;
+                            }),
+             arcs.end());
+}
+
+template <typename weight_type>
+void Contractor<weight_type>::add_edge(NodeID const source,
+                                       NodeID const target,
+                                       weight_type const weight) {
+  if (source == target)
+    return;
+  insert(outgoing[source], target, weight);
+  insert(incoming[target], source, weight);
+}
+
+template <typename weight_type>
+template <typename callback_type>
+void Contractor<weight_type>::shortcuts(NodeID const node,
+                                        callback_type add_shortcut) {
+  using queue_entry = std::pair<weight_type, NodeID>;
+  auto const unreached = std::numeric_limits<weight_type>::max();
+
+  for (auto const &in : incoming[node]) {
+    weight_type limit = 0;
+    bool has_targets = false;
+    for (auto const &out : outgoing[node]) {
+      if (out.node != in.node) {
+        limit = std::max(limit, in.weight + out.weight);
+        has_targets = true;
+      }
+    }
+    if (!has_targets)
+      continue;
+
+    // bounded dijkstra from the source of the incoming arc, avoiding node
+    std::priority_queue<queue_entry, std::vector<queue_entry>,
+                        std::greater<queue_entry>>
+        queue;
+    distance[in.node] = 0;
+    touched.push_back(in.node);
+    queue.push({0, in.node});
+    std::size_t settled = 0;
+    while (!queue.empty() && settled < witness_settle_limit) {
+      auto const current = queue.top();
+      queue.pop();
+      if (current.first > distance[current.second])
+        continue;
+      if (limit < current.first)
+        break;
+      ++settled;
+      for (auto const &arc : outgoing[current.second]) {
+        auto const weight = current.first + arc.weight;
+        if (arc.node == node || distance[arc.node] <= weight)
+          continue;
+        if (distance[arc.node] == unreached)
+          touched.push_back(arc.node);
+        distance[arc.node] = weight;
+        queue.push({weight, arc.node});
+      }
+    }
+
+    for (auto const &out : outgoing[node]) {
+      auto const via = in.weight + out.weight;
+      if (out.node != in.node && via < distance[out.node])
+        add_shortcut(in.node, out.node, via);
+    }
+
+    for (auto const touched_node : touched)
+      distance[touched_node] = unreached;
+    touched.clear();
+  }
+}
+
+template <typename weight_type>
+std::int64_t Contractor<weight_type>::priority(NodeID const node) {
+  std::int64_t added = 0;
+  shortcuts(node, [&added](NodeID, NodeID, weight_type) { ++added; });
+  auto const removed = static_cast<std::int64_t>(incoming[node].size() +
+                                                 outgoing[node].size());
+  return added - removed + contracted_neighbours[node];
+}
+
+template <typename weight_type>
+void Contractor<weight_type>::contract(NodeID const node,
+                                       std::vector<HierarchyEdge> &upward,
+                                       std::vector<HierarchyEdge> &downward) {
+  std::vector<HierarchyEdge> added;
+  shortcuts(node,
+            [&added](NodeID const from, NodeID const to,
+                     weight_type const weight) {
+              added.push_back({from, to, weight});
+            });
+
+  // all remaining neighbours are ranked higher than the node
+  for (auto const &out : outgoing[node]) {
+    upward.push_back({node, out.node, out.weight});
+    remove(incoming[out.node], node);
+    ++contracted_neighbours[out.node];
+  }
+  for (auto const &in : incoming[node]) {
+    downward.push_back({node, in.node, in.weight});
+    remove(outgoing[in.node], node);
+    ++contracted_neighbours[in.node];
+  }
+  std::vector<Arc>().swap(outgoing[node]);
+  std::vector<Arc>().swap(incoming[node]);
+
+  for (auto const &shortcut : added)
+    add_edge(shortcut.source, shortcut.target, shortcut.weight);
+}
+
+template <typename weight_type>
+Hierarchy<weight_type> Contractor<weight_type>::run() {
+  auto const number_of_nodes = outgoing.size();
+  container::KAryHeap<NodeID, std::int64_t, 4> queue;
+  for (NodeID node = 0; node < number_of_nodes; ++node)
+    queue.push(node, priority(node));
+
+  // edges in the IDs of the original graph, translated when all ranks are
+  // known
+  std::vector<HierarchyEdge> upward, downward;
+  Hierarchy<weight_type> hierarchy;
+  hierarchy.hierarchy_id.resize(number_of_nodes);
+  hierarchy.original_id.resize(number_of_nodes);
+  for (NodeID rank = 0; rank < number_of_nodes; ++rank) {
+    auto const node = queue.pop().key;
+    // the last node contracted is the most important one
+    hierarchy.hierarchy_id[node] = number_of_nodes - 1 - rank;
+    hierarchy.original_id[number_of_nodes - 1 - rank] = node;
+
+    std::vector<NodeID> neighbours;
+    for (auto const &out : outgoing[node])
+      neighbours.push_back(out.node);
+    for (auto const &in : incoming[node])
+      neighbours.push_back(in.node);
+    contract(node, upward, downward);
+
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                     neighbours.end());
+    for (auto const neighbour : neighbours)
+      queue.update(neighbour, priority(neighbour));
+  }
+
+  auto const build = [&](std::vector<HierarchyEdge> &edges) {
+    for (auto &edge : edges) {
+      edge.source = hierarchy.hierarchy_id[edge.source];
+      edge.target = hierarchy.hierarchy_id[edge.target];
+    }
+    typename Hierarchy<weight_type>::graph_type graph =
+        graph::ForwardStarFactory::produce_directed_from_edges(
+            number_of_nodes, edges);
+    graph::DecoratorFactory().decorate(
+        graph, edges, [](auto const &edge) { return edge.weight; });
+    return graph;
+  };
+  hierarchy.upward = build(upward);
+  hierarchy.downward = build(downward);
+  return hierarchy;
+}
+} // namespace detail
+
+template <typename graph_type, typename weight_function_type>
+auto contract(graph_type const &graph, weight_function_type weight_function)
+    -> Hierarchy<std::decay_t<decltype(
+        weight_function(std::declval<typename graph_type::cost_type>()))>> {
+  using weight_type = std::decay_t<decltype(
+      weight_function(std::declval<typename graph_type::cost_type>()))>;
+  detail::Contractor<weight_type> contractor(graph.number_of_nodes());
+  for (NodeID node = 0; node < graph.number_of_nodes(); ++node) {
+    auto itr = graph.edges_begin(node);
+    auto eid = graph.edge_id(itr);
+    auto const end_id = graph.edge_id(graph.edges_end(node));
+    for (; eid != end_id; ++eid, ++itr)
+      contractor.add_edge(node, *itr, weight_function(graph.cost(eid)));
+  }
+  return contractor.run();
+}
+
+template <typename graph_type>
+Hierarchy<typename graph_type::cost_type> contract(graph_type const &graph) {
+  return contract(graph, [](auto const &cost) { return cost; });
+}
+
+} // namespace algorithm
+} // namespace project_x
+
+#endif // PROJECT_X_ALGORITHM_CONTRACTION_HPP_
@@ -28,10 +28,19 @@ public:
   operator()(std::vector<location_type> const &from,
              std::vector<location_type> const &to) override final;
 
+  // The same queries, writing into a route provided by the caller. Reusing the
+  // route for many queries avoids allocating its segments. Returns whether a
+  // path was found, the route is empty otherwise.
+  bool operator()(location_type const &from, location_type const &to,
+                  route::Route<weight_type> &route);
+  bool operator()(std::vector<location_type> const &from,
+                  std::vector<location_type> const &to,
+                  route::Route<weight_type> &route);
+
 private:
   // perform a step of dijkstras algorithm
   void relax();
-  route::Route<weight_type> extract_path(NodeID) const;
+  void extract_path(NodeID, route::Route<weight_type> &route) const;
 
   graph_type const &graph;
   // binary heap, storing cost
@@ -40,6 +49,8 @@ private:
   struct ParentData {
     NodeID parent_node;
     EdgeID via_edge;
+    // the weight of reaching the node, saves a heap lookup on extraction
+    weight_type weight;
   };
   // parents of nodes
   std::unordered_map<NodeID, ParentData> parent_ptrs;
@@ -51,27 +62,49 @@ Dijkstra<graph_type>::Dijkstra(graph_type const &graph) : graph(graph) {}
 template <typename graph_type>
 route::Route<typename graph_type::cost_type> Dijkstra<graph_type>::
 operator()(location_type const &from, location_type const &to) {
+  route::Route<weight_type> route;
+  (*this)(from, to, route);
+  return route;
+}
+
+template <typename graph_type>
+route::Route<typename graph_type::cost_type> Dijkstra<graph_type>::
+operator()(std::vector<location_type> const &from,
+           std::vector<location_type> const &to) {
+  route::Route<weight_type> route;
+  (*this)(from, to, route);
+  return route;
+}
+
+template <typename graph_type>
+bool Dijkstra<graph_type>::operator()(location_type const &from,
+                                      location_type const &to,
+                                      route::Route<weight_type> &route) {
   parent_ptrs.clear();
   heap.clear();
+  route.segments.clear();
 
   heap.push(from.node, from.offset);
 
   while (!heap.empty()) {
-    if (heap.peek().key == to.node)
-      return extract_path(to.node);
+    if (heap.peek().key == to.node) {
+      extract_path(to.node, route);
+      return true;
+    }
     relax();
   }
 
   // no valid path
-  return {};
+  return false;
 }
 
 template <typename graph_type>
-route::Route<typename graph_type::cost_type> Dijkstra<graph_type>::
-operator()(std::vector<location_type> const &from,
-           std::vector<location_type> const &to) {
+bool Dijkstra<graph_type>::operator()(std::vector<location_type> const &from,
+                                      std::vector<location_type> const &to,
+                                      route::Route<weight_type> &route) {
   parent_ptrs.clear();
   heap.clear();
+  route.segments.clear();
 
   std::for_each(from.begin(), from.end(),
                 [this](auto const &src) { heap.push(src.node, src.offset); });
@@ -98,13 +131,15 @@ operator()(std::vector<location_type> const &from,
                     }
                   });
 
-    if (best_target && best_weight + min_offset <= current_minimum.weight)
-      return extract_path(*best_target);
+    if (best_target && best_weight + min_offset <= current_minimum.weight) {
+      extract_path(*best_target, route);
+      return true;
+    }
     relax();
   }
 
   // no target,
-  return {};
+  return false;
 }
 
 template <typename graph_type> void Dijkstra<graph_type>::relax() {
@@ -122,10 +157,10 @@ template <typename graph_type> void Dijkstra<graph_type>::relax() {
     // if the heap does not contain an entry, we add it
     if (!entry) {
       heap.push(target, cost);
-      parent_ptrs[target] = {location, eid};
+      parent_ptrs[target] = {location, eid, cost};
       // else if the entry is strictly larger, we found an improvement
     } else if (entry->weight > cost) {
-      parent_ptrs[target] = {location, eid};
+      parent_ptrs[target] = {location, eid, cost};
       heap.update(target, cost);
     }
     ++eid;
@@ -134,20 +169,18 @@ template <typename graph_type> void Dijkstra<graph_type>::relax() {
 }
 
 template <typename graph_type>
-route::Route<typename graph_type::cost_type>
-Dijkstra<graph_type>::extract_path(NodeID destination) const {
-  route::Route<weight_type> route;
-
+void Dijkstra<graph_type>::extract_path(
+    NodeID destination, route::Route<weight_type> &route) const {
+  // The segment of a parent edge ends with the weight of the node it leads to.
+  // Sources have no parent, so the walk ends there. Segments are collected
+  // backwards and reversed in place, a single lookup per segment.
   auto itr = parent_ptrs.find(destination);
   while (itr != parent_ptrs.end()) {
-    route.segments.push_back(
-        {heap.entry(destination)->weight, itr->second.via_edge});
-    destination = itr->second.parent_node;
-    itr = parent_ptrs.find(destination);
+    route.segments.push_back({itr->second.weight, itr->second.via_edge});
+    itr = parent_ptrs.find(itr->second.parent_node);
   }
 
   std::reverse(route.segments.begin(), route.segments.end());
-  return route;
 }
 
 } // namespace algorithm
@@ -0,0 +1,156 @@
+#ifndef PROJECT_X_ALGORITHM_ONE_TO_ALL_HPP_
+#define PROJECT_X_ALGORITHM_ONE_TO_ALL_HPP_
+
+#include "algorithm/shortest_path_interface.hpp"
+#include "container/kary_heap.hpp"
+#include "graph/id.hpp"
+#include "util/parallel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace algorithm {
+
+// All nodes reached by a bounded search, as parallel arrays in the order the
+// nodes were settled (by increasing weight). Without polygons, the arrays can
+// be sent to clients as is, or be streamed while the search is running.
+template <typename weight_type> struct Isochrone {
+  std::vector<NodeID> nodes;
+  std::vector<weight_type> weights;
+  // the index of the source location the shortest path of a node starts at
+  std::vector<std::uint32_t> origins;
+
+  std::size_t size() const { return nodes.size(); }
+  bool empty() const { return nodes.empty(); }
+};
+
+// Dijkstras algorithm from one or multiple sources, settling every node that
+// can be reached within a budget. With multiple sources, every node is
+// assigned to its closest source (e.g. for catchment areas).
+template <typename graph_type> class OneToAll {
+public:
+  using weight_type = typename graph_type::cost_type;
+  using location_type = Location<weight_type>;
+
+  OneToAll(graph_type const &graph);
+
+  Isochrone<weight_type> operator()(location_type const &from,
+                                    weight_type const budget);
+  Isochrone<weight_type> operator()(std::vector<location_type> const &from,
+                                    weight_type const budget);
+
+  // calls visitor(node, weight, origin) for every settled node, in the order
+  // of the isochrone
+  template <typename visitor_type>
+  void search(std::vector<location_type> const &from, weight_type const budget,
+              visitor_type &&visitor);
+
+private:
+  graph_type const &graph;
+  // binary heap, storing cost
+  container::KAryHeap<NodeID, weight_type, 2> heap;
+  // the source location of the best known path to a node
+  std::unordered_map<NodeID, std::uint32_t> origins;
+};
+
+// Independent bounded searches from every source location, on multiple
+// threads. Result i belongs to sources[i].
+template <typename graph_type>
+std::vector<Isochrone<typename graph_type::cost_type>>
+isochrones(graph_type const &graph,
+           std::vector<Location<typename graph_type::cost_type>> const &sources,
+           typename graph_type::cost_type const budget,
+           std::size_t const threads = util::default_concurrency());
+
+template <typename graph_type>
+OneToAll<graph_type>::OneToAll(graph_type const &graph) : graph(graph) {}
+
+template <typename graph_type>
+Isochrone<typename graph_type::cost_type> OneToAll<graph_type>::
+operator()(location_type const &from, weight_type const budget) {
+  return (*this)(std::vector<location_type>(1, from), budget);
+}
+
+template <typename graph_type>
+Isochrone<typename graph_type::cost_type> OneToAll<graph_type>::
+operator()(std::vector<location_type> const &from, weight_type const budget) {
+  Isochrone<weight_type> isochrone;
+  search(from, budget,
+         [&isochrone](NodeID const node, weight_type const &weight,
+                      std::uint32_t const origin) {
+           isochrone.nodes.push_back(node);
+           isochrone.weights.push_back(weight);
+           isochrone.origins.push_back(origin);
+         });
+  return isochrone;
+}
+
+template <typename graph_type>
+template <typename visitor_type>
+void OneToAll<graph_type>::search(std::vector<location_type> const &from,
+                                  weight_type const budget,
+                                  visitor_type &&visitor) {
+  heap.clear();
+  origins.clear();
+
+  // push or improve the entry of a node, unless it is out of budget
+  auto const reach = [this, &budget](NodeID const node,
+                                     weight_type const &weight,
+                                     std::uint32_t const origin) {
+    if (budget < weight)
+      return;
+    auto const entry = heap.entry(node);
+    if (!entry) {
+      heap.push(node, weight);
+      origins[node] = origin;
+    } else if (weight < entry->weight) {
+      heap.update(node, weight);
+      origins[node] = origin;
+    }
+  };
+
+  for (std::uint32_t source = 0; source < from.size(); ++source)
+    reach(from[source].node, from[source].offset, source);
+
+  while (!heap.empty()) {
+    auto const settled = heap.pop();
+    auto const origin = origins[settled.key];
+    visitor(settled.key, settled.weight, origin);
+
+    // settled nodes are never improved, their weight is minimal
+    auto itr = graph.edges_begin(settled.key);
+    auto eid = graph.edge_id(itr);
+    auto const end_id = graph.edge_id(graph.edges_end(settled.key));
+    for (; eid != end_id; ++eid, ++itr)
+      reach(*itr, settled.weight + graph.cost(eid), origin);
+  }
+}
+
+template <typename graph_type>
+std::vector<Isochrone<typename graph_type::cost_type>>
+isochrones(graph_type const &graph,
+           std::vector<Location<typename graph_type::cost_type>> const &sources,
+           typename graph_type::cost_type const budget,
+           std::size_t const threads) {
+  std::vector<Isochrone<typename graph_type::cost_type>> result(
+      sources.size());
+  util::parallel_for(
+      sources.size(),
+      [&](std::size_t const begin, std::size_t const end, std::size_t) {
+        // every thread reuses a single search
+        OneToAll<graph_type> search(graph);
+        for (auto source = begin; source < end; ++source)
+          result[source] = search(sources[source], budget);
+      },
+      threads);
+  return result;
+}
+
+} // namespace algorithm
+} // namespace project_x
+
+#endif // PROJECT_X_ALGORITHM_ONE_TO_ALL_HPP_
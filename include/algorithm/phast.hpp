@@ -0,0 +1,160 @@
+#ifndef PROJECT_X_ALGORITHM_PHAST_HPP_
+#define PROJECT_X_ALGORITHM_PHAST_HPP_
+
+#include "algorithm/contraction.hpp"
+#include "algorithm/shortest_path_interface.hpp"
+#include "graph/id.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace algorithm {
+
+// One-to-all shortest path weights on a contraction hierarchy (PHAST). A
+// Dijkstra search on the upward edges of the source is followed by a single
+// linear sweep over all nodes in descending rank order, relaxing the edges
+// arriving from higher ranks. The sweep replaces the priority queue of a full
+// Dijkstra with sequential memory access.
+// Multiple sources are swept at once, with the weights of all lanes of a node
+// stored next to each other, so the compiler can vectorise the relaxation
+// across sources.
+template <typename weight_type> class PHAST {
+public:
+  using location_type = Location<weight_type>;
+
+  // the weight of nodes that cannot be reached
+  static constexpr weight_type unreached =
+      std::numeric_limits<weight_type>::max();
+  // number of sources swept at once
+  static constexpr std::size_t lanes = 8;
+
+  PHAST(Hierarchy<weight_type> const &hierarchy);
+
+  // the weight of all nodes (in IDs of the original graph) from the source
+  std::vector<weight_type> operator()(location_type const &source);
+
+  // result i holds the weights from sources[i], sources are processed in
+  // groups of lanes
+  std::vector<std::vector<weight_type>>
+  operator()(std::vector<location_type> const &sources);
+
+private:
+  // dijkstra on the upward edges, on weights[node * stride + lane]
+  void upward_search(location_type const &source, std::size_t const stride,
+                     std::size_t const lane);
+
+  // the sweep over all nodes, for stride lanes
+  template <std::size_t stride> void sweep();
+
+  Hierarchy<weight_type> const &hierarchy;
+  // indexed by hierarchy IDs
+  std::vector<weight_type> weights;
+};
+
+template <typename weight_type>
+PHAST<weight_type>::PHAST(Hierarchy<weight_type> const &hierarchy)
+    : hierarchy(hierarchy) {}
+
+template <typename weight_type>
+void PHAST<weight_type>::upward_search(location_type const &source,
+                                       std::size_t const stride,
+                                       std::size_t const lane) {
+  using queue_entry = std::pair<weight_type, NodeID>;
+  std::priority_queue<queue_entry, std::vector<queue_entry>,
+                      std::greater<queue_entry>>
+      queue;
+  auto const &upward = hierarchy.upward;
+  auto const start = hierarchy.hierarchy_id[source.node];
+  weights[start * stride + lane] = source.offset;
+  queue.push({source.offset, start});
+
+  while (!queue.empty()) {
+    auto const current = queue.top();
+    queue.pop();
+    if (current.first > weights[current.second * stride + lane])
+      continue;
+
+    auto itr = upward.edges_begin(current.second);
+    auto eid = upward.edge_id(itr);
+    auto const end_id = upward.edge_id(upward.edges_end(current.second));
+    for (; eid != end_id; ++eid, ++itr) {
+      auto const weight = current.first + upward.cost(eid);
+      auto &entry = weights[*itr * stride + lane];
+      if (weight < entry) {
+        entry = weight;
+        queue.push({weight, *itr});
+      }
+    }
+  }
+}
+
+template <typename weight_type>
+template <std::size_t stride>
+void PHAST<weight_type>::sweep() {
+  auto const &downward = hierarchy.downward;
+  auto *const base = weights.data();
+  for (NodeID node = 0; node < hierarchy.number_of_nodes(); ++node) {
+    auto *const target = base + node * stride;
+    auto itr = downward.edges_begin(node);
+    auto eid = downward.edge_id(itr);
+    auto const end_id = downward.edge_id(downward.edges_end(node));
+    for (; eid != end_id; ++eid, ++itr) {
+      auto const cost = downward.cost(eid);
+      // sums of unreached weights would overflow
+      auto const limit = unreached - cost;
+      auto const *const source = base + *itr * stride;
+      for (std::size_t lane = 0; lane < stride; ++lane) {
+        auto const via =
+            source[lane] <= limit ? source[lane] + cost : unreached;
+        target[lane] = std::min(target[lane], via);
+      }
+    }
+  }
+}
+
+template <typename weight_type>
+std::vector<weight_type> PHAST<weight_type>::
+operator()(location_type const &source) {
+  weights.assign(hierarchy.number_of_nodes(), unreached);
+  upward_search(source, 1, 0);
+  sweep<1>();
+
+  std::vector<weight_type> result(hierarchy.number_of_nodes());
+  for (NodeID node = 0; node < result.size(); ++node)
+    result[node] = weights[hierarchy.hierarchy_id[node]];
+  return result;
+}
+
+template <typename weight_type>
+std::vector<std::vector<weight_type>> PHAST<weight_type>::
+operator()(std::vector<location_type> const &sources) {
+  std::vector<std::vector<weight_type>> result(sources.size());
+  for (std::size_t first = 0; first < sources.size(); first += lanes) {
+    auto const group = std::min(lanes, sources.size() - first);
+    // unused lanes stay unreached
+    weights.assign(hierarchy.number_of_nodes() * lanes, unreached);
+    for (std::size_t lane = 0; lane < group; ++lane)
+      upward_search(sources[first + lane], lanes, lane);
+    sweep<lanes>();
+
+    for (std::size_t lane = 0; lane < group; ++lane) {
+      auto &lane_result = result[first + lane];
+      lane_result.resize(hierarchy.number_of_nodes());
+      for (NodeID node = 0; node < lane_result.size(); ++node)
+        lane_result[node] =
+            weights[hierarchy.hierarchy_id[node] * lanes + lane];
+    }
+  }
+  return result;
+}
+
+} // namespace algorithm
+} // namespace project_x
+
+#endif // PROJECT_X_ALGORITHM_PHAST_HPP_
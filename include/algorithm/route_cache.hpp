@@ -0,0 +1,302 @@
+#ifndef PROJECT_X_ALGORITHM_ROUTE_CACHE_HPP_
+#define PROJECT_X_ALGORITHM_ROUTE_CACHE_HPP_
+
+#include "algorithm/shortest_path_interface.hpp"
+#include "graph/id.hpp"
+#include "route/route.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace algorithm {
+
+struct RouteCacheStatistics {
+  std::uint64_t hits;
+  std::uint64_t misses;
+  // entries dropped since their metric version was outdated
+  std::uint64_t stale;
+  // entries dropped to stay within the byte budget
+  std::uint64_t evictions;
+  std::size_t entries;
+  std::size_t bytes;
+
+  double hit_rate() const {
+    auto const lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+  }
+};
+
+// A cache of query results for repeated pairs of (snapped) locations, e.g.
+// from and to depots or stations. Routes are shared between the cache and its
+// callers, they stay valid after being evicted. The cache is split into shards
+// with their own lock and LRU list, so concurrent queries rarely contend. The
+// budget (in bytes) is split evenly between the shards.
+//
+// Every entry remembers the metric version it was computed with. Changing the
+// costs of the graph (a new metric, live traffic) has to be followed by
+// invalidate(), which outdates all entries at once. Outdated entries are
+// dropped lazily, when they are found or evicted.
+//
+//   auto const route = cache.find_or_compute(
+//       from, to, [&]() { return dijkstra(from, to); });
+template <typename weight_type> class RouteCache {
+public:
+  using location_type = Location<weight_type>;
+  using route_type = route::Route<weight_type>;
+  using route_pointer = std::shared_ptr<route_type const>;
+
+  static_assert(std::has_unique_object_representations<weight_type>::value,
+                "Locations are hashed and compared by their representation.");
+
+  explicit RouteCache(std::size_t const budget, std::size_t const shards = 16);
+
+  // the cached route between two locations, nullptr if it is not cached
+  route_pointer find(location_type const &from, location_type const &to);
+  // Caches a route computed with the given metric version. Routes of outdated
+  // versions are not cached.
+  void insert(location_type const &from, location_type const &to,
+              route_type route, std::uint64_t const version);
+  // looks up a route, computing it via compute() -> route_type on a miss
+  template <typename compute_function>
+  route_pointer find_or_compute(location_type const &from,
+                                location_type const &to,
+                                compute_function compute);
+
+  std::uint64_t version() const;
+  // outdates all cached routes
+  void invalidate();
+  RouteCacheStatistics statistics() const;
+
+private:
+  struct Key {
+    location_type from;
+    location_type to;
+
+    bool operator==(Key const &other) const {
+      return from.node == other.from.node && to.node == other.to.node &&
+             std::memcmp(&from.offset, &other.from.offset,
+                         sizeof(weight_type)) == 0 &&
+             std::memcmp(&to.offset, &other.to.offset, sizeof(weight_type)) ==
+                 0;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(Key const &key) const;
+  };
+
+  struct Entry {
+    Key key;
+    route_pointer route;
+    std::uint64_t version;
+    std::size_t bytes;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    // most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, KeyHash>
+        index;
+    std::size_t bytes = 0;
+  };
+
+  Shard &shard_of(std::size_t const hash);
+  static std::size_t bytes_of(route_type const &route);
+  void store(location_type const &from, location_type const &to,
+             route_pointer route, std::uint64_t const version);
+  // removes an entry, the shard needs to be locked
+  void erase(Shard &shard, typename std::list<Entry>::iterator entry);
+
+  std::vector<std::unique_ptr<Shard>> shards;
+  std::size_t shard_budget;
+  std::atomic<std::uint64_t> metric_version;
+
+  std::atomic<std::uint64_t> hits;
+  std::atomic<std::uint64_t> misses;
+  std::atomic<std::uint64_t> stale;
+  std::atomic<std::uint64_t> evictions;
+};
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+template <typename weight_type>
+RouteCache<weight_type>::RouteCache(std::size_t const budget,
+                                    std::size_t const number_of_shards)
+    : metric_version(0), hits(0), misses(0), stale(0), evictions(0) {
+  // a power of two, so shards are selected by masking
+  std::size_t size = 1;
+  while (size < number_of_shards)
+    size *= 2;
+  shards.reserve(size);
+  for (std::size_t shard = 0; shard < size; ++shard)
+    shards.push_back(std::make_unique<Shard>());
+  shard_budget = budget / size;
+}
+
+template <typename weight_type>
+std::size_t RouteCache<weight_type>::KeyHash::operator()(Key const &key) const {
+  // FNV-1a over the representation of both locations, without padding
+  std::uint64_t hash = 14695981039346656037ull;
+  auto const add = [&hash](void const *data, std::size_t const size) {
+    auto const bytes = static_cast<unsigned char const *>(data);
+    for (std::size_t byte = 0; byte < size; ++byte) {
+      hash ^= bytes[byte];
+      hash *= 1099511628211ull;
+    }
+  };
+  add(&key.from.node, sizeof(NodeID));
+  add(&key.from.offset, sizeof(weight_type));
+  add(&key.to.node, sizeof(NodeID));
+  add(&key.to.offset, sizeof(weight_type));
+  return static_cast<std::size_t>(hash);
+}
+
+template <typename weight_type>
+typename RouteCache<weight_type>::Shard &
+RouteCache<weight_type>::shard_of(std::size_t const hash) {
+  // the low bits select the bucket within the shard, use the high ones here
+  return *shards[(hash >> 32) & (shards.size() - 1)];
+}
+
+template <typename weight_type>
+std::size_t RouteCache<weight_type>::bytes_of(route_type const &route) {
+  // the entry itself, its list and index nodes and the route
+  return sizeof(Entry) + sizeof(route_type) + 4 * sizeof(void *) +
+         sizeof(Key) + route.segments.capacity() *
+                           sizeof(route::Segment<weight_type>);
+}
+
+template <typename weight_type>
+void RouteCache<weight_type>::erase(Shard &shard,
+                                    typename std::list<Entry>::iterator entry) {
+  shard.bytes -= entry->bytes;
+  shard.index.erase(entry->key);
+  shard.entries.erase(entry);
+}
+
+template <typename weight_type>
+typename RouteCache<weight_type>::route_pointer
+RouteCache<weight_type>::find(location_type const &from,
+                              location_type const &to) {
+  Key const key{from, to};
+  auto &shard = shard_of(KeyHash()(key));
+  auto const current = version();
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto const itr = shard.index.find(key);
+  if (itr == shard.index.end()) {
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  if (itr->second->version != current) {
+    erase(shard, itr->second);
+    stale.fetch_add(1, std::memory_order_relaxed);
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, itr->second);
+  hits.fetch_add(1, std::memory_order_relaxed);
+  return itr->second->route;
+}
+
+template <typename weight_type>
+void RouteCache<weight_type>::insert(location_type const &from,
+                                     location_type const &to, route_type route,
+                                     std::uint64_t const version) {
+  route.segments.shrink_to_fit();
+  store(from, to, std::make_shared<route_type const>(std::move(route)),
+        version);
+}
+
+template <typename weight_type>
+void RouteCache<weight_type>::store(location_type const &from,
+                                    location_type const &to,
+                                    route_pointer route,
+                                    std::uint64_t const version) {
+  if (version != this->version())
+    return;
+  auto const bytes = bytes_of(*route);
+  if (bytes > shard_budget)
+    return;
+
+  Key const key{from, to};
+  auto &shard = shard_of(KeyHash()(key));
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto const itr = shard.index.find(key);
+  if (itr != shard.index.end())
+    erase(shard, itr->second);
+  while (shard.bytes + bytes > shard_budget) {
+    auto const oldest = std::prev(shard.entries.end());
+    if (oldest->version == version)
+      evictions.fetch_add(1, std::memory_order_relaxed);
+    else
+      stale.fetch_add(1, std::memory_order_relaxed);
+    erase(shard, oldest);
+  }
+  shard.entries.push_front({key, std::move(route), version, bytes});
+  shard.index.emplace(key, shard.entries.begin());
+  shard.bytes += bytes;
+}
+
+template <typename weight_type>
+template <typename compute_function>
+typename RouteCache<weight_type>::route_pointer
+RouteCache<weight_type>::find_or_compute(location_type const &from,
+                                         location_type const &to,
+                                         compute_function compute) {
+  // the version before the query, an invalidation during the query prevents
+  // caching a route that might be based on the old costs
+  auto const computed_version = version();
+  if (auto route = find(from, to))
+    return route;
+  route_type computed = compute();
+  computed.segments.shrink_to_fit();
+  auto route = std::make_shared<route_type const>(std::move(computed));
+  store(from, to, route, computed_version);
+  return route;
+}
+
+template <typename weight_type>
+std::uint64_t RouteCache<weight_type>::version() const {
+  return metric_version.load(std::memory_order_acquire);
+}
+
+template <typename weight_type> void RouteCache<weight_type>::invalidate() {
+  metric_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+template <typename weight_type>
+RouteCacheStatistics RouteCache<weight_type>::statistics() const {
+  RouteCacheStatistics result{hits.load(std::memory_order_relaxed),
+                              misses.load(std::memory_order_relaxed),
+                              stale.load(std::memory_order_relaxed),
+                              evictions.load(std::memory_order_relaxed),
+                              0,
+                              0};
+  for (auto const &shard : shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    result.entries += shard->entries.size();
+    result.bytes += shard->bytes;
+  }
+  return result;
+}
+
+} // namespace algorithm
+} // namespace project_x
+
+#endif // PROJECT_X_ALGORITHM_ROUTE_CACHE_HPP_
@@ -0,0 +1,142 @@
+#ifndef PROJECT_X_ALGORITHM_TIME_DEPENDENT_DIJKSTRA_HPP_
+#define PROJECT_X_ALGORITHM_TIME_DEPENDENT_DIJKSTRA_HPP_
+
+#include "algorithm/shortest_path_interface.hpp"
+#include "container/kary_heap.hpp"
+#include "graph/id.hpp"
+#include "graph/profile.hpp"
+#include "graph/time_dependent.hpp"
+#include "route/route.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace project_x {
+namespace algorithm {
+
+// Earliest arrival queries on graphs decorated with travel time profiles (see
+// graph::edge::ProfileDecorator). Edges are evaluated at the time the search
+// arrives at their source. On profiles with the FIFO property, settling nodes
+// by arrival time finds the earliest arrival, just like Dijkstras algorithm on
+// static weights. The edges leaving a settled node share their departure time
+// and are evaluated in a single batch.
+template <typename graph_type> class TimeDependentDijkstra {
+public:
+  using time_type = std::uint32_t;
+  using location_type = Location<time_type>;
+
+  TimeDependentDijkstra(graph_type const &graph);
+
+  // the route with the earliest arrival when leaving the source location at
+  // the departure time (in seconds). The weight of a segment is the arrival
+  // time at the end of its edge.
+  route::Route<time_type> operator()(location_type const &from,
+                                     location_type const &to,
+                                     time_type const departure);
+
+private:
+  // perform a step of dijkstras algorithm
+  void relax();
+  route::Route<time_type> extract_path(NodeID) const;
+
+  graph_type const &graph;
+  // binary heap, storing arrival times
+  container::KAryHeap<NodeID, time_type, 2> heap;
+
+  struct ParentData {
+    NodeID parent_node;
+    EdgeID via_edge;
+  };
+  // parents of nodes
+  std::unordered_map<NodeID, ParentData> parent_ptrs;
+
+  // the edges leaving the settled node, for batch evaluation
+  std::vector<graph::ProfileID> profiles;
+  std::vector<time_type> static_times;
+  std::vector<time_type> travel_times;
+};
+
+template <typename graph_type>
+TimeDependentDijkstra<graph_type>::TimeDependentDijkstra(
+    graph_type const &graph)
+    : graph(graph) {}
+
+template <typename graph_type>
+route::Route<typename TimeDependentDijkstra<graph_type>::time_type>
+TimeDependentDijkstra<graph_type>::operator()(location_type const &from,
+                                              location_type const &to,
+                                              time_type const departure) {
+  parent_ptrs.clear();
+  heap.clear();
+
+  heap.push(from.node, departure + from.offset);
+
+  while (!heap.empty()) {
+    if (heap.peek().key == to.node)
+      return extract_path(to.node);
+    relax();
+  }
+
+  // no valid path
+  return {};
+}
+
+template <typename graph_type>
+void TimeDependentDijkstra<graph_type>::relax() {
+  auto const min_heap = heap.pop();
+  auto const location = min_heap.key;
+  auto const arrival = min_heap.weight;
+
+  auto const begin_id = graph.edge_id(graph.edges_begin(location));
+  auto const end_id = graph.edge_id(graph.edges_end(location));
+  auto const count = end_id - begin_id;
+  profiles.resize(count);
+  static_times.resize(count);
+  travel_times.resize(count);
+  for (EdgeID eid = begin_id; eid != end_id; ++eid) {
+    profiles[eid - begin_id] = graph.profile_id(eid);
+    static_times[eid - begin_id] = graph::static_travel_time(graph.cost(eid));
+  }
+  graph.profiles().travel_times(count, profiles.data(), static_times.data(),
+                                arrival, travel_times.data());
+
+  auto itr = graph.edges_begin(location);
+  for (EdgeID eid = begin_id; eid != end_id; ++eid, ++itr) {
+    auto const target = *itr;
+    auto const time = arrival + travel_times[eid - begin_id];
+    auto const entry = heap.entry(target);
+    // if the heap does not contain an entry, we add it
+    if (!entry) {
+      heap.push(target, time);
+      parent_ptrs[target] = {location, eid};
+      // else if the entry is strictly larger, we found an improvement
+    } else if (entry->weight > time) {
+      parent_ptrs[target] = {location, eid};
+      heap.update(target, time);
+    }
+  }
+}
+
+template <typename graph_type>
+route::Route<typename TimeDependentDijkstra<graph_type>::time_type>
+TimeDependentDijkstra<graph_type>::extract_path(NodeID destination) const {
+  route::Route<time_type> route;
+
+  auto itr = parent_ptrs.find(destination);
+  while (itr != parent_ptrs.end()) {
+    route.segments.push_back(
+        {heap.entry(destination)->weight, itr->second.via_edge});
+    destination = itr->second.parent_node;
+    itr = parent_ptrs.find(destination);
+  }
+
+  std::reverse(route.segments.begin(), route.segments.end());
+  return route;
+}
+
+} // namespace algorithm
+} // namespace project_x
+
+#endif // PROJECT_X_ALGORITHM_TIME_DEPENDENT_DIJKSTRA_HPP_
@@ -0,0 +1,207 @@
+#ifndef PROJECT_X_BUILDER_EDGE_EXPANSION_HPP_
+#define PROJECT_X_BUILDER_EDGE_EXPANSION_HPP_
+
+#include "algorithm/shortest_path_interface.hpp"
+#include "graph/decorator.hpp"
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "io/file.hpp"
+#include "route/route.hpp"
+#include "util/parallel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace builder {
+
+// A restricted turn from the edge `from` onto the edge `to`, at the target of
+// `from`. Usually the turn is prohibited. Mandatory restrictions (only_*)
+// prohibit all other turns from `from` instead.
+struct TurnRestriction {
+  EdgeID from;
+  EdgeID to;
+  bool mandatory = false;
+};
+
+// A turn as passed to the turn cost function
+struct Turn {
+  EdgeID from;
+  NodeID via;
+  EdgeID to;
+  // turning back to the source of `from`
+  bool u_turn;
+};
+
+struct ExpansionParameters {
+  // without u-turns, turning back is only possible where no other turn is
+  // allowed (e.g. at dead ends)
+  bool allow_u_turns = false;
+  std::size_t threads = util::default_concurrency();
+};
+
+// An edge expanded graph: every edge of the original graph is a node, every
+// allowed turn between two edges is an edge. The cost of a turn is the turn
+// cost plus the cost of the edge turned onto, so the weight of a node in a
+// search is the weight of reaching the end of its edge. Node IDs equal the
+// original EdgeIDs, the original edge of a turn is its target. Turns are
+// stored in forward star layout, only their target and cost are kept.
+template <typename cost_type> struct EdgeExpandedGraph {
+  using graph_type =
+      graph::edge::CostDecorator<cost_type, graph::ForwardStar>;
+  using location_type = algorithm::Location<cost_type>;
+
+  graph_type graph;
+
+  // the original edge of a turn
+  EdgeID original_edge(EdgeID const turn) const { return *graph.edge(turn); }
+
+  // translates a route of the edge expanded graph, found by searching from the
+  // location `from`, into original EdgeIDs. The first segment is the edge of
+  // the source, reached at its offset.
+  route::Route<cost_type>
+  original_route(route::Route<cost_type> const &route,
+                 location_type const &from) const;
+
+  void serialise(io::File &file) const { graph.serialise(file); }
+  void deserialise(io::File &file) { graph.deserialise(file); }
+};
+
+// Expands a graph into its edge expanded graph, on multiple threads. The turn
+// cost function is called for every allowed turn (concurrently), as
+// turn_cost(Turn const &) -> cost_type. Restrictions need to refer to edges of
+// the graph.
+template <typename graph_type, typename turn_cost_function>
+EdgeExpandedGraph<typename graph_type::cost_type>
+expand_edges(graph_type const &graph,
+             std::vector<TurnRestriction> restrictions,
+             turn_cost_function turn_cost,
+             ExpansionParameters const &parameters = {});
+
+template <typename cost_type>
+route::Route<cost_type> EdgeExpandedGraph<cost_type>::original_route(
+    route::Route<cost_type> const &route, location_type const &from) const {
+  route::Route<cost_type> result;
+  result.segments.reserve(route.segments.size() + 1);
+  result.segments.push_back({from.offset, from.node});
+  for (auto const &segment : route.segments)
+    result.segments.push_back(
+        {segment.weight_at_end, original_edge(segment.edge_id)});
+  return result;
+}
+
+template <typename graph_type, typename turn_cost_function>
+EdgeExpandedGraph<typename graph_type::cost_type>
+expand_edges(graph_type const &graph,
+             std::vector<TurnRestriction> restrictions,
+             turn_cost_function turn_cost,
+             ExpansionParameters const &parameters) {
+  using cost_type = typename graph_type::cost_type;
+  struct ExpandedEdge {
+    NodeID source;
+    NodeID target;
+    cost_type cost;
+  };
+
+  auto const number_of_edges = graph.number_of_edges();
+  std::vector<NodeID> sources(number_of_edges);
+  for (NodeID node = 0; node < graph.number_of_nodes(); ++node)
+    std::fill(sources.begin() + graph.edge_id(graph.edges_begin(node)),
+              sources.begin() + graph.edge_id(graph.edges_end(node)), node);
+
+  for (auto const &restriction : restrictions)
+    if (restriction.from >= number_of_edges ||
+        restriction.to >= number_of_edges)
+      throw std::out_of_range(
+          "Turn restriction " + std::to_string(restriction.from) + " -> " +
+          std::to_string(restriction.to) + " refers to an unknown edge.");
+  auto const by_from = [](auto const &lhs, auto const &rhs) {
+    return lhs.from < rhs.from;
+  };
+  std::sort(restrictions.begin(), restrictions.end(), by_from);
+
+  // chunks of consecutive edges are expanded independently, concatenating
+  // them keeps the turns ordered by their source
+  auto const threads = std::max<std::size_t>(1, parameters.threads);
+  std::vector<std::vector<ExpandedEdge>> chunks(threads);
+  util::parallel_for(
+      number_of_edges,
+      [&](std::size_t const begin, std::size_t const end,
+          std::size_t const chunk) {
+        auto &turns = chunks[chunk];
+        for (EdgeID from = begin; from < end; ++from) {
+          auto const via = *graph.edge(from);
+          auto const restricted =
+              std::equal_range(restrictions.begin(), restrictions.end(),
+                               TurnRestriction{from, 0}, by_from);
+          auto const mandatory = std::any_of(
+              restricted.first, restricted.second,
+              [](auto const &restriction) { return restriction.mandatory; });
+          auto const allowed = [&](EdgeID const to) {
+            auto const matches = [to](auto const &restriction) {
+              return restriction.to == to;
+            };
+            // mandatory restrictions allow only the turns they name
+            if (mandatory)
+              return std::any_of(restricted.first, restricted.second,
+                                 [&matches](auto const &restriction) {
+                                   return restriction.mandatory &&
+                                          matches(restriction);
+                                 });
+            return std::none_of(restricted.first, restricted.second, matches);
+          };
+
+          auto const first_turn = turns.size();
+          EdgeID u_turn = number_of_edges;
+          auto itr = graph.edges_begin(via);
+          auto to = graph.edge_id(itr);
+          auto const end_id = graph.edge_id(graph.edges_end(via));
+          for (; to != end_id; ++to, ++itr) {
+            if (!allowed(to))
+              continue;
+            if (*itr == sources[from] && !parameters.allow_u_turns) {
+              u_turn = to;
+              continue;
+            }
+            Turn const turn{from, via, to, *itr == sources[from]};
+            turns.push_back({from, to, turn_cost(turn) + graph.cost(to)});
+          }
+          // turning back where nothing else is allowed
+          if (turns.size() == first_turn && u_turn != number_of_edges) {
+            Turn const turn{from, via, u_turn, true};
+            turns.push_back(
+                {from, u_turn, turn_cost(turn) + graph.cost(u_turn)});
+          }
+        }
+      },
+      threads);
+
+  std::vector<ExpandedEdge> turns;
+  std::size_t number_of_turns = 0;
+  for (auto const &chunk : chunks)
+    number_of_turns += chunk.size();
+  turns.reserve(number_of_turns);
+  for (auto &chunk : chunks) {
+    turns.insert(turns.end(), chunk.begin(), chunk.end());
+    std::vector<ExpandedEdge>().swap(chunk);
+  }
+
+  EdgeExpandedGraph<cost_type> result;
+  result.graph = graph::ForwardStarFactory::produce_directed_from_edges(
+      number_of_edges, turns);
+  graph::DecoratorFactory(threads).decorate(
+      result.graph, turns, [](auto const &turn) { return turn.cost; });
+  return result;
+}
+
+} // namespace builder
+} // namespace project_x
+
+#endif // PROJECT_X_BUILDER_EDGE_EXPANSION_HPP_
@@ -0,0 +1,281 @@
+#ifndef PROJECT_X_BUILDER_EXTERNAL_GRAPH_HPP_
+#define PROJECT_X_BUILDER_EXTERNAL_GRAPH_HPP_
+
+#include "builder/external_sorter.hpp"
+#include "graph/id.hpp"
+#include "io/chunked_writer.hpp"
+#include "io/file.hpp"
+#include "log/logger.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace project_x {
+namespace builder {
+
+// The external graph builder creates graphs that exceed the available main
+// memory (e.g. planet-wide imports). Edges are spilled to disk in sorted runs,
+// external IDs are mapped via merging against the sorted set of all IDs and the
+// final graph is written to file without ever holding all edges in memory.
+// Nodes are numbered by the rank of their external ID, edges of a node keep the
+// order in which they were added.
+// The resulting files are compatible to the ones created by builder::Graph and
+// can be read via the ForwardStar/CostDecorator deserialisation.
+template <typename data_type> class ExternalGraph {
+public:
+  static_assert(std::is_trivially_copyable<data_type>::value,
+                "External graphs require trivially copyable edge data.");
+
+  // memory_bytes bounds the memory used for sorting (besides a block per
+  // temporary run), temporary runs are placed into the provided directory. The
+  // builder consumes its edges when building the graph, so it can only be
+  // stored once.
+  ExternalGraph(boost::filesystem::path temporary_directory,
+                std::size_t const memory_bytes);
+
+  void add_edge(std::uint64_t source, std::uint64_t target,
+                data_type const &data);
+
+  void build_graph_and_store(std::string const path);
+
+  // the converter translates the edge data into the weight_type stored in the
+  // CostDecorator
+  template <typename weight_type, typename converter_type>
+  void build_weighted_graph_and_store(std::string const path,
+                                      converter_type cvt);
+  template <typename weight_type>
+  void build_weighted_graph_and_store(std::string const path);
+
+private:
+  struct EdgeRecord {
+    std::uint64_t source;
+    std::uint64_t target;
+    // position of the edge in the input, to retain the order of edges
+    std::uint64_t sequence;
+    data_type data;
+  };
+
+  struct BySource {
+    bool operator()(EdgeRecord const &lhs, EdgeRecord const &rhs) const {
+      return std::tie(lhs.source, lhs.sequence) <
+             std::tie(rhs.source, rhs.sequence);
+    }
+  };
+
+  struct ByTarget {
+    bool operator()(EdgeRecord const &lhs, EdgeRecord const &rhs) const {
+      return lhs.target < rhs.target;
+    }
+  };
+
+  using edge_sorter = ExternalSorter<EdgeRecord, BySource>;
+
+  // Maps all edges onto internal node IDs and returns them sorted by their
+  // internal source ID
+  void map_ids(edge_sorter &result, std::uint64_t &number_of_nodes);
+
+  template <typename writer_type>
+  void build_and_store(std::string const path, writer_type write_decoration);
+
+  boost::filesystem::path temporary_directory;
+  std::size_t memory_bytes;
+
+  ExternalSorter<std::uint64_t> external_ids;
+  edge_sorter edges;
+};
+
+namespace detail {
+// Translates a sorted stream of external IDs (containing duplicates) into the
+// rank of each external ID within the set of all IDs
+template <typename stream_type> class RankStream {
+public:
+  RankStream(stream_type stream) : stream(std::move(stream)), rank(0) {
+    valid = this->stream.next(current);
+  }
+
+  // ranks can only be requested in ascending order of the external IDs
+  std::uint64_t rank_of(std::uint64_t const external_id) {
+    while (valid && current < external_id) {
+      std::uint64_t next;
+      valid = stream.next(next);
+      if (!valid)
+        break;
+      if (next != current)
+        ++rank;
+      current = next;
+    }
+    if (!valid || current != external_id)
+      throw std::logic_error("External ID " + std::to_string(external_id) +
+                             " has not been registered.");
+    return rank;
+  }
+
+  // the number of distinct IDs, consumes the remaining stream
+  std::uint64_t count() {
+    if (!valid)
+      return 0;
+    std::uint64_t distinct = rank + 1, next;
+    while (stream.next(next)) {
+      if (next != current)
+        ++distinct;
+      current = next;
+    }
+    valid = false;
+    return distinct;
+  }
+
+private:
+  stream_type stream;
+  std::uint64_t current;
+  std::uint64_t rank;
+  bool valid;
+};
+} // namespace detail
+
+template <typename data_type>
+ExternalGraph<data_type>::ExternalGraph(
+    boost::filesystem::path temporary_directory_,
+    std::size_t const memory_bytes)
+    : temporary_directory(std::move(temporary_directory_)),
+      memory_bytes(memory_bytes),
+      // ids and edges are collected at the same time and share the budget
+      external_ids(temporary_directory, memory_bytes / 3),
+      edges(temporary_directory, memory_bytes - memory_bytes / 3) {}
+
+template <typename data_type>
+void ExternalGraph<data_type>::add_edge(std::uint64_t source,
+                                        std::uint64_t target,
+                                        data_type const &data) {
+  edges.push({source, target, edges.size(), data});
+  external_ids.push(source);
+  external_ids.push(target);
+}
+
+template <typename data_type>
+void ExternalGraph<data_type>::map_ids(edge_sorter &result,
+                                       std::uint64_t &number_of_nodes) {
+  // All sorters share a single budget: the sorted input is moved to disk, so
+  // the sorter of each pass can use the full budget while the previous one is
+  // streamed from its runs
+  edges.finish();
+  edges.release_memory();
+  external_ids.finish();
+  external_ids.release_memory();
+
+  // relabel sources, the edges are sorted by their external source ID
+  ExternalSorter<EdgeRecord, ByTarget> by_target(temporary_directory,
+                                                 memory_bytes);
+  {
+    detail::RankStream<typename ExternalSorter<std::uint64_t>::Stream>
+        source_ranks(external_ids.stream());
+    auto stream = edges.stream();
+    EdgeRecord edge;
+    while (stream.next(edge)) {
+      edge.source = source_ranks.rank_of(edge.source);
+      by_target.push(edge);
+    }
+    number_of_nodes = source_ranks.count();
+  }
+  edges.clear();
+  by_target.finish();
+  by_target.release_memory();
+
+  // relabel targets and order the edges by their new source ID
+  detail::RankStream<typename ExternalSorter<std::uint64_t>::Stream>
+      target_ranks(external_ids.stream());
+  auto stream = by_target.stream();
+  EdgeRecord edge;
+  while (stream.next(edge)) {
+    edge.target = target_ranks.rank_of(edge.target);
+    result.push(edge);
+  }
+  result.finish();
+  external_ids.clear();
+
+  log::Logger logger;
+  logger.message(log::Level::DEBUG,
+                 "External builder: mapped " + std::to_string(number_of_nodes) +
+                     " nodes and " + std::to_string(result.size()) +
+                     " edges, using " +
+                     std::to_string(result.number_of_runs()) + " runs.");
+}
+
+template <typename data_type>
+template <typename writer_type>
+void ExternalGraph<data_type>::build_and_store(std::string const path,
+                                               writer_type write_decoration) {
+  // the buffer is only reserved once map_ids has released all others
+  edge_sorter by_source(temporary_directory, memory_bytes);
+  std::uint64_t number_of_nodes = 0;
+  map_ids(by_source, number_of_nodes);
+
+  io::File out(path,
+               io::mode::mWRITE | io::mode::mBINARY | io::mode::mVERSIONED);
+
+  // node offsets, including the sentinel
+  {
+    io::ChunkedWriter<std::uint64_t> offsets(out);
+    auto stream = by_source.stream();
+    EdgeRecord edge;
+    bool has_edge = stream.next(edge);
+    std::uint64_t offset = 0;
+    for (NodeID node = 0; node < number_of_nodes; ++node) {
+      offsets.push_back(offset);
+      while (has_edge && edge.source == node) {
+        ++offset;
+        has_edge = stream.next(edge);
+      }
+    }
+    offsets.push_back(offset);
+    offsets.finish();
+  }
+
+  // edge targets
+  {
+    io::ChunkedWriter<NodeID> targets(out);
+    auto stream = by_source.stream();
+    EdgeRecord edge;
+    while (stream.next(edge))
+      targets.push_back(static_cast<NodeID>(edge.target));
+    targets.finish();
+  }
+
+  write_decoration(out, by_source);
+}
+
+template <typename data_type>
+void ExternalGraph<data_type>::build_graph_and_store(std::string const path) {
+  build_and_store(path, [](io::File &, edge_sorter const &) {});
+}
+
+template <typename data_type>
+template <typename weight_type, typename converter_type>
+void ExternalGraph<data_type>::build_weighted_graph_and_store(
+    std::string const path, converter_type cvt) {
+  build_and_store(path, [&cvt](io::File &out, edge_sorter const &by_source) {
+    io::ChunkedWriter<weight_type> weights(out);
+    auto stream = by_source.stream();
+    EdgeRecord edge;
+    while (stream.next(edge))
+      weights.push_back(cvt(edge.data));
+    weights.finish();
+  });
+}
+
+template <typename data_type>
+template <typename weight_type>
+void ExternalGraph<data_type>::build_weighted_graph_and_store(
+    std::string const path) {
+  build_weighted_graph_and_store<weight_type>(
+      path, [](data_type const &data) { return weight_type(data); });
+}
+
+} // namespace builder
+} // namespace project_x
+
+#endif // PROJECT_X_BUILDER_EXTERNAL_GRAPH_HPP_
@@ -0,0 +1,379 @@
+#ifndef PROJECT_X_BUILDER_EXTERNAL_SORTER_HPP_
+#define PROJECT_X_BUILDER_EXTERNAL_SORTER_HPP_
+
+#include "io/file.hpp"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace builder {
+
+// Sorting of record sequences that exceed main memory. Records are collected
+// in a buffer of bounded size. Full buffers are sorted and spilled to disk as
+// runs, which are merged on the fly when the sorted sequence is streamed. The
+// sort is stable: equal records are returned in the order they were pushed.
+//
+// Runs are read in blocks. A stream holds a block per run, so the number of
+// runs merged at once (the fan-in) is bounded by the memory budget and by the
+// number of files a stream may open. If more runs are spilled, finish merges
+// groups of them into longer runs first.
+template <typename record_type,
+          typename comparator_type = std::less<record_type>>
+class ExternalSorter {
+public:
+  static_assert(std::is_trivially_copyable<record_type>::value,
+                "External sorting requires trivially copyable records.");
+
+  // memory_bytes bounds the size of the in-memory buffer as well as the
+  // blocks held while merging. Runs are stored in the provided directory and
+  // removed when the sorter is destroyed.
+  ExternalSorter(boost::filesystem::path directory,
+                 std::size_t const memory_bytes,
+                 comparator_type comparator = comparator_type());
+  ~ExternalSorter();
+
+  ExternalSorter(ExternalSorter const &) = delete;
+  ExternalSorter &operator=(ExternalSorter const &) = delete;
+
+  void push(record_type const &record);
+
+  // sorts the remaining records. Has to be called before streaming
+  void finish();
+
+  std::uint64_t size() const;
+  std::size_t number_of_runs() const;
+  // the maximal number of runs merged at once
+  std::size_t merge_fan_in() const;
+  // the bytes reserved for the in-memory buffer
+  std::size_t memory_usage() const;
+
+  // moves the records held in memory into a run and releases the buffer, so
+  // that streams only hold a block per run. Sorters sharing a memory budget
+  // hand it on this way
+  void release_memory();
+
+  // remove all records, releasing both memory and runs
+  void clear();
+
+  // A stream offers the sorted records one by one, merging all runs. Every
+  // stream replays the full sorted sequence.
+  class Stream {
+  public:
+    bool next(record_type &record);
+
+  private:
+    friend class ExternalSorter;
+    // merges the runs [first_run, last_run) of the sorter
+    Stream(ExternalSorter const &sorter, std::size_t const first_run,
+           std::size_t const last_run);
+
+    struct RunReader {
+      RunReader(boost::filesystem::path const &path);
+      bool next(record_type &record);
+
+      io::File file;
+      std::uint64_t remaining;
+      std::vector<record_type> block;
+      std::size_t position;
+    };
+
+    struct MergeEntry {
+      record_type record;
+      std::size_t reader;
+    };
+
+    // order of the merge heap, ties are broken by reader since earlier runs
+    // contain records pushed earlier
+    bool after(MergeEntry const &lhs, MergeEntry const &rhs) const;
+
+    ExternalSorter const &sorter;
+    // all records fit into memory, no merging is required
+    std::size_t buffer_position;
+    std::vector<RunReader> readers;
+    std::vector<MergeEntry> merge_heap;
+  };
+
+  Stream stream() const;
+
+private:
+  // runs kept open at once, well below the usual limit of 1024 descriptors
+  // since several sorters may stream at the same time
+  static constexpr std::size_t max_open_runs = 128;
+
+  // sort the buffer and write it to disk as a new run
+  void spill();
+
+  // merge the runs [first, last) into a single run, returning its path
+  boost::filesystem::path merge_runs(std::size_t const first,
+                                     std::size_t const last);
+
+  boost::filesystem::path new_run_path() const;
+
+  boost::filesystem::path directory;
+  comparator_type comparator;
+  std::size_t buffer_capacity;
+  std::size_t block_size;
+  std::size_t fan_in;
+  std::uint64_t number_of_records;
+
+  std::vector<record_type> buffer;
+  std::vector<boost::filesystem::path> runs;
+};
+
+template <typename record_type, typename comparator_type>
+ExternalSorter<record_type, comparator_type>::ExternalSorter(
+    boost::filesystem::path directory_, std::size_t const memory_bytes,
+    comparator_type comparator)
+    : directory(std::move(directory_)), comparator(std::move(comparator)),
+      buffer_capacity(std::max<std::size_t>(1, memory_bytes /
+                                                   sizeof(record_type))),
+      // runs are written/read in blocks, so that merging many runs only
+      // requires a block per run to be held in memory. Blocks are small
+      // enough for the budget to hold at least four of them
+      block_size(std::max<std::size_t>(
+          1, std::min<std::size_t>(buffer_capacity / 4,
+                                   (1 << 20) / sizeof(record_type)))),
+      // a merge into a new run holds an additional block for its output
+      fan_in(std::min<std::size_t>(
+          max_open_runs,
+          std::max<std::size_t>(
+              3, memory_bytes / (block_size * sizeof(record_type))) -
+              1)),
+      number_of_records(0) {}
+
+template <typename record_type, typename comparator_type>
+ExternalSorter<record_type, comparator_type>::~ExternalSorter() {
+  clear();
+}
+
+template <typename record_type, typename comparator_type>
+void ExternalSorter<record_type, comparator_type>::clear() {
+  boost::system::error_code ignored;
+  for (auto const &run : runs)
+    boost::filesystem::remove(run, ignored);
+  runs.clear();
+  std::vector<record_type>().swap(buffer);
+  number_of_records = 0;
+}
+
+template <typename record_type, typename comparator_type>
+void ExternalSorter<record_type, comparator_type>::push(
+    record_type const &record) {
+  if (buffer.capacity() < buffer_capacity)
+    buffer.reserve(buffer_capacity);
+  if (buffer.size() == buffer_capacity)
+    spill();
+  buffer.push_back(record);
+  ++number_of_records;
+}
+
+template <typename record_type, typename comparator_type>
+void ExternalSorter<record_type, comparator_type>::finish() {
+  // if nothing has been spilled, the sorted buffer can be streamed directly
+  if (runs.empty()) {
+    std::stable_sort(buffer.begin(), buffer.end(), comparator);
+    return;
+  }
+  release_memory();
+
+  // Merging consecutive runs keeps the sort stable, the merged run takes the
+  // place of its group.
+  while (runs.size() > fan_in) {
+    std::vector<boost::filesystem::path> merged;
+    for (std::size_t first = 0; first < runs.size(); first += fan_in) {
+      auto const last = std::min(runs.size(), first + fan_in);
+      merged.push_back(last - first == 1 ? runs[first]
+                                         : merge_runs(first, last));
+    }
+    runs = std::move(merged);
+  }
+}
+
+template <typename record_type, typename comparator_type>
+void ExternalSorter<record_type, comparator_type>::release_memory() {
+  if (!buffer.empty())
+    spill();
+  std::vector<record_type>().swap(buffer);
+}
+
+template <typename record_type, typename comparator_type>
+std::uint64_t ExternalSorter<record_type, comparator_type>::size() const {
+  return number_of_records;
+}
+
+template <typename record_type, typename comparator_type>
+std::size_t
+ExternalSorter<record_type, comparator_type>::number_of_runs() const {
+  return runs.size();
+}
+
+template <typename record_type, typename comparator_type>
+std::size_t ExternalSorter<record_type, comparator_type>::merge_fan_in() const {
+  return fan_in;
+}
+
+template <typename record_type, typename comparator_type>
+std::size_t ExternalSorter<record_type, comparator_type>::memory_usage() const {
+  return buffer.capacity() * sizeof(record_type);
+}
+
+template <typename record_type, typename comparator_type>
+void ExternalSorter<record_type, comparator_type>::spill() {
+  std::stable_sort(buffer.begin(), buffer.end(), comparator);
+
+  auto path = new_run_path();
+  io::File file(path, io::mode::mWRITE | io::mode::mBINARY);
+  runs.push_back(path);
+
+  std::uint64_t const run_size = buffer.size();
+  file.write_pod(run_size);
+  std::vector<record_type> block;
+  block.reserve(block_size);
+  for (std::size_t offset = 0; offset < buffer.size(); offset += block_size) {
+    auto const end = std::min(buffer.size(), offset + block_size);
+    block.assign(buffer.begin() + offset, buffer.begin() + end);
+    file.write_pod_container(block);
+  }
+  buffer.clear();
+}
+
+template <typename record_type, typename comparator_type>
+boost::filesystem::path
+ExternalSorter<record_type, comparator_type>::merge_runs(
+    std::size_t const first, std::size_t const last) {
+  auto path = new_run_path();
+  {
+    io::File file(path, io::mode::mWRITE | io::mode::mBINARY);
+    // the size of the run is known once all records are merged
+    std::uint64_t run_size = 0;
+    file.write_pod(run_size);
+
+    Stream stream(*this, first, last);
+    std::vector<record_type> block;
+    block.reserve(block_size);
+    record_type record;
+    while (stream.next(record)) {
+      block.push_back(record);
+      if (block.size() == block_size) {
+        file.write_pod_container(block);
+        run_size += block.size();
+        block.clear();
+      }
+    }
+    if (!block.empty()) {
+      file.write_pod_container(block);
+      run_size += block.size();
+    }
+    file.seek(0);
+    file.write_pod(run_size);
+  }
+
+  boost::system::error_code ignored;
+  for (auto run = first; run < last; ++run)
+    boost::filesystem::remove(runs[run], ignored);
+  return path;
+}
+
+template <typename record_type, typename comparator_type>
+boost::filesystem::path
+ExternalSorter<record_type, comparator_type>::new_run_path() const {
+  return directory /
+         boost::filesystem::unique_path("xsort-%%%%-%%%%-%%%%-%%%%.run");
+}
+
+template <typename record_type, typename comparator_type>
+typename ExternalSorter<record_type, comparator_type>::Stream
+ExternalSorter<record_type, comparator_type>::stream() const {
+  return Stream(*this, 0, runs.size());
+}
+
+template <typename record_type, typename comparator_type>
+ExternalSorter<record_type, comparator_type>::Stream::RunReader::RunReader(
+    boost::filesystem::path const &path)
+    : file(path, io::mode::mREAD | io::mode::mBINARY), remaining(0),
+      position(0) {
+  file.read_pod(remaining);
+}
+
+template <typename record_type, typename comparator_type>
+bool ExternalSorter<record_type, comparator_type>::Stream::RunReader::next(
+    record_type &record) {
+  if (position == block.size()) {
+    if (remaining == 0)
+      return false;
+    file.read_pod_container(block);
+    remaining -= block.size();
+    position = 0;
+  }
+  record = block[position++];
+  return true;
+}
+
+template <typename record_type, typename comparator_type>
+ExternalSorter<record_type, comparator_type>::Stream::Stream(
+    ExternalSorter const &sorter, std::size_t const first_run,
+    std::size_t const last_run)
+    : sorter(sorter), buffer_position(0) {
+  readers.reserve(last_run - first_run);
+  for (auto run = first_run; run < last_run; ++run) {
+    readers.emplace_back(sorter.runs[run]);
+    record_type record;
+    if (readers.back().next(record))
+      merge_heap.push_back({record, readers.size() - 1});
+  }
+  std::make_heap(merge_heap.begin(), merge_heap.end(),
+                 [this](auto const &lhs, auto const &rhs) {
+                   return after(lhs, rhs);
+                 });
+}
+
+template <typename record_type, typename comparator_type>
+bool ExternalSorter<record_type, comparator_type>::Stream::after(
+    MergeEntry const &lhs, MergeEntry const &rhs) const {
+  if (sorter.comparator(rhs.record, lhs.record))
+    return true;
+  if (sorter.comparator(lhs.record, rhs.record))
+    return false;
+  return lhs.reader > rhs.reader;
+}
+
+template <typename record_type, typename comparator_type>
+bool ExternalSorter<record_type, comparator_type>::Stream::next(
+    record_type &record) {
+  if (readers.empty()) {
+    if (buffer_position == sorter.buffer.size())
+      return false;
+    record = sorter.buffer[buffer_position++];
+    return true;
+  }
+
+  if (merge_heap.empty())
+    return false;
+
+  auto const heap_order = [this](auto const &lhs, auto const &rhs) {
+    return after(lhs, rhs);
+  };
+
+  std::pop_heap(merge_heap.begin(), merge_heap.end(), heap_order);
+  auto &front = merge_heap.back();
+  record = front.record;
+  if (readers[front.reader].next(front.record))
+    std::push_heap(merge_heap.begin(), merge_heap.end(), heap_order);
+  else
+    merge_heap.pop_back();
+  return true;
+}
+
+} // namespace builder
+} // namespace project_x
+
+#endif // PROJECT_X_BUILDER_EXTERNAL_SORTER_HPP_
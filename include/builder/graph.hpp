@@ -1,24 +1,35 @@
 #ifndef PROJECT_X_BUILDER_GRAPH_HPP_
 #define PROJECT_X_BUILDER_GRAPH_HPP_
 
+#include <algorithm>
 #include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <tuple>
-#include <unordered_map>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "builder/conversion.hpp"
+#include "container/dictionary.hpp"
+#include "container/flat_hash_map.hpp"
+#include "geometry/coordinate.hpp"
 #include "graph/decorator.hpp"
-#include "graph/decorator_factory.hpp"
-#include "graph/forward_star_factory.hpp"
 #include "graph/id.hpp"
+#include "graph/id_mapping.hpp"
+#include "io/chunked_writer.hpp"
 #include "io/file.hpp"
+#include "io/section.hpp"
+#include "log/logger.hpp"
+#include "spatial/grid_index.hpp"
+#include "util/parallel.hpp"
 
 namespace project_x {
 namespace builder {
 
 template <typename... Types> struct Edge {
+  using data_type = std::tuple<Types...>;
+
   Edge(NodeID source, NodeID target, Types &&... data)
       : source(source), target(target), data(std::forward<Types>(data)...) {}
 
@@ -26,71 +37,410 @@ template <typename... Types> struct Edge {
   NodeID target;
 
   // the data will contain the cost (one to n elements) and a possible string
-  // payload, to encode json objects, pbf buffers or similar
+  // payload, to encode json objects, pbf buffers or similar. Payloads stored as
+  // container::DictionaryID are interned by the graph builder.
   std::tuple<Types...> data;
 };
 
+namespace detail {
+// Edge data of type DictionaryID is interned into the payload dictionary when
+// it is passed as a payload value. All other data (including already interned
+// IDs) is forwarded as is.
+template <typename element_type, typename dictionary_type,
+          typename argument_type>
+using is_internable = std::integral_constant<
+    bool,
+    std::is_same<element_type, container::DictionaryID>::value &&
+        std::is_convertible<argument_type, typename dictionary_type::value_type
+                                               const &>::value>;
+
+template <typename element_type, typename dictionary_type,
+          typename argument_type>
+typename std::enable_if<
+    is_internable<element_type, dictionary_type, argument_type>::value,
+    element_type>::type
+intern(dictionary_type &dictionary, argument_type &&argument) {
+  return dictionary.intern(std::forward<argument_type>(argument));
+}
+
+template <typename element_type, typename dictionary_type,
+          typename argument_type>
+typename std::enable_if<
+    !is_internable<element_type, dictionary_type, argument_type>::value,
+    element_type>::type
+intern(dictionary_type &, argument_type &&argument) {
+  return element_type(std::forward<argument_type>(argument));
+}
+} // namespace detail
+
 template <typename Edge> class Graph {
 public:
+  using payload_dictionary = container::Dictionary<std::string>;
+
   template <typename... Types>
   void add_edge(std::uint64_t source, std::uint64_t target, Types &&... data);
-  void build_graph_and_store(std::string const path);
+
+  // add a batch of edges. The edge data is provided column-wise, every column
+  // holding one entry per edge.
+  template <typename... Types>
+  void add_edges(std::size_t const count, std::uint64_t const *sources,
+                 std::uint64_t const *targets, Types const *... columns);
+
+  // reserve space for an expected number of nodes/edges
+  void reserve(std::size_t const number_of_nodes,
+               std::size_t const number_of_edges);
+
+  // the mode can add io::mode::mCOMPRESSED to compress the stored graph
+  void build_graph_and_store(std::string const path,
+                             io::mode::Enum const mode = 0);
 
   template <typename weight_type>
-  void build_weighted_graph_and_store(std::string const path);
+  void build_weighted_graph_and_store(std::string const path,
+                                      io::mode::Enum const mode = 0);
+
+  // store the weighted graph together with the interned payloads of all edges.
+  // Requires the edge data to contain exactly one container::DictionaryID
+  template <typename weight_type>
+  void build_annotated_graph_and_store(std::string const path,
+                                       io::mode::Enum const mode = 0);
+
+  // The same graphs as sectioned files (see io::SectionWriter), e.g. to load
+  // them via graph::AsyncLoader. Encoding::BLOCK_PACKED compresses them
+  void build_graph_and_store_sections(
+      std::string const path, io::Encoding const encoding = io::Encoding::RAW);
+  template <typename weight_type>
+  void build_weighted_graph_and_store_sections(
+      std::string const path, io::Encoding const encoding = io::Encoding::RAW);
+  template <typename weight_type>
+  void build_annotated_graph_and_store_sections(
+      std::string const path, io::Encoding const encoding = io::Encoding::RAW);
+
+  payload_dictionary const &payloads() const;
+  // intern a payload up front, e.g. to add edges via its ID in batches
+  container::DictionaryID add_payload(std::string const &payload);
+
+  // store the translation of external IDs into the NodeIDs of the graph
+  void store_id_mapping(std::string const path) const;
+
+  // Locate the nodes of the graph. Coordinates of IDs that are not part of any
+  // edge are ignored, so they have to be added after the edges.
+  void add_coordinates(std::size_t const count,
+                       std::uint64_t const *external_ids,
+                       geometry::WGS84FixedCoorinate const *locations);
+
+  // store a spatial::GridIndex over the edges of the graph, built on multiple
+  // threads. Edge IDs match the stored graph, all nodes need a coordinate
+  void build_spatial_index_and_store(
+      std::string const path,
+      std::size_t const threads = util::default_concurrency(),
+      io::mode::Enum const mode = 0);
 
 private:
-  std::unordered_map<std::uint64_t, std::uint64_t> id_map;
+  template <std::size_t... indices, typename... Types>
+  void add_mapped_edge(NodeID source, NodeID target,
+                       std::index_sequence<indices...>, Types &&... data);
+
+  // edges are ordered by their source in stored graphs, their position is
+  // their EdgeID
+  void sort_edges();
+
+  // Graphs are streamed into the file as they are produced, in the layout of
+  // their serialise functions, instead of being built in memory first.
+  // store_topology sorts the edges and writes the layout of a
+  // graph::ForwardStar, into a stream or into the sections of its containers
+  void store_topology(io::File &out);
+  void store_topology(io::SectionWriter &writer);
+  void store_offsets(io::File &out) const;
+  void store_targets(io::File &out) const;
+  // the sections of a graph::edge::CostDecorator over the forward star
+  template <typename weight_type>
+  void store_weighted_sections(io::SectionWriter &writer);
+  // the decoration of all edges, in the order of store_topology. Edges are
+  // converted in parallel, a batch at a time
+  template <typename value_type, typename converter_type>
+  void store_decoration(io::File &out, converter_type cvt) const;
+
+  container::FlatHashMap<std::uint64_t, NodeID> id_map;
   std::vector<Edge> edges;
+  payload_dictionary dictionary;
+  // coordinates by NodeID, nodes without coordinate are not located
+  std::vector<geometry::WGS84FixedCoorinate> coordinates;
+  std::vector<bool> located;
 };
 
 template <typename Edge>
 template <typename... Types>
 void Graph<Edge>::add_edge(std::uint64_t source, std::uint64_t target,
                            Types &&... data) {
-  auto const to_node_id = [this](auto const external_id) {
-    auto const itr = id_map.find(external_id);
-    if (itr == id_map.end()) {
-      std::uint64_t new_id = id_map.size();
-      id_map.insert(itr, std::make_pair(external_id, new_id));
-      return new_id;
-    } else {
-      return itr->second;
-    }
-  };
+  // a single probe per ID, new IDs are numbered in order of appearance
+  auto mapped_source = id_map.insert(source, id_map.size()).first;
+  auto mapped_target = id_map.insert(target, id_map.size()).first;
+  add_mapped_edge(mapped_source, mapped_target,
+                  std::index_sequence_for<Types...>(),
+                  std::forward<Types>(data)...);
+}
 
-  auto mapped_source = to_node_id(source);
-  auto mapped_target = to_node_id(target);
-  edges.push_back(
-      Edge(mapped_source, mapped_target, std::forward<Types>(data)...));
+template <typename Edge>
+template <typename... Types>
+void Graph<Edge>::add_edges(std::size_t const count,
+                            std::uint64_t const *sources,
+                            std::uint64_t const *targets,
+                            Types const *... columns) {
+  // interleave sources and targets, to number nodes in the same order as
+  // adding the edges one by one would
+  std::vector<std::uint64_t> external_ids(2 * count);
+  for (std::size_t i = 0; i < count; ++i) {
+    external_ids[2 * i] = sources[i];
+    external_ids[2 * i + 1] = targets[i];
+  }
+  std::vector<NodeID> node_ids(2 * count);
+  id_map.insert_batch(external_ids.data(), external_ids.size(),
+                      node_ids.data(), [this]() { return id_map.size(); });
+
+  edges.reserve(edges.size() + count);
+  for (std::size_t i = 0; i < count; ++i)
+    add_mapped_edge(node_ids[2 * i], node_ids[2 * i + 1],
+                    std::index_sequence_for<Types...>(), columns[i]...);
 }
 
 template <typename Edge>
-void Graph<Edge>::build_graph_and_store(std::string path) {
-  auto const graph = graph::ForwardStarFactory::produce_directed_from_edges(
-      id_map.size(), edges);
+void Graph<Edge>::reserve(std::size_t const number_of_nodes,
+                          std::size_t const number_of_edges) {
+  id_map.reserve(number_of_nodes);
+  edges.reserve(number_of_edges);
+}
+
+template <typename Edge>
+template <std::size_t... indices, typename... Types>
+void Graph<Edge>::add_mapped_edge(NodeID source, NodeID target,
+                                  std::index_sequence<indices...>,
+                                  Types &&... data) {
+  using data_type = typename Edge::data_type;
+  edges.push_back(Edge(
+      source, target,
+      detail::intern<typename std::tuple_element<indices, data_type>::type>(
+          dictionary, std::forward<Types>(data))...));
+}
+
+template <typename Edge>
+typename Graph<Edge>::payload_dictionary const &Graph<Edge>::payloads() const {
+  return dictionary;
+}
+
+template <typename Edge>
+container::DictionaryID Graph<Edge>::add_payload(std::string const &payload) {
+  return dictionary.intern(payload);
+}
+
+template <typename Edge>
+void Graph<Edge>::store_id_mapping(std::string const path) const {
+  std::vector<std::pair<std::uint64_t, NodeID>> mapping;
+  mapping.reserve(id_map.size());
+  id_map.for_each([&mapping](auto const external_id, auto const node_id) {
+    mapping.emplace_back(external_id, node_id);
+  });
 
   io::File out(path,
                io::mode::mWRITE | io::mode::mBINARY | io::mode::mVERSIONED);
-  graph.serialise(out);
+  graph::IDMapping(std::move(mapping)).serialise(out);
+}
+
+template <typename Edge>
+void Graph<Edge>::add_coordinates(
+    std::size_t const count, std::uint64_t const *external_ids,
+    geometry::WGS84FixedCoorinate const *locations) {
+  coordinates.resize(id_map.size());
+  located.resize(id_map.size(), false);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const node = id_map.find(external_ids[i]);
+    if (!node)
+      continue;
+    coordinates[*node] = locations[i];
+    located[*node] = true;
+  }
+}
+
+template <typename Edge> void Graph<Edge>::sort_edges() {
+  // stable, so repeated calls keep the EdgeIDs of earlier ones
+  std::stable_sort(edges.begin(), edges.end(),
+                   [](auto const &lhs, auto const &rhs) {
+                     return lhs.source < rhs.source;
+                   });
+}
+
+template <typename Edge> void Graph<Edge>::store_offsets(io::File &out) const {
+  // node offsets, including the sentinel
+  io::ChunkedWriter<std::uint64_t> offsets(out, id_map.size() + 1);
+  auto edge = edges.begin();
+  for (NodeID node = 0; node < id_map.size(); ++node) {
+    offsets.push_back(std::distance(edges.begin(), edge));
+    while (edge != edges.end() && edge->source == node)
+      ++edge;
+  }
+  offsets.push_back(edges.size());
+  offsets.finish();
+}
+
+template <typename Edge> void Graph<Edge>::store_targets(io::File &out) const {
+  io::ChunkedWriter<NodeID> targets(out, edges.size());
+  for (auto const &edge : edges)
+    targets.push_back(edge.target);
+  targets.finish();
+}
+
+template <typename Edge> void Graph<Edge>::store_topology(io::File &out) {
+  sort_edges();
+  store_offsets(out);
+  store_targets(out);
+
+  log::Logger logger;
+  logger.message(log::Level::DEBUG,
+                 "Builder: streamed " + std::to_string(id_map.size()) +
+                     " nodes and " + std::to_string(edges.size()) +
+                     " edges.");
+}
+
+template <typename Edge>
+void Graph<Edge>::store_topology(io::SectionWriter &writer) {
+  // the sections of graph::ForwardStar::serialise
+  sort_edges();
+  store_offsets(writer.begin("forward_star.offsets"));
+  writer.end();
+  store_targets(writer.begin("forward_star.targets"));
+  writer.end();
+}
+
+template <typename Edge>
+template <typename value_type, typename converter_type>
+void Graph<Edge>::store_decoration(io::File &out, converter_type cvt) const {
+  // converted values of a batch of edges, bounding the memory used
+  std::size_t const batch_size = 1 << 20;
+  std::vector<value_type> batch(std::min(batch_size, edges.size()));
+  io::ChunkedWriter<value_type> decoration(out, edges.size());
+  for (std::size_t first = 0; first < edges.size(); first += batch_size) {
+    auto const count = std::min(batch_size, edges.size() - first);
+    util::parallel_for(count, [&](std::size_t const begin,
+                                  std::size_t const end, std::size_t) {
+      for (auto index = begin; index < end; ++index)
+        batch[index] = cvt(edges[first + index]);
+    });
+    decoration.append(batch.data(), count);
+  }
+  decoration.finish();
+}
+
+template <typename Edge>
+void Graph<Edge>::build_graph_and_store(std::string path,
+                                        io::mode::Enum const mode) {
+  io::File out(path, io::mode::mWRITE | io::mode::mBINARY |
+                         io::mode::mVERSIONED | mode);
+  store_topology(out);
+}
+
+template <typename Edge>
+template <typename WeightType>
+void Graph<Edge>::build_weighted_graph_and_store(std::string const path,
+                                                 io::mode::Enum const mode) {
+  // layout of a graph::edge::CostDecorator<WeightType, graph::ForwardStar>
+  io::File out(path, io::mode::mWRITE | io::mode::mBINARY |
+                         io::mode::mVERSIONED | mode);
+  store_topology(out);
+  store_decoration<WeightType>(out, [](Edge const &edge) {
+    return builder::decoration::convert<Edge, WeightType>(edge);
+  });
 }
 
 template <typename Edge>
 template <typename WeightType>
-void Graph<Edge>::build_weighted_graph_and_store(std::string const path) {
-  using WeightedGraph =
+void Graph<Edge>::build_annotated_graph_and_store(std::string const path,
+                                                  io::mode::Enum const mode) {
+  // layout of a graph::edge::DictionaryDecorator<std::string, WeightedGraph>
+  io::File out(path, io::mode::mWRITE | io::mode::mBINARY |
+                         io::mode::mVERSIONED | mode);
+  store_topology(out);
+  store_decoration<WeightType>(out, [](Edge const &edge) {
+    return builder::decoration::convert<Edge, WeightType>(edge);
+  });
+  store_decoration<container::DictionaryID>(out, [](auto const &edge) {
+    return std::get<container::DictionaryID>(edge.data);
+  });
+  dictionary.serialise(out);
+}
+
+template <typename Edge>
+void Graph<Edge>::build_graph_and_store_sections(std::string const path,
+                                                 io::Encoding const encoding) {
+  io::SectionWriter writer(path, 64, encoding);
+  store_topology(writer);
+}
+
+template <typename Edge>
+template <typename WeightType>
+void Graph<Edge>::store_weighted_sections(io::SectionWriter &writer) {
+  // sections of a graph::edge::CostDecorator<WeightType, graph::ForwardStar>
+  using weighted_graph =
       graph::edge::CostDecorator<WeightType, graph::ForwardStar>;
+  store_topology(writer);
+  store_decoration<WeightType>(
+      writer.begin(graph::edge::detail::section_name(
+          "cost", weighted_graph::decoration_layer)),
+      [](Edge const &edge) {
+        return builder::decoration::convert<Edge, WeightType>(edge);
+      });
+  writer.end();
+}
 
-  WeightedGraph graph(graph::ForwardStarFactory::produce_directed_from_edges(
-      id_map.size(), edges));
+template <typename Edge>
+template <typename WeightType>
+void Graph<Edge>::build_weighted_graph_and_store_sections(
+    std::string const path, io::Encoding const encoding) {
+  io::SectionWriter writer(path, 64, encoding);
+  store_weighted_sections<WeightType>(writer);
+}
+
+template <typename Edge>
+template <typename WeightType>
+void Graph<Edge>::build_annotated_graph_and_store_sections(
+    std::string const path, io::Encoding const encoding) {
+  // sections of a graph::edge::DictionaryDecorator<std::string, WeightedGraph>
+  using annotated_graph = graph::edge::DictionaryDecorator<
+      std::string, graph::edge::CostDecorator<WeightType, graph::ForwardStar>>;
+  io::SectionWriter writer(path, 64, encoding);
+  store_weighted_sections<WeightType>(writer);
+  store_decoration<container::DictionaryID>(
+      writer.begin(graph::edge::detail::section_name(
+          "payload_ids", annotated_graph::decoration_layer)),
+      [](auto const &edge) {
+        return std::get<container::DictionaryID>(edge.data);
+      });
+  writer.end();
+  dictionary.serialise(writer.begin(graph::edge::detail::section_name(
+      "payloads", annotated_graph::decoration_layer)));
+  writer.end();
+}
 
-  graph::DecoratorFactory decorator_factory;
-  decorator_factory.decorate(graph, edges,
-                             builder::decoration::convert<Edge, WeightType>);
+template <typename Edge>
+void Graph<Edge>::build_spatial_index_and_store(std::string const path,
+                                                std::size_t const threads,
+                                                io::mode::Enum const mode) {
+  located.resize(id_map.size(), false);
+  auto const missing = std::find(located.begin(), located.end(), false);
+  if (missing != located.end())
+    throw std::logic_error(
+        "Node " + std::to_string(std::distance(located.begin(), missing)) +
+        " has no coordinate.");
+  coordinates.resize(id_map.size());
 
-  io::File out(path,
-               io::mode::mWRITE | io::mode::mBINARY | io::mode::mVERSIONED);
-  graph.serialise(out);
+  sort_edges();
+  std::vector<spatial::IndexedEdge> indexed_edges(edges.size());
+  for (std::size_t edge = 0; edge < edges.size(); ++edge)
+    indexed_edges[edge] = {edge, edges[edge].source, edges[edge].target};
+
+  spatial::GridIndex const index(coordinates, std::move(indexed_edges),
+                                 threads);
+  io::File out(path, io::mode::mWRITE | io::mode::mBINARY |
+                         io::mode::mVERSIONED | mode);
+  index.serialise(out);
 }
 
 } // namespace builder
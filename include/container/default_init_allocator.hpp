@@ -0,0 +1,46 @@
+#ifndef PROJECT_X_CONTAINER_DEFAULT_INIT_ALLOCATOR_HPP_
+#define PROJECT_X_CONTAINER_DEFAULT_INIT_ALLOCATOR_HPP_
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace project_x {
+namespace container {
+
+// Allocator adaptor that default-initialises instead of value-initialising
+// elements constructed without arguments. For trivial types (IDs, offsets,
+// weights) resizing a vector then leaves the memory untouched, instead of
+// writing zeros that are overwritten immediately when filling it from a file.
+template <typename value_type,
+          typename allocator_type = std::allocator<value_type>>
+class DefaultInitAllocator : public allocator_type {
+  using traits = std::allocator_traits<allocator_type>;
+
+public:
+  template <typename other_type> struct rebind {
+    using other = DefaultInitAllocator<
+        other_type, typename traits::template rebind_alloc<other_type>>;
+  };
+
+  using allocator_type::allocator_type;
+  DefaultInitAllocator() = default;
+
+  template <typename element_type>
+  void construct(element_type *element) noexcept(
+      std::is_nothrow_default_constructible<element_type>::value) {
+    ::new (static_cast<void *>(element)) element_type;
+  }
+
+  template <typename element_type, typename... argument_types>
+  void construct(element_type *element, argument_types &&... arguments) {
+    traits::construct(static_cast<allocator_type &>(*this), element,
+                      std::forward<argument_types>(arguments)...);
+  }
+};
+
+} // namespace container
+} // namespace project_x
+
+#endif // PROJECT_X_CONTAINER_DEFAULT_INIT_ALLOCATOR_HPP_
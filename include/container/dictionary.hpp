@@ -0,0 +1,126 @@
+#ifndef PROJECT_X_CONTAINER_DICTIONARY_HPP_
+#define PROJECT_X_CONTAINER_DICTIONARY_HPP_
+
+#include "io/file.hpp"
+#include "io/wrappers.hpp"
+#include "traits/strong_typedef.hpp"
+#include "traits/typemap.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace project_x {
+namespace container {
+
+// IDs into a dictionary are limited to 32 bit to keep per-edge references small
+using DictionaryID =
+    traits::strong_typedef<std::uint32_t, traits::typemap::tagDictionaryID>;
+
+// A dictionary interns values, so that payloads repeated over millions of edges
+// (road classes, names, ...) are stored only once. Distinct values are numbered
+// in order of their first appearance.
+template <typename value_type_t> class Dictionary {
+public:
+  using value_type = value_type_t;
+  using id_type = DictionaryID;
+
+  // return the ID of a value, adding the value if it is not known yet
+  id_type intern(value_type const &value);
+  std::optional<id_type> find(value_type const &value) const;
+
+  value_type const &operator[](id_type const id) const;
+
+  bool empty() const;
+  std::size_t size() const;
+  void clear();
+
+  void serialise(io::File &file) const;
+  void deserialise(io::File &file);
+
+private:
+  // non-POD values (e.g. strings) need to be wrapped to be written to file
+  using stored_type =
+      typename std::conditional<std::is_pod<value_type>::value, value_type,
+                                io::SerialisableContainer<value_type>>::type;
+
+  static value_type const &unwrap(value_type const &value) { return value; }
+  template <typename wrapped_type>
+  static value_type const &unwrap(wrapped_type const &value) {
+    return *value;
+  }
+
+  std::vector<stored_type> values;
+  std::unordered_map<value_type, std::uint32_t> lookup;
+};
+
+template <typename value_type_t>
+typename Dictionary<value_type_t>::id_type
+Dictionary<value_type_t>::intern(value_type const &value) {
+  auto const itr = lookup.find(value);
+  if (itr != lookup.end())
+    return {itr->second};
+
+  if (values.size() == std::numeric_limits<std::uint32_t>::max())
+    throw std::length_error(
+        "Dictionary exceeds the number of values addressable by 32 bit IDs.");
+
+  auto const new_id = static_cast<std::uint32_t>(values.size());
+  lookup.insert(itr, std::make_pair(value, new_id));
+  values.push_back(stored_type(value));
+  return {new_id};
+}
+
+template <typename value_type_t>
+std::optional<typename Dictionary<value_type_t>::id_type>
+Dictionary<value_type_t>::find(value_type const &value) const {
+  auto const itr = lookup.find(value);
+  if (itr == lookup.end())
+    return {};
+  return id_type{itr->second};
+}
+
+template <typename value_type_t>
+value_type_t const &Dictionary<value_type_t>::
+operator[](id_type const id) const {
+  return unwrap(values[id.base()]);
+}
+
+template <typename value_type_t> bool Dictionary<value_type_t>::empty() const {
+  return values.empty();
+}
+
+template <typename value_type_t>
+std::size_t Dictionary<value_type_t>::size() const {
+  return values.size();
+}
+
+template <typename value_type_t> void Dictionary<value_type_t>::clear() {
+  values.clear();
+  lookup.clear();
+}
+
+template <typename value_type_t>
+void Dictionary<value_type_t>::serialise(io::File &file) const {
+  file.write_container(values);
+}
+
+template <typename value_type_t>
+void Dictionary<value_type_t>::deserialise(io::File &file) {
+  file.read_container(values);
+  // the lookup is only required for interning and can be restored from the
+  // values themselves
+  lookup.clear();
+  lookup.reserve(values.size());
+  for (std::uint32_t id = 0; id < values.size(); ++id)
+    lookup.emplace(unwrap(values[id]), id);
+}
+
+} // namespace container
+} // namespace project_x
+
+#endif // PROJECT_X_CONTAINER_DICTIONARY_HPP_
@@ -0,0 +1,202 @@
+#ifndef PROJECT_X_CONTAINER_FLAT_HASH_MAP_HPP_
+#define PROJECT_X_CONTAINER_FLAT_HASH_MAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace container {
+
+// Open addressing hash map with linear probing for integral keys. All entries
+// are stored in a single flat array, so a lookup usually touches a single cache
+// line and no allocation happens per entry. The maximal key value is reserved
+// to mark empty slots and cannot be inserted.
+template <typename key_type, typename value_type> class FlatHashMap {
+public:
+  static_assert(std::is_integral<key_type>::value,
+                "FlatHashMap requires integral keys.");
+
+  FlatHashMap();
+
+  std::optional<value_type> find(key_type const key) const;
+
+  // insert a new key/value pair. Returns the value stored with the key and
+  // whether the key was inserted (true) or existed before (false)
+  std::pair<value_type, bool> insert(key_type const key, value_type value);
+
+  // Looks up a batch of keys, inserting keys that are not present with the
+  // value provided by the generator. The stored values are written to values.
+  // Slots for upcoming keys are prefetched to hide the memory latency of the
+  // random accesses.
+  template <typename generator_type>
+  void insert_batch(key_type const *keys, std::size_t const count,
+                    value_type *values, generator_type generate_value);
+
+  // visit all key/value pairs in unspecified order
+  template <typename visitor_type> void for_each(visitor_type visitor) const;
+
+  void reserve(std::size_t const size);
+  bool empty() const;
+  std::size_t size() const;
+  void clear();
+
+private:
+  static constexpr key_type empty_key = ~key_type(0);
+  // distance (in keys) of prefetches ahead of the current key in a batch
+  static constexpr std::size_t prefetch_distance = 16;
+
+  struct Slot {
+    key_type key;
+    value_type value;
+  };
+
+  std::size_t slot_of(key_type const key) const;
+  void rehash(std::size_t const capacity);
+  bool requires_growth(std::size_t const size) const;
+
+  std::vector<Slot> slots;
+  std::size_t count;
+};
+
+template <typename key_type, typename value_type>
+FlatHashMap<key_type, value_type>::FlatHashMap() : count(0) {
+  rehash(16);
+}
+
+template <typename key_type, typename value_type>
+std::size_t
+FlatHashMap<key_type, value_type>::slot_of(key_type const key) const {
+  // finaliser of murmur3, spreads sequential IDs over the table
+  auto hash = static_cast<std::uint64_t>(key);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return hash & (slots.size() - 1);
+}
+
+template <typename key_type, typename value_type>
+bool FlatHashMap<key_type, value_type>::requires_growth(
+    std::size_t const size) const {
+  // keep the load factor below 0.7 to keep probe sequences short
+  return size * 10 > slots.size() * 7;
+}
+
+template <typename key_type, typename value_type>
+void FlatHashMap<key_type, value_type>::rehash(std::size_t const capacity) {
+  std::vector<Slot> old_slots(capacity, Slot{empty_key, value_type()});
+  old_slots.swap(slots);
+  for (auto const &slot : old_slots) {
+    if (slot.key == empty_key)
+      continue;
+    auto index = slot_of(slot.key);
+    while (slots[index].key != empty_key)
+      index = (index + 1) & (slots.size() - 1);
+    slots[index] = slot;
+  }
+}
+
+template <typename key_type, typename value_type>
+void FlatHashMap<key_type, value_type>::reserve(std::size_t const size) {
+  auto capacity = slots.size();
+  while (size * 10 > capacity * 7)
+    capacity *= 2;
+  if (capacity != slots.size())
+    rehash(capacity);
+}
+
+template <typename key_type, typename value_type>
+std::optional<value_type>
+FlatHashMap<key_type, value_type>::find(key_type const key) const {
+  for (auto index = slot_of(key); slots[index].key != empty_key;
+       index = (index + 1) & (slots.size() - 1)) {
+    if (slots[index].key == key)
+      return slots[index].value;
+  }
+  return {};
+}
+
+template <typename key_type, typename value_type>
+std::pair<value_type, bool>
+FlatHashMap<key_type, value_type>::insert(key_type const key,
+                                          value_type value) {
+  if (key == empty_key)
+    throw std::invalid_argument(
+        "The maximal key is reserved and cannot be inserted.");
+
+  if (requires_growth(count + 1))
+    rehash(slots.size() * 2);
+
+  auto index = slot_of(key);
+  while (slots[index].key != empty_key) {
+    if (slots[index].key == key)
+      return {slots[index].value, false};
+    index = (index + 1) & (slots.size() - 1);
+  }
+  slots[index] = {key, value};
+  ++count;
+  return {value, true};
+}
+
+template <typename key_type, typename value_type>
+template <typename generator_type>
+void FlatHashMap<key_type, value_type>::insert_batch(
+    key_type const *keys, std::size_t const batch_size, value_type *values,
+    generator_type generate_value) {
+  // ensure no rehashing happens within the batch, invalidating the prefetches
+  reserve(count + batch_size);
+  for (std::size_t i = 0; i < batch_size; ++i) {
+    if (i + prefetch_distance < batch_size)
+      __builtin_prefetch(&slots[slot_of(keys[i + prefetch_distance])]);
+
+    auto const key = keys[i];
+    auto index = slot_of(key);
+    while (slots[index].key != empty_key && slots[index].key != key)
+      index = (index + 1) & (slots.size() - 1);
+
+    if (slots[index].key == empty_key) {
+      if (key == empty_key)
+        throw std::invalid_argument(
+            "The maximal key is reserved and cannot be inserted.");
+      slots[index] = {key, generate_value()};
+      ++count;
+    }
+    values[i] = slots[index].value;
+  }
+}
+
+template <typename key_type, typename value_type>
+template <typename visitor_type>
+void FlatHashMap<key_type, value_type>::for_each(visitor_type visitor) const {
+  for (auto const &slot : slots)
+    if (slot.key != empty_key)
+      visitor(slot.key, slot.value);
+}
+
+template <typename key_type, typename value_type>
+bool FlatHashMap<key_type, value_type>::empty() const {
+  return count == 0;
+}
+
+template <typename key_type, typename value_type>
+std::size_t FlatHashMap<key_type, value_type>::size() const {
+  return count;
+}
+
+template <typename key_type, typename value_type>
+void FlatHashMap<key_type, value_type>::clear() {
+  count = 0;
+  slots.clear();
+  rehash(16);
+}
+
+} // namespace container
+} // namespace project_x
+
+#endif // PROJECT_X_CONTAINER_FLAT_HASH_MAP_HPP_
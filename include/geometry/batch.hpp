@@ -0,0 +1,50 @@
+#ifndef PROJECT_X_GEOMETRY_BATCH_HPP_
+#define PROJECT_X_GEOMETRY_BATCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace project_x {
+namespace geometry {
+
+// Batch versions of the projection and distance functions, on coordinates
+// stored as structure of arrays (fixed precision latitudes and longitudes in
+// separate arrays, as the base() of the coordinate types). Instead of std::sin,
+// std::log and friends, the kernels use branch free polynomial approximations
+// the compiler can vectorise. Results agree with the scalar functions:
+//   - projections differ by at most one unit of fixed precision
+//   - distances differ by less than 1e-6 meters + 1e-9 relative
+// Input and output arrays may alias.
+namespace batch {
+
+// projectWgsWebMerc, latitudes are clamped to
+// constants::epsg3857_max_latitude
+void projectWgsWebMerc(std::size_t const count, std::int32_t const *latitudes,
+                       std::int32_t const *longitudes,
+                       std::int32_t *merc_latitudes,
+                       std::int32_t *merc_longitudes);
+
+// projectWebMercWgs
+void projectWebMercWgs(std::size_t const count,
+                       std::int32_t const *merc_latitudes,
+                       std::int32_t const *merc_longitudes,
+                       std::int32_t *latitudes, std::int32_t *longitudes);
+
+// pairwise distances in meters between from[i] and to[i]
+void haversine_distance(std::size_t const count,
+                        std::int32_t const *from_latitudes,
+                        std::int32_t const *from_longitudes,
+                        std::int32_t const *to_latitudes,
+                        std::int32_t const *to_longitudes, double *distances);
+void equirectangular_distance(std::size_t const count,
+                              std::int32_t const *from_latitudes,
+                              std::int32_t const *from_longitudes,
+                              std::int32_t const *to_latitudes,
+                              std::int32_t const *to_longitudes,
+                              double *distances);
+
+} // namespace batch
+} // namespace geometry
+} // namespace project_x
+
+#endif // PROJECT_X_GEOMETRY_BATCH_HPP_
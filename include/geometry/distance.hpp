@@ -0,0 +1,23 @@
+#ifndef PROJECT_X_GEOMETRY_DISTANCE_HPP_
+#define PROJECT_X_GEOMETRY_DISTANCE_HPP_
+
+#include "geometry/coordinate.hpp"
+
+namespace project_x {
+namespace geometry {
+
+// great circle distance in meters between two coordinates, using the
+// haversine formula on a spherical earth
+double haversine_distance(WGS84FixedCoorinate const from,
+                          WGS84FixedCoorinate const to);
+
+// distance in meters in an equirectangular projection around the mean latitude
+// of both coordinates. Cheaper than haversine_distance and close to it for
+// short distances (below 0.1% for up to 100km outside the polar regions)
+double equirectangular_distance(WGS84FixedCoorinate const from,
+                                WGS84FixedCoorinate const to);
+
+} // namespace geometry
+} // namespace project_x
+
+#endif // PROJECT_X_GEOMETRY_DISTANCE_HPP_
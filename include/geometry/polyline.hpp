@@ -0,0 +1,57 @@
+#ifndef PROJECT_X_GEOMETRY_POLYLINE_HPP_
+#define PROJECT_X_GEOMETRY_POLYLINE_HPP_
+
+#include "geometry/coordinate.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace project_x {
+namespace geometry {
+
+// Encoded polyline format (https://developers.google.com/maps/documentation/
+// utilities/polylinealgorithm): the differences between consecutive latitudes
+// and longitudes in variable length chunks of five bits, as printable
+// characters. Polyline5 stores coordinates at a precision of 1e5, the same as
+// our fixed coordinates. Polyline6 stores them at 1e6, decoding it rounds to
+// the closest fixed coordinate.
+namespace polyline {
+
+enum class Precision { polyline5 = 5, polyline6 = 6 };
+
+// an upper bound of the encoded size of a number of coordinates, buffers passed
+// to encode need to be this large
+std::size_t max_encoded_size(std::size_t const count);
+
+// Encodes coordinates stored as structure of arrays (fixed precision latitudes
+// and longitudes, as the base() of the coordinate types). Returns the number of
+// characters written. The encoder works on blocks of coordinates, computing all
+// differences of a block first and writing every value as a full chunk pattern
+// of which only the used characters are kept. Both steps are free of
+// data-dependent branches.
+std::size_t encode(std::size_t const count, std::int32_t const *latitudes,
+                   std::int32_t const *longitudes, char *output,
+                   Precision const precision = Precision::polyline5);
+std::size_t encode(std::size_t const count,
+                   WGS84FixedCoorinate const *coordinates, char *output,
+                   Precision const precision = Precision::polyline5);
+std::string encode(std::vector<WGS84FixedCoorinate> const &coordinates,
+                   Precision const precision = Precision::polyline5);
+
+// Decodes a polyline into arrays with room for at least size / 2 coordinates.
+// Returns the number of decoded coordinates. Throws std::invalid_argument on
+// characters outside of the format and on truncated polylines.
+std::size_t decode(char const *input, std::size_t const size,
+                   std::int32_t *latitudes, std::int32_t *longitudes,
+                   Precision const precision = Precision::polyline5);
+std::vector<WGS84FixedCoorinate>
+decode(std::string const &polyline,
+       Precision const precision = Precision::polyline5);
+
+} // namespace polyline
+} // namespace geometry
+} // namespace project_x
+
+#endif // PROJECT_X_GEOMETRY_POLYLINE_HPP_
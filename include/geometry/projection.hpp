@@ -9,8 +9,8 @@ namespace geometry {
 // projection functions allow converting between coordinate formats
 WebMercatorFixedCoorinate projectWgsWebMerc(WGS84FixedCoorinate const);
 
-// TODO possibly implement back projection
-// WGS84FixedCoorinate projectWebMercWgs(WebMercatorFixedCoorinate const);
+// back projection, the inverse of projectWgsWebMerc up to the fixed precision
+WGS84FixedCoorinate projectWebMercWgs(WebMercatorFixedCoorinate const);
 
 } // namespace geometry
 } // namespace project_x
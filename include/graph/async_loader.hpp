@@ -0,0 +1,184 @@
+#ifndef PROJECT_X_GRAPH_ASYNC_LOADER_HPP_
+#define PROJECT_X_GRAPH_ASYNC_LOADER_HPP_
+
+#include "io/file.hpp"
+#include "io/section.hpp"
+#include "log/logger.hpp"
+#include "util/parallel.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace project_x {
+namespace graph {
+
+// Loads a (decorated) graph from a sectioned file in the background. Every
+// layer of the graph (the forward star and each decorator) is loaded as a task
+// of its own, the tasks run on a pool of threads in the order of their layers.
+// Callers can start serving queries as soon as the layers they require are
+// resident, e.g. topology and costs of a graph with large payloads:
+//
+//   AsyncLoader<AnnotatedGraph> loader("graph.sgr");
+//   auto const &routing_graph = loader.wait_for<CostGraph>();
+//
+// Layers are distinct members of the graph, so the upper layers can be loaded
+// while the lower ones are in use.
+template <typename graph_type> class AsyncLoader {
+public:
+  struct Progress {
+    std::size_t loaded_layers;
+    std::size_t total_layers;
+  };
+
+  // the mode can contain additional version checks, see io::SectionReader
+  AsyncLoader(boost::filesystem::path const &path,
+              std::size_t const threads = util::default_concurrency(),
+              io::mode::Enum const mode = 0);
+  // waits for all running tasks, errors are dropped
+  ~AsyncLoader();
+
+  AsyncLoader(AsyncLoader const &) = delete;
+  AsyncLoader &operator=(AsyncLoader const &) = delete;
+
+  Progress progress() const;
+
+  // Blocks until layer_type (one of the layers of graph_type) and all layers
+  // below it are loaded. Rethrows errors that occurred while loading these
+  // layers
+  template <typename layer_type> layer_type const &wait_for();
+
+  // blocks until the full graph is loaded
+  graph_type &wait();
+
+private:
+  template <typename layer_type> void add_tasks();
+  void run();
+  bool resident(std::size_t const number_of_layers) const;
+
+  io::SectionReader reader;
+  graph_type graph;
+  std::vector<std::function<void()>> tasks;
+  std::atomic<std::size_t> next_task;
+
+  mutable std::mutex mutex;
+  std::condition_variable layer_loaded;
+  std::vector<bool> loaded;
+  std::size_t loaded_layers;
+  // errors that occurred while loading a layer
+  std::vector<std::exception_ptr> errors;
+
+  std::vector<std::thread> workers;
+};
+
+template <typename graph_type>
+AsyncLoader<graph_type>::AsyncLoader(boost::filesystem::path const &path,
+                                     std::size_t const threads,
+                                     io::mode::Enum const mode)
+    : reader(path, mode), next_task(0), loaded_layers(0) {
+  // issue the reads of all sections at once, tasks hit the page cache
+  reader.prefetch();
+  add_tasks<graph_type>();
+  loaded.resize(tasks.size(), false);
+  errors.resize(tasks.size());
+
+  auto const number_of_workers =
+      std::min(std::max<std::size_t>(1, threads), tasks.size());
+  try {
+    for (std::size_t worker = 0; worker < number_of_workers; ++worker)
+      workers.emplace_back([this]() { run(); });
+  } catch (...) {
+    // the destructor does not run for a failed constructor: stop the workers
+    // that started, joinable threads must not be destroyed
+    next_task = tasks.size();
+    for (auto &worker : workers)
+      worker.join();
+    throw;
+  }
+}
+
+template <typename graph_type> AsyncLoader<graph_type>::~AsyncLoader() {
+  for (auto &worker : workers)
+    worker.join();
+}
+
+template <typename graph_type>
+template <typename layer_type>
+void AsyncLoader<graph_type>::add_tasks() {
+  static_assert(std::is_base_of<layer_type, graph_type>::value,
+                "Layers have to be part of the loaded graph.");
+  if constexpr (layer_type::decoration_layer > 0)
+    add_tasks<typename layer_type::base_type>();
+  // the qualified call only loads the sections of the layer itself
+  tasks.push_back([this]() { graph.layer_type::deserialise_layer(reader); });
+}
+
+template <typename graph_type> void AsyncLoader<graph_type>::run() {
+  for (auto task = next_task++; task < tasks.size(); task = next_task++) {
+    std::exception_ptr task_error;
+    try {
+      tasks[task]();
+    } catch (...) {
+      task_error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    errors[task] = task_error;
+    loaded[task] = true;
+    ++loaded_layers;
+    log::Logger logger;
+    logger.message(log::Level::DEBUG,
+                   "Loaded layer " + std::to_string(task) + " (" +
+                       std::to_string(loaded_layers) + "/" +
+                       std::to_string(tasks.size()) + ")");
+    layer_loaded.notify_all();
+  }
+}
+
+template <typename graph_type>
+bool AsyncLoader<graph_type>::resident(
+    std::size_t const number_of_layers) const {
+  return std::all_of(loaded.begin(), loaded.begin() + number_of_layers,
+                     [](bool const layer) { return layer; });
+}
+
+template <typename graph_type>
+typename AsyncLoader<graph_type>::Progress
+AsyncLoader<graph_type>::progress() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return {loaded_layers, tasks.size()};
+}
+
+template <typename graph_type>
+template <typename layer_type>
+layer_type const &AsyncLoader<graph_type>::wait_for() {
+  static_assert(std::is_base_of<layer_type, graph_type>::value,
+                "Layers have to be part of the loaded graph.");
+  auto const required_layers = layer_type::decoration_layer + 1;
+  std::unique_lock<std::mutex> lock(mutex);
+  layer_loaded.wait(lock, [&]() { return resident(required_layers); });
+  for (std::size_t layer = 0; layer < required_layers; ++layer)
+    if (errors[layer])
+      std::rethrow_exception(errors[layer]);
+  return static_cast<layer_type const &>(graph);
+}
+
+template <typename graph_type> graph_type &AsyncLoader<graph_type>::wait() {
+  wait_for<graph_type>();
+  return graph;
+}
+
+} // namespace graph
+} // namespace project_x
+
+#endif // PROJECT_X_GRAPH_ASYNC_LOADER_HPP_
@@ -1,11 +1,15 @@
 #ifndef PROJECT_X_GRAPH_DECORATOR_HPP_
 #define PROJECT_X_GRAPH_DECORATOR_HPP_
 
+#include "container/default_init_allocator.hpp"
+#include "container/dictionary.hpp"
 #include "graph/id.hpp"
 #include "io/file.hpp"
+#include "io/section.hpp"
 #include "io/serialisable.hpp"
 #include "io/wrappers.hpp"
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -21,6 +25,17 @@ namespace graph {
 class DecoratorFactory;
 
 namespace edge {
+
+namespace detail {
+// Sections of a decorator are named by its kind and layer (e.g. cost.1), so a
+// graph can be loaded from the sections of any graph it is a prefix of. A
+// CostDecorator<ForwardStar> can be read from the file of a ByteDecorator over
+// the same CostDecorator, without touching the byte strings.
+inline std::string section_name(std::string const &kind,
+                                std::size_t const layer) {
+  return kind + "." + std::to_string(layer);
+}
+} // namespace detail
 template <typename cost_type_t, class graph_type>
 class CostDecorator : public graph_type {
 public:
@@ -31,13 +46,22 @@ public:
   cost_type &cost(EdgeID const);
   cost_type const &cost(EdgeID const) const;
 
+  using base_type = graph_type;
+  static constexpr std::size_t decoration_layer =
+      graph_type::decoration_layer + 1;
+
   void serialise(io::File &) const;
   void deserialise(io::File &);
+  // the decoration is stored in its own sections, see io::SectionWriter
+  void serialise(io::SectionWriter &) const;
+  void deserialise(io::SectionReader const &);
+  // only the sections of this decorator, without the decorated graph
+  void deserialise_layer(io::SectionReader const &);
 
   friend DecoratorFactory;
 
 private:
-  std::vector<cost_type> decoration;
+  std::vector<cost_type, container::DefaultInitAllocator<cost_type>> decoration;
 };
 
 // The data decorator allows to store whatever kind of additional data we want
@@ -55,13 +79,22 @@ public:
   data_type &data(EdgeID const);
   data_type const &data(EdgeID const) const;
 
+  using base_type = graph_type;
+  static constexpr std::size_t decoration_layer =
+      graph_type::decoration_layer + 1;
+
   void serialise(io::File &) const;
   void deserialise(io::File &);
+  // the decoration is stored in its own sections, see io::SectionWriter
+  void serialise(io::SectionWriter &) const;
+  void deserialise(io::SectionReader const &);
+  // only the sections of this decorator, without the decorated graph
+  void deserialise_layer(io::SectionReader const &);
 
   friend DecoratorFactory;
 
 private:
-  std::vector<data_type> decoration;
+  std::vector<data_type, container::DefaultInitAllocator<data_type>> decoration;
 };
 
 // Byte decorators are used to store arbitrary data on edges that will be
@@ -79,8 +112,17 @@ public:
   byte_string &bytes(EdgeID const);
   byte_string const &bytes(EdgeID const) const;
 
+  using base_type = graph_type;
+  static constexpr std::size_t decoration_layer =
+      graph_type::decoration_layer + 1;
+
   void serialise(io::File &) const;
   void deserialise(io::File &);
+  // the decoration is stored in its own sections, see io::SectionWriter
+  void serialise(io::SectionWriter &) const;
+  void deserialise(io::SectionReader const &);
+  // only the sections of this decorator, without the decorated graph
+  void deserialise_layer(io::SectionReader const &);
 
   friend DecoratorFactory;
 
@@ -88,6 +130,42 @@ private:
   std::vector<wrapped_byte_string> decoration;
 };
 
+// Dictionary decorators store payloads that repeat over many edges (road
+// classes, names, ...) only once. Every edge refers to its payload by a 32-bit
+// ID into a dictionary that is shared between all edges.
+template <typename payload_type_t, class graph_type>
+class DictionaryDecorator : public graph_type {
+public:
+  using payload_type = payload_type_t;
+  using dictionary_type = container::Dictionary<payload_type>;
+  using id_type = typename dictionary_type::id_type;
+
+  template <class base_graph> DictionaryDecorator(base_graph &&graph);
+  DictionaryDecorator() = default;
+
+  payload_type const &payload(EdgeID const) const;
+  id_type payload_id(EdgeID const) const;
+  dictionary_type const &dictionary() const;
+
+  using base_type = graph_type;
+  static constexpr std::size_t decoration_layer =
+      graph_type::decoration_layer + 1;
+
+  void serialise(io::File &) const;
+  void deserialise(io::File &);
+  // the decoration is stored in its own sections, see io::SectionWriter
+  void serialise(io::SectionWriter &) const;
+  void deserialise(io::SectionReader const &);
+  // only the sections of this decorator, without the decorated graph
+  void deserialise_layer(io::SectionReader const &);
+
+  friend DecoratorFactory;
+
+private:
+  std::vector<id_type, container::DefaultInitAllocator<id_type>> decoration;
+  dictionary_type payloads;
+};
+
 //////////////////////////////////////////////////////////////////
 // Implementations
 //////////////////////////////////////////////////////////////////
@@ -120,6 +198,26 @@ void CostDecorator<cost_type_t, graph_type>::deserialise(io::File &file) {
   file.read_container(decoration);
 }
 
+template <typename cost_type_t, class graph_type>
+void CostDecorator<cost_type_t, graph_type>::serialise(
+    io::SectionWriter &writer) const {
+  graph_type::serialise(writer);
+  writer.write(detail::section_name("cost", decoration_layer), decoration);
+}
+
+template <typename cost_type_t, class graph_type>
+void CostDecorator<cost_type_t, graph_type>::deserialise(
+    io::SectionReader const &reader) {
+  graph_type::deserialise(reader);
+  deserialise_layer(reader);
+}
+
+template <typename cost_type_t, class graph_type>
+void CostDecorator<cost_type_t, graph_type>::deserialise_layer(
+    io::SectionReader const &reader) {
+  reader.read(detail::section_name("cost", decoration_layer), decoration);
+}
+
 //////////////////////////////////////////////////////////////////
 
 template <typename data_type_t, class graph_type>
@@ -150,6 +248,26 @@ void DataDecorator<data_type_t, graph_type>::deserialise(io::File &file) {
   file.read_container(decoration);
 }
 
+template <typename data_type_t, class graph_type>
+void DataDecorator<data_type_t, graph_type>::serialise(
+    io::SectionWriter &writer) const {
+  graph_type::serialise(writer);
+  writer.write(detail::section_name("data", decoration_layer), decoration);
+}
+
+template <typename data_type_t, class graph_type>
+void DataDecorator<data_type_t, graph_type>::deserialise(
+    io::SectionReader const &reader) {
+  graph_type::deserialise(reader);
+  deserialise_layer(reader);
+}
+
+template <typename data_type_t, class graph_type>
+void DataDecorator<data_type_t, graph_type>::deserialise_layer(
+    io::SectionReader const &reader) {
+  reader.read(detail::section_name("data", decoration_layer), decoration);
+}
+
 //////////////////////////////////////////////////////////////////
 
 template <class graph_type>
@@ -181,6 +299,96 @@ void ByteDecorator<graph_type>::deserialise(io::File &file) {
   file.read_container(decoration);
 }
 
+template <class graph_type>
+void ByteDecorator<graph_type>::serialise(io::SectionWriter &writer) const {
+  graph_type::serialise(writer);
+  writer.write(detail::section_name("bytes", decoration_layer), decoration);
+}
+
+template <class graph_type>
+void ByteDecorator<graph_type>::deserialise(io::SectionReader const &reader) {
+  graph_type::deserialise(reader);
+  deserialise_layer(reader);
+}
+
+template <class graph_type>
+void ByteDecorator<graph_type>::deserialise_layer(
+    io::SectionReader const &reader) {
+  reader.read(detail::section_name("bytes", decoration_layer), decoration);
+}
+
+//////////////////////////////////////////////////////////////////
+
+template <typename payload_type_t, class graph_type>
+template <class base_graph>
+DictionaryDecorator<payload_type_t, graph_type>::DictionaryDecorator(
+    base_graph &&graph)
+    : graph_type(std::move(graph)) {}
+
+template <typename payload_type_t, class graph_type>
+payload_type_t const &
+DictionaryDecorator<payload_type_t, graph_type>::payload(
+    EdgeID const eid) const {
+  return payloads[decoration[eid]];
+}
+
+template <typename payload_type_t, class graph_type>
+typename DictionaryDecorator<payload_type_t, graph_type>::id_type
+DictionaryDecorator<payload_type_t, graph_type>::payload_id(
+    EdgeID const eid) const {
+  return decoration[eid];
+}
+
+template <typename payload_type_t, class graph_type>
+typename DictionaryDecorator<payload_type_t,
+                             graph_type>::dictionary_type const &
+DictionaryDecorator<payload_type_t, graph_type>::dictionary() const {
+  return payloads;
+}
+
+template <typename payload_type_t, class graph_type>
+void DictionaryDecorator<payload_type_t, graph_type>::serialise(
+    io::File &file) const {
+  graph_type::serialise(file);
+  file.write_container(decoration);
+  payloads.serialise(file);
+}
+
+template <typename payload_type_t, class graph_type>
+void DictionaryDecorator<payload_type_t, graph_type>::deserialise(
+    io::File &file) {
+  graph_type::deserialise(file);
+  file.read_container(decoration);
+  payloads.deserialise(file);
+}
+
+template <typename payload_type_t, class graph_type>
+void DictionaryDecorator<payload_type_t, graph_type>::serialise(
+    io::SectionWriter &writer) const {
+  graph_type::serialise(writer);
+  writer.write(detail::section_name("payload_ids", decoration_layer),
+               decoration);
+  payloads.serialise(
+      writer.begin(detail::section_name("payloads", decoration_layer)));
+  writer.end();
+}
+
+template <typename payload_type_t, class graph_type>
+void DictionaryDecorator<payload_type_t, graph_type>::deserialise(
+    io::SectionReader const &reader) {
+  graph_type::deserialise(reader);
+  deserialise_layer(reader);
+}
+
+template <typename payload_type_t, class graph_type>
+void DictionaryDecorator<payload_type_t, graph_type>::deserialise_layer(
+    io::SectionReader const &reader) {
+  reader.read(detail::section_name("payload_ids", decoration_layer),
+              decoration);
+  reader.read_with(detail::section_name("payloads", decoration_layer),
+                   [this](io::File &file) { payloads.deserialise(file); });
+}
+
 } // namespace edge
 } // namespace graph
 } // namespace project_x
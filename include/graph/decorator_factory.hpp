@@ -3,25 +3,158 @@
 
 #include "decorator.hpp"
 #include "forward_star.hpp"
+#include "util/parallel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
 
 namespace project_x {
 namespace graph {
+
+// Fills the decorations of a graph from the edges it was created from. The
+// decoration of every layer is sized once and the edges are converted in
+// contiguous chunks on multiple threads, so converters have to be safe to call
+// concurrently.
 class DecoratorFactory {
 public:
+  // A decoration layer, pairing the decorated graph type with the converter
+  // providing its decoration. See layer() and decorate_layers()
+  template <typename decorated_graph_type, typename converter> struct Layer {
+    using decorated_graph = decorated_graph_type;
+    converter cvt;
+  };
+
+  DecoratorFactory(std::size_t const threads = util::default_concurrency());
+
   template <typename decorated_graph_type, typename edge_container,
             typename converter>
   void decorate(decorated_graph_type &graph, edge_container &edges,
                 converter cvt) const;
+
+  // decorate a graph with dictionary IDs, the converter has to provide the ID
+  // of an edges payload within the dictionary. The dictionary is moved into
+  // the graph
+  template <typename decorated_graph_type, typename edge_container,
+            typename converter>
+  void decorate(decorated_graph_type &graph, edge_container &edges,
+                converter cvt,
+                typename decorated_graph_type::dictionary_type &&dictionary)
+      const;
+
+  template <typename decorated_graph_type, typename converter>
+  static Layer<decorated_graph_type, converter> layer(converter cvt);
+
+  // Decorate multiple layers in a single pass over the edges, e.g.
+  //   factory.decorate_layers(graph, edges, factory.layer<CostGraph>(cost),
+  //                           factory.layer<DataCostGraph>(data));
+  template <typename graph_type, typename edge_container,
+            typename... layer_types>
+  void decorate_layers(graph_type &graph, edge_container &edges,
+                       layer_types... layers) const;
+
+  // move the dictionary the IDs of a DictionaryDecorator refer to into the
+  // graph
+  template <typename decorated_graph_type>
+  void attach_dictionary(
+      decorated_graph_type &graph,
+      typename decorated_graph_type::dictionary_type &&dictionary) const;
+
+  // move the profile table the IDs of a ProfileDecorator refer to into the
+  // graph
+  template <typename decorated_graph_type>
+  void attach_profiles(
+      decorated_graph_type &graph,
+      typename decorated_graph_type::profile_table_type &&profiles) const;
+
+private:
+  // chunks smaller than this are not worth the cost of a thread
+  static constexpr std::size_t minimum_chunk_size = 1 << 14;
+
+  template <typename decorated_graph_type, typename graph_type>
+  static auto &decoration_of(graph_type &graph);
+
+  // calls function(edge, index) for all edges, in parallel chunks
+  template <typename edge_container, typename function_type>
+  void for_each_edge(edge_container &edges, function_type function) const;
+
+  std::size_t threads;
 };
 
+inline DecoratorFactory::DecoratorFactory(std::size_t const threads)
+    : threads(std::max<std::size_t>(1, threads)) {}
+
+template <typename decorated_graph_type, typename graph_type>
+auto &DecoratorFactory::decoration_of(graph_type &graph) {
+  return static_cast<decorated_graph_type &>(graph).decoration;
+}
+
+template <typename edge_container, typename function_type>
+void DecoratorFactory::for_each_edge(edge_container &edges,
+                                     function_type function) const {
+  auto const size = static_cast<std::size_t>(std::size(edges));
+  auto const chunks = std::min(threads, size / minimum_chunk_size);
+  auto const first = std::begin(edges);
+  util::parallel_for(
+      size,
+      [&](std::size_t const begin, std::size_t const end, std::size_t) {
+        auto edge = std::next(first, begin);
+        for (auto index = begin; index < end; ++index, ++edge)
+          function(*edge, index);
+      },
+      chunks);
+}
+
 template <typename decorated_graph_type, typename edge_container,
           typename converter>
 void DecoratorFactory::decorate(decorated_graph_type &graph,
                                 edge_container &edges, converter cvt) const {
-  graph.decoration.reserve(edges.size());
-  for (auto const &edge : edges) {
-    graph.decoration.push_back(cvt(edge));
-  }
+  decorate_layers(graph, edges, layer<decorated_graph_type>(std::move(cvt)));
+}
+
+template <typename decorated_graph_type, typename edge_container,
+          typename converter>
+void DecoratorFactory::decorate(
+    decorated_graph_type &graph, edge_container &edges, converter cvt,
+    typename decorated_graph_type::dictionary_type &&dictionary) const {
+  decorate(graph, edges, cvt);
+  attach_dictionary(graph, std::move(dictionary));
+}
+
+template <typename decorated_graph_type, typename converter>
+DecoratorFactory::Layer<decorated_graph_type, converter>
+DecoratorFactory::layer(converter cvt) {
+  return {std::move(cvt)};
+}
+
+template <typename graph_type, typename edge_container,
+          typename... layer_types>
+void DecoratorFactory::decorate_layers(graph_type &graph,
+                                       edge_container &edges,
+                                       layer_types... layers) const {
+  auto const size = static_cast<std::size_t>(std::size(edges));
+  (decoration_of<typename layer_types::decorated_graph>(graph).resize(size),
+   ...);
+  for_each_edge(edges, [&](auto const &edge, std::size_t const index) {
+    ((decoration_of<typename layer_types::decorated_graph>(graph)[index] =
+          layers.cvt(edge)),
+     ...);
+  });
+}
+
+template <typename decorated_graph_type>
+void DecoratorFactory::attach_dictionary(
+    decorated_graph_type &graph,
+    typename decorated_graph_type::dictionary_type &&dictionary) const {
+  graph.payloads = std::move(dictionary);
+}
+
+template <typename decorated_graph_type>
+void DecoratorFactory::attach_profiles(
+    decorated_graph_type &graph,
+    typename decorated_graph_type::profile_table_type &&profiles) const {
+  graph.table = std::move(profiles);
 }
 
 } // namespace graph
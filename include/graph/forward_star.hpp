@@ -7,8 +7,10 @@
 #include <utility>
 #include <vector>
 
+#include "container/default_init_allocator.hpp"
 #include "graph/id.hpp"
 #include "io/file.hpp"
+#include "io/section.hpp"
 #include "io/serialisable.hpp"
 #include "iterator/pointer.hpp"
 
@@ -19,7 +21,10 @@ namespace graph {
 class ForwardStar : public io::Serialisable {
 public:
   // defines for nodes
-  using offset_storage = std::vector<std::uint64_t>;
+  // storage is not initialised on resize, it is always filled right away
+  using offset_storage =
+      std::vector<std::uint64_t,
+                  container::DefaultInitAllocator<std::uint64_t>>;
   using node_iterator = iterator::Pointer<std::uint64_t>;
   using offset_ptr = std::uint64_t *;
   using const_node_iterator = iterator::Pointer<std::uint64_t const>;
@@ -28,7 +33,8 @@ public:
 
   // defines for edges
   using value_type = NodeID;
-  using storage_type = std::vector<value_type>;
+  using storage_type =
+      std::vector<value_type, container::DefaultInitAllocator<value_type>>;
   using edge_iterator = storage_type::iterator;
   using const_edge_iterator = storage_type::const_iterator;
   using edge_range = boost::iterator_range<edge_iterator>;
@@ -92,9 +98,17 @@ public:
   EdgeID edge_id(const_edge_iterator const) const;
   EdgeID edge_id(edge_iterator const) const;
 
+  // decorators are numbered by their distance to the forward star, to name
+  // their sections in sectioned files
+  static constexpr std::size_t decoration_layer = 0;
+
   // storing / restoring
   void serialise(io::File &file) const;
   void deserialise(io::File &file);
+  void serialise(io::SectionWriter &writer) const;
+  void deserialise(io::SectionReader const &reader);
+  // the forward star is the bottom layer of all decorated graphs
+  void deserialise_layer(io::SectionReader const &reader);
 
 private:
   offset_storage node_offsets;
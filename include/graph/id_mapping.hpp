@@ -0,0 +1,40 @@
+#ifndef PROJECT_X_GRAPH_ID_MAPPING_HPP_
+#define PROJECT_X_GRAPH_ID_MAPPING_HPP_
+
+#include "graph/id.hpp"
+#include "io/file.hpp"
+#include "io/serialisable.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace graph {
+
+// Translates external IDs (e.g. OSM node IDs) into the NodeIDs of a graph. The
+// mapping is stored sorted by external ID, so lookups are binary searches over
+// a flat array.
+class IDMapping : public io::Serialisable {
+public:
+  IDMapping() = default;
+  // pairs of external ID and NodeID, in any order
+  IDMapping(std::vector<std::pair<std::uint64_t, NodeID>> mapping);
+
+  std::optional<NodeID> node_id(std::uint64_t const external_id) const;
+  std::size_t size() const;
+
+  // storing / restoring
+  void serialise(io::File &file) const;
+  void deserialise(io::File &file);
+
+private:
+  std::vector<std::uint64_t> external_ids;
+  std::vector<NodeID> node_ids;
+};
+
+} // namespace graph
+} // namespace project_x
+
+#endif // PROJECT_X_GRAPH_ID_MAPPING_HPP_
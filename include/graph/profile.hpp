@@ -0,0 +1,70 @@
+#ifndef PROJECT_X_GRAPH_PROFILE_HPP_
+#define PROJECT_X_GRAPH_PROFILE_HPP_
+
+#include "io/file.hpp"
+#include "io/serialisable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace project_x {
+namespace graph {
+
+using ProfileID = std::uint32_t;
+
+// Travel time profiles shared between all edges of a graph. A profile is a
+// periodic, piecewise-linear function over a day, sampled at a uniform
+// interval (e.g. 96 samples for every quarter of an hour). Samples are the
+// factor of the travel time over the static (free flow) travel time of an
+// edge, so edges of different length share the same profile. Factors are
+// stored in 16-bit fixed point, identical profiles are stored once.
+// Profiles should keep the FIFO property (leaving later never arrives
+// earlier), time-dependent searches are only exact on such profiles.
+class ProfileTable : public io::Serialisable {
+public:
+  // the length of a profile in seconds
+  static constexpr std::uint32_t period = 24 * 60 * 60;
+  // the stored value of a factor of 1.0
+  static constexpr std::uint32_t factor_scale = 1024;
+  // the profile of edges that always take their static travel time
+  static constexpr ProfileID free_flow = 0;
+
+  ProfileTable();
+
+  // factors sampled at a uniform interval over the period, the first sample at
+  // midnight. Factors need to be within (0, 64).
+  ProfileID add(std::vector<double> const &factors);
+  std::size_t size() const;
+
+  // the travel time of an edge departing at a time (in seconds, arbitrary days
+  // are wrapped into the period)
+  std::uint32_t travel_time(ProfileID const profile,
+                            std::uint32_t const static_time,
+                            std::uint32_t const departure) const;
+
+  // travel times of multiple edges departing at the same time, e.g. all edges
+  // leaving a node. Evaluated without branches, so the compiler can vectorise
+  // the loop. Results are identical to travel_time.
+  void travel_times(std::size_t const count, ProfileID const *profiles,
+                    std::uint32_t const *static_times,
+                    std::uint32_t const departure,
+                    std::uint32_t *result) const;
+
+  // storing / restoring
+  void serialise(io::File &file) const;
+  void deserialise(io::File &file);
+
+private:
+  // samples of profile i are samples[offsets[i], offsets[i + 1])
+  std::vector<std::uint32_t> offsets;
+  std::vector<std::uint16_t> samples;
+  // lookup for deduplication, restored on deserialisation
+  std::map<std::vector<std::uint16_t>, ProfileID> lookup;
+};
+
+} // namespace graph
+} // namespace project_x
+
+#endif // PROJECT_X_GRAPH_PROFILE_HPP_
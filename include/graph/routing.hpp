@@ -29,6 +29,8 @@ struct WeightTimeDistance {
   WeightTimeDistance operator+=(WeightTimeDistance const &other);
   WeightTimeDistance operator-(WeightTimeDistance const &other) const;
   WeightTimeDistance operator-=(WeightTimeDistance const &other);
+  // scales all members, rounding to the closest value (e.g. partial edges)
+  WeightTimeDistance operator*(double const factor) const;
 };
 
 // The routing graph
@@ -0,0 +1,155 @@
+#ifndef PROJECT_X_GRAPH_TIME_DEPENDENT_HPP_
+#define PROJECT_X_GRAPH_TIME_DEPENDENT_HPP_
+
+#include "container/default_init_allocator.hpp"
+#include "graph/decorator.hpp"
+#include "graph/id.hpp"
+#include "graph/profile.hpp"
+#include "graph/routing.hpp"
+#include "io/file.hpp"
+#include "io/section.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace project_x {
+namespace graph {
+
+// the static (free flow) travel time of an edge, scaled by its profile
+inline std::uint32_t static_travel_time(WeightTimeDistance const &cost) {
+  return cost.time;
+}
+
+template <typename cost_type>
+typename std::enable_if<std::is_arithmetic<cost_type>::value,
+                        std::uint32_t>::type
+static_travel_time(cost_type const cost) {
+  return static_cast<std::uint32_t>(cost);
+}
+
+namespace edge {
+
+// Profile decorators make the travel time of the edges of a cost decorated
+// graph depend on the time of day. Every edge refers to a shared profile by a
+// 32-bit ID, the profile scales the static travel time of the edge cost.
+template <class graph_type> class ProfileDecorator : public graph_type {
+public:
+  using profile_table_type = ProfileTable;
+
+  template <class base_graph> ProfileDecorator(base_graph &&graph);
+  ProfileDecorator() = default;
+
+  ProfileID &profile_id(EdgeID const);
+  ProfileID profile_id(EdgeID const) const;
+  profile_table_type const &profiles() const;
+
+  // the travel time of an edge when departing at a time (in seconds)
+  std::uint32_t travel_time(EdgeID const, std::uint32_t const departure) const;
+
+  using base_type = graph_type;
+  static constexpr std::size_t decoration_layer =
+      graph_type::decoration_layer + 1;
+
+  void serialise(io::File &) const;
+  void deserialise(io::File &);
+  // the decoration is stored in its own sections, see io::SectionWriter
+  void serialise(io::SectionWriter &) const;
+  void deserialise(io::SectionReader const &);
+  // only the sections of this decorator, without the decorated graph
+  void deserialise_layer(io::SectionReader const &);
+
+  friend DecoratorFactory;
+
+private:
+  std::vector<ProfileID, container::DefaultInitAllocator<ProfileID>>
+      decoration;
+  profile_table_type table;
+};
+
+} // namespace edge
+
+// The routing graph with travel times depending on the time of day
+using TimeDependentGraph = edge::ProfileDecorator<RoutingGraph>;
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+namespace edge {
+
+template <class graph_type>
+template <class base_graph>
+ProfileDecorator<graph_type>::ProfileDecorator(base_graph &&graph)
+    : graph_type(std::move(graph)) {}
+
+template <class graph_type>
+ProfileID &ProfileDecorator<graph_type>::profile_id(EdgeID const eid) {
+  return decoration[eid];
+}
+
+template <class graph_type>
+ProfileID ProfileDecorator<graph_type>::profile_id(EdgeID const eid) const {
+  return decoration[eid];
+}
+
+template <class graph_type>
+typename ProfileDecorator<graph_type>::profile_table_type const &
+ProfileDecorator<graph_type>::profiles() const {
+  return table;
+}
+
+template <class graph_type>
+std::uint32_t
+ProfileDecorator<graph_type>::travel_time(EdgeID const eid,
+                                          std::uint32_t const departure) const {
+  return table.travel_time(decoration[eid],
+                           static_travel_time(graph_type::cost(eid)),
+                           departure);
+}
+
+template <class graph_type>
+void ProfileDecorator<graph_type>::serialise(io::File &file) const {
+  graph_type::serialise(file);
+  file.write_container(decoration);
+  table.serialise(file);
+}
+
+template <class graph_type>
+void ProfileDecorator<graph_type>::deserialise(io::File &file) {
+  graph_type::deserialise(file);
+  file.read_container(decoration);
+  table.deserialise(file);
+}
+
+template <class graph_type>
+void ProfileDecorator<graph_type>::serialise(io::SectionWriter &writer) const {
+  graph_type::serialise(writer);
+  writer.write(detail::section_name("profile_ids", decoration_layer),
+               decoration);
+  table.serialise(
+      writer.begin(detail::section_name("profiles", decoration_layer)));
+  writer.end();
+}
+
+template <class graph_type>
+void ProfileDecorator<graph_type>::deserialise(
+    io::SectionReader const &reader) {
+  graph_type::deserialise(reader);
+  deserialise_layer(reader);
+}
+
+template <class graph_type>
+void ProfileDecorator<graph_type>::deserialise_layer(
+    io::SectionReader const &reader) {
+  reader.read(detail::section_name("profile_ids", decoration_layer),
+              decoration);
+  reader.read_with(detail::section_name("profiles", decoration_layer),
+                   [this](io::File &file) { table.deserialise(file); });
+}
+
+} // namespace edge
+} // namespace graph
+} // namespace project_x
+
+#endif // PROJECT_X_GRAPH_TIME_DEPENDENT_HPP_
@@ -0,0 +1,373 @@
+#ifndef PROJECT_X_GRAPH_TRAFFIC_OVERLAY_HPP_
+#define PROJECT_X_GRAPH_TRAFFIC_OVERLAY_HPP_
+
+#include "graph/id.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace project_x {
+namespace graph {
+
+namespace detail {
+// Open addressing hash map from EdgeIDs to costs with linear probing, for a
+// single writer and any number of concurrent readers. Every slot is guarded by
+// a sequence lock: the writer makes the version odd while it changes a slot,
+// readers retry if the version was odd or changed during their copy. Erased
+// slots stay tombstones until the map is reset, so probe sequences are never
+// cut short while readers walk them.
+template <typename cost_type> class OverrideTable {
+public:
+  static_assert(std::is_trivially_copyable<cost_type>::value,
+                "Overridden costs are copied word by word.");
+
+  // the table holds up to `capacity` keys (including erased ones), at least
+  // one
+  explicit OverrideTable(std::size_t const capacity);
+
+  // readers, safe to call concurrently with the writer
+  bool find(EdgeID const eid, cost_type &cost) const;
+
+  // writer only. Returns false if the table is full.
+  bool store(EdgeID const eid, cost_type const &cost);
+  // visits all entries as visitor(EdgeID, cost_type const &) and erases them
+  // afterwards, one by one
+  template <typename visitor_type> void drain(visitor_type visitor);
+  std::size_t size() const { return live; }
+
+private:
+  static constexpr EdgeID empty_key = std::numeric_limits<EdgeID>::max();
+  static constexpr EdgeID erased_key = empty_key - 1;
+  static constexpr std::size_t words =
+      (sizeof(cost_type) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+  struct Slot {
+    std::atomic<std::uint32_t> version;
+    std::atomic<EdgeID> key;
+    std::atomic<std::uint64_t> value[words];
+  };
+
+  std::size_t home(EdgeID const eid) const;
+  // consistent copy of the key (and the cost, if requested) of a slot
+  EdgeID read(Slot const &slot, cost_type *cost) const;
+  void write(Slot &slot, EdgeID const key, cost_type const *cost);
+
+  std::unique_ptr<Slot[]> slots;
+  std::size_t mask;
+  std::size_t capacity;
+  // entries, and slots that are not empty (entries and tombstones)
+  std::size_t live;
+  std::size_t used;
+};
+} // namespace detail
+
+// A sparse overlay of live traffic updates on top of the costs of a cost
+// decorated graph. A feed updates the costs of a few edges at a time, queries
+// see the updated costs through cost(EdgeID) without copying the full cost
+// vector. Edges without an update cost a single test of a bit in a bitmap (one
+// bit per edge, so it stays in cache far better than the costs). Updated costs
+// are kept in a small lock-free hash map and can be folded back into the costs
+// of the graph, e.g. once per minute, while queries continue.
+//
+// Updates and folds have to be issued from a single thread, the writer. Any
+// number of threads can query the overlay concurrently. An update folds the
+// overlay when its hash map is full, so every query that may run alongside
+// update() or fold() has to hold a Reader for its duration:
+//
+//   auto const reading = overlay.reader();
+//   auto const route = dijkstra(from, to);
+//
+// Folding waits until all queries that started before it are done, updating
+// never blocks unless the hash map is full, which forces a fold.
+template <class graph_type> class TrafficOverlay : public graph_type {
+public:
+  using cost_type = typename graph_type::cost_type;
+  static constexpr std::size_t default_capacity = 1 << 14;
+
+  // Registers a query with the overlay. Folds do not touch the costs of the
+  // graph while a reader that started before them is alive.
+  class Reader {
+  public:
+    Reader(Reader &&other);
+    Reader(Reader const &) = delete;
+    Reader &operator=(Reader const &) = delete;
+    ~Reader();
+
+  private:
+    friend TrafficOverlay;
+    explicit Reader(std::atomic<std::size_t> *active) : active(active) {}
+    std::atomic<std::size_t> *active;
+  };
+
+  // Up to capacity updated edges are kept in the overlay before they are
+  // folded. Throws std::invalid_argument for a capacity of zero.
+  template <class base_graph>
+  TrafficOverlay(base_graph &&graph,
+                 std::size_t const capacity = default_capacity);
+
+  // the cost of an edge, including the latest update
+  cost_type cost(EdgeID const eid) const;
+  bool overridden(EdgeID const eid) const;
+  Reader reader() const;
+
+  // writer only
+  void update(EdgeID const eid, cost_type const &cost);
+  // writes all updates into the costs of the graph and clears the overlay
+  void fold();
+  // the number of edges with an update that was not folded yet
+  std::size_t overrides() const { return table->size(); }
+
+private:
+  static constexpr std::size_t bits_per_word = 64;
+
+  // the active readers of the last two epochs. Readers register with the
+  // current epoch, folds start a new epoch and wait for the readers of the
+  // previous one.
+  struct Epochs {
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<std::size_t> active[2] = {{0}, {0}};
+  };
+
+  std::unique_ptr<std::atomic<std::uint64_t>[]> flags;
+  std::unique_ptr<detail::OverrideTable<cost_type>> table;
+  std::unique_ptr<Epochs> epochs;
+};
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+template <typename cost_type>
+OverrideTable<cost_type>::OverrideTable(std::size_t const capacity)
+    : capacity(capacity), live(0), used(0) {
+  if (capacity == 0)
+    throw std::invalid_argument(
+        "Traffic overlays need a capacity of at least one edge.");
+  // keep the load factor at or below one half
+  std::size_t size = 16;
+  while (size < 2 * capacity)
+    size *= 2;
+  slots.reset(new Slot[size]);
+  mask = size - 1;
+  for (std::size_t index = 0; index < size; ++index) {
+    slots[index].version.store(0, std::memory_order_relaxed);
+    slots[index].key.store(empty_key, std::memory_order_relaxed);
+    for (auto &word : slots[index].value)
+      word.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename cost_type>
+std::size_t OverrideTable<cost_type>::home(EdgeID const eid) const {
+  // fibonacci hashing spreads consecutive IDs over the table
+  return static_cast<std::size_t>((eid * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+template <typename cost_type>
+EdgeID OverrideTable<cost_type>::read(Slot const &slot,
+                                      cost_type *cost) const {
+  std::uint64_t buffer[words];
+  while (true) {
+    auto const version = slot.version.load(std::memory_order_acquire);
+    if (version & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    auto const key = slot.key.load(std::memory_order_relaxed);
+    if (cost)
+      for (std::size_t word = 0; word < words; ++word)
+        buffer[word] = slot.value[word].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != version)
+      continue;
+    if (cost)
+      std::memcpy(cost, buffer, sizeof(cost_type));
+    return key;
+  }
+}
+
+template <typename cost_type>
+void OverrideTable<cost_type>::write(Slot &slot, EdgeID const key,
+                                     cost_type const *cost) {
+  auto const version = slot.version.load(std::memory_order_relaxed);
+  slot.version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.key.store(key, std::memory_order_relaxed);
+  if (cost) {
+    std::uint64_t buffer[words] = {};
+    std::memcpy(buffer, cost, sizeof(cost_type));
+    for (std::size_t word = 0; word < words; ++word)
+      slot.value[word].store(buffer[word], std::memory_order_relaxed);
+  }
+  slot.version.store(version + 2, std::memory_order_release);
+}
+
+template <typename cost_type>
+bool OverrideTable<cost_type>::find(EdgeID const eid, cost_type &cost) const {
+  for (auto index = home(eid);; index = (index + 1) & mask) {
+    // only matching keys require the cost
+    auto const key = slots[index].key.load(std::memory_order_acquire);
+    if (key == empty_key)
+      return false;
+    if (key == eid && read(slots[index], &cost) == eid)
+      return true;
+  }
+}
+
+template <typename cost_type>
+bool OverrideTable<cost_type>::store(EdgeID const eid, cost_type const &cost) {
+  auto free = mask + 1;
+  for (auto index = home(eid);; index = (index + 1) & mask) {
+    auto const key = slots[index].key.load(std::memory_order_relaxed);
+    if (key == eid) {
+      write(slots[index], eid, &cost);
+      return true;
+    }
+    if (key == erased_key && free > mask)
+      free = index;
+    if (key == empty_key) {
+      if (free > mask) {
+        if (used == capacity)
+          return false;
+        free = index;
+        ++used;
+      }
+      write(slots[free], eid, &cost);
+      ++live;
+      return true;
+    }
+  }
+}
+
+template <typename cost_type>
+template <typename visitor_type>
+void OverrideTable<cost_type>::drain(visitor_type visitor) {
+  cost_type cost;
+  for (std::size_t index = 0; index <= mask && live > 0; ++index) {
+    auto const key = read(slots[index], &cost);
+    if (key == empty_key || key == erased_key)
+      continue;
+    visitor(key, cost);
+    write(slots[index], erased_key, nullptr);
+    --live;
+  }
+  // Without any entries, no reader can find a key behind a tombstone anymore.
+  // Clearing them keeps the probe sequences short.
+  for (std::size_t index = 0; index <= mask && used > 0; ++index)
+    if (slots[index].key.load(std::memory_order_relaxed) == erased_key) {
+      write(slots[index], empty_key, nullptr);
+      --used;
+    }
+}
+
+} // namespace detail
+
+template <class graph_type>
+TrafficOverlay<graph_type>::Reader::Reader(Reader &&other)
+    : active(other.active) {
+  other.active = nullptr;
+}
+
+template <class graph_type> TrafficOverlay<graph_type>::Reader::~Reader() {
+  if (active)
+    active->fetch_sub(1, std::memory_order_release);
+}
+
+template <class graph_type>
+template <class base_graph>
+TrafficOverlay<graph_type>::TrafficOverlay(base_graph &&graph,
+                                           std::size_t const capacity)
+    : graph_type(std::move(graph)),
+      table(std::make_unique<detail::OverrideTable<cost_type>>(capacity)),
+      epochs(std::make_unique<Epochs>()) {
+  auto const words =
+      (graph_type::number_of_edges() + bits_per_word - 1) / bits_per_word;
+  flags.reset(new std::atomic<std::uint64_t>[words]);
+  for (std::size_t word = 0; word < words; ++word)
+    flags[word].store(0, std::memory_order_relaxed);
+}
+
+template <class graph_type>
+bool TrafficOverlay<graph_type>::overridden(EdgeID const eid) const {
+  return (flags[eid / bits_per_word].load(std::memory_order_acquire) >>
+          (eid % bits_per_word)) &
+         1;
+}
+
+template <class graph_type>
+typename TrafficOverlay<graph_type>::cost_type
+TrafficOverlay<graph_type>::cost(EdgeID const eid) const {
+  if (!overridden(eid))
+    return graph_type::cost(eid);
+  cost_type cost;
+  // a fold may have erased the update, after writing it into the graph
+  if (table->find(eid, cost))
+    return cost;
+  return graph_type::cost(eid);
+}
+
+template <class graph_type>
+typename TrafficOverlay<graph_type>::Reader
+TrafficOverlay<graph_type>::reader() const {
+  while (true) {
+    auto const epoch = epochs->epoch.load(std::memory_order_seq_cst);
+    auto &active = epochs->active[epoch & 1];
+    active.fetch_add(1, std::memory_order_seq_cst);
+    // a fold started in between, it might not wait for this reader
+    if (epochs->epoch.load(std::memory_order_seq_cst) == epoch)
+      return Reader(&active);
+    active.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+template <class graph_type>
+void TrafficOverlay<graph_type>::update(EdgeID const eid,
+                                        cost_type const &cost) {
+  if (eid >= graph_type::number_of_edges())
+    throw std::out_of_range("Traffic update for unknown edge " +
+                            std::to_string(eid) + ".");
+  if (!table->store(eid, cost)) {
+    fold();
+    table->store(eid, cost);
+  }
+  flags[eid / bits_per_word].fetch_or(std::uint64_t(1) << (eid % bits_per_word),
+                                      std::memory_order_release);
+}
+
+template <class graph_type> void TrafficOverlay<graph_type>::fold() {
+  if (table->size() == 0)
+    return;
+
+  // Readers that started before the latest updates were flagged might still
+  // read the costs of the graph for updated edges. Readers of the new epoch see
+  // the flags and look up the updates instead, so the costs can be written
+  // once the previous epoch is over.
+  auto const previous = epochs->epoch.fetch_add(1, std::memory_order_seq_cst);
+  auto const &active = epochs->active[previous & 1];
+  while (active.load(std::memory_order_acquire) != 0)
+    std::this_thread::yield();
+
+  // Readers that find the flag cleared or the update erased read the costs of
+  // the graph, which hold the update by then.
+  table->drain([this](EdgeID const eid, cost_type const &cost) {
+    graph_type::cost(eid) = cost;
+    flags[eid / bits_per_word].fetch_and(
+        ~(std::uint64_t(1) << (eid % bits_per_word)),
+        std::memory_order_release);
+  });
+}
+
+} // namespace graph
+} // namespace project_x
+
+#endif // PROJECT_X_GRAPH_TRAFFIC_OVERLAY_HPP_
@@ -0,0 +1,48 @@
+#ifndef PROJECT_X_IMPORTER_IMPORTER_HPP_
+#define PROJECT_X_IMPORTER_IMPORTER_HPP_
+
+#include "builder/graph.hpp"
+#include "container/dictionary.hpp"
+#include "graph/routing.hpp"
+#include "importer/profile.hpp"
+#include "util/parallel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+
+namespace project_x {
+namespace importer {
+
+// the same edge layout the python importer uses: weight, time and distance (in
+// tenth of seconds/meters) and the road class as payload
+using ImportEdge = builder::Edge<graph::WeightTimeDistance::weight_type,
+                                 graph::WeightTimeDistance::time_type,
+                                 graph::WeightTimeDistance::distance_type,
+                                 container::DictionaryID>;
+using ImportGraph = builder::Graph<ImportEdge>;
+
+struct ImportOptions {
+  std::size_t threads = util::default_concurrency();
+  // number of ways that are turned into edges per parallel batch
+  std::size_t batch_size = 1 << 16;
+};
+
+struct ImportStatistics {
+  std::uint64_t nodes = 0;
+  std::uint64_t ways = 0;
+  std::uint64_t edges = 0;
+};
+
+// Reads an OSM XML extract and adds all ways usable by the profile to the
+// builder. Segment lengths are computed from the node coordinates, ways are
+// converted into edges in parallel batches. The coordinates of all nodes are
+// added to the builder as well.
+ImportStatistics import_osm(std::istream &input, ImportGraph &builder,
+                            CarProfile const &profile,
+                            ImportOptions const &options = ImportOptions());
+
+} // namespace importer
+} // namespace project_x
+
+#endif // PROJECT_X_IMPORTER_IMPORTER_HPP_
@@ -0,0 +1,65 @@
+#ifndef PROJECT_X_IMPORTER_OSM_XML_HPP_
+#define PROJECT_X_IMPORTER_OSM_XML_HPP_
+
+#include "geometry/coordinate.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace project_x {
+namespace importer {
+
+using Tags = std::vector<std::pair<std::string, std::string>>;
+
+struct OSMNode {
+  std::uint64_t id;
+  geometry::WGS84FixedCoorinate coordinate;
+};
+
+struct OSMWay {
+  std::uint64_t id;
+  std::vector<std::uint64_t> nodes;
+  Tags tags;
+};
+
+// look up the value of a tag, returns nullptr if the tag is not present
+std::string const *find_tag(Tags const &tags, std::string const &key);
+
+// Streaming parser for OSM XML files. Only nodes (with their coordinates) and
+// ways (with node references and tags) are reported, relations and all other
+// elements are skipped. The parser does not validate the XML structure and
+// expects '>' within attribute values to be escaped, as all OSM tools do.
+class OSMXMLParser {
+public:
+  using node_handler = std::function<void(OSMNode const &)>;
+  using way_handler = std::function<void(OSMWay const &)>;
+
+  OSMXMLParser(std::istream &input);
+
+  // parse the full input, calling the handlers for every node/way
+  void parse(node_handler on_node, way_handler on_way);
+
+private:
+  struct Element {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    bool closing;
+    bool self_closing;
+  };
+
+  // read the next element (the content of the next <...>). Returns false at
+  // the end of the input
+  bool next_element(Element &element);
+
+  std::istream &input;
+  std::string buffer;
+};
+
+} // namespace importer
+} // namespace project_x
+
+#endif // PROJECT_X_IMPORTER_OSM_XML_HPP_
@@ -0,0 +1,45 @@
+#ifndef PROJECT_X_IMPORTER_PROFILE_HPP_
+#define PROJECT_X_IMPORTER_PROFILE_HPP_
+
+#include "importer/osm_xml.hpp"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace project_x {
+namespace importer {
+
+// the result of evaluating a way within a profile
+struct WaySettings {
+  // travel speed in km/h
+  double speed;
+  // the way can be travelled in/against the direction of its nodes
+  bool forward;
+  bool backward;
+  // the class of the road, stored as payload of the edges
+  std::string road_class;
+};
+
+// A car profile that decides usage / non usage of OSM ways. Uses the speeds of
+// the python profile in scripts/python/profiles/car.py, but evaluates more
+// tags than it does:
+// - access=no/private excludes a way
+// - maxspeed caps the speed of the road class, in km/h, mph or knots
+// - oneway (including implied oneways of roundabouts and motorways) restricts
+//   the directions of a way, the python importer only adds forward edges
+class CarProfile {
+public:
+  CarProfile();
+
+  // returns no settings if the way cannot be used by cars
+  std::optional<WaySettings> evaluate(Tags const &tags) const;
+
+private:
+  std::unordered_map<std::string, double> highway_speeds;
+};
+
+} // namespace importer
+} // namespace project_x
+
+#endif // PROJECT_X_IMPORTER_PROFILE_HPP_
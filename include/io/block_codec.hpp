@@ -0,0 +1,209 @@
+#ifndef PROJECT_X_IO_BLOCK_CODEC_HPP_
+#define PROJECT_X_IO_BLOCK_CODEC_HPP_
+
+#include "io/exceptions.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace project_x {
+namespace io {
+
+// Compression of integer sequences in independent blocks. Every block is
+// stored with the smaller of two encodings:
+//  - frame of reference: the minimum of the block and the differences of all
+//    values to it, bit packed with the width of the largest difference
+//  - delta: the first value and the differences between consecutive values,
+//    relative to the smallest difference and bit packed. Sorted sequences like
+//    node offsets compress to a few bits per value this way.
+// Blocks can be decoded independently, which allows multithreaded decoding.
+template <typename integer_type> class BlockCodec {
+public:
+  static_assert(std::is_integral<integer_type>::value &&
+                    !std::is_same<integer_type, bool>::value,
+                "Block codecs require integral types.");
+
+  // number of values per block, only the last block can be smaller
+  static constexpr std::size_t block_size = 1024;
+  // every block starts with a header of this size
+  static constexpr std::size_t header_size = 2 + 2 * sizeof(std::uint64_t);
+
+  // Appends the encoded block of count (<= block_size) values to the output
+  static void encode_block(integer_type const *values, std::size_t const count,
+                           std::vector<char> &output);
+
+  // the size of an encoded block of count values in bytes, determined from its
+  // header
+  static std::size_t encoded_size(char const *header, std::size_t const count);
+
+  // Decodes a block of count values, the input has to contain the full block
+  // as written by encode_block
+  static void decode_block(char const *input, std::size_t const input_size,
+                           std::size_t const count, integer_type *values);
+
+private:
+  using word_type = std::uint64_t;
+  enum Mode : std::uint8_t { FRAME_OF_REFERENCE = 0, DELTA = 1 };
+
+  struct Header {
+    std::uint8_t mode;
+    std::uint8_t bits;
+    // minimum (frame of reference) or first value (delta)
+    std::uint64_t base;
+    // smallest difference of consecutive values (delta only)
+    std::uint64_t minimum_delta;
+  };
+
+  static std::uint8_t bit_width(std::uint64_t const value);
+  static std::size_t packed_words(std::size_t const count,
+                                  std::uint8_t const bits);
+};
+
+template <typename integer_type>
+std::uint8_t BlockCodec<integer_type>::bit_width(std::uint64_t const value) {
+  return value == 0 ? 0 : 64 - __builtin_clzll(value);
+}
+
+template <typename integer_type>
+std::size_t
+BlockCodec<integer_type>::packed_words(std::size_t const count,
+                                       std::uint8_t const bits) {
+  return (count * bits + 63) / 64;
+}
+
+template <typename integer_type>
+void BlockCodec<integer_type>::encode_block(integer_type const *values,
+                                            std::size_t const count,
+                                            std::vector<char> &output) {
+  if (count == 0 || count > block_size)
+    throw std::invalid_argument("Invalid block size.");
+
+  // all arithmetic is modulo 2^64, so signed values survive the round trip
+  auto const value = [values](std::size_t const index) {
+    return static_cast<std::uint64_t>(values[index]);
+  };
+
+  std::uint64_t minimum = value(0), maximum = value(0);
+  std::uint64_t minimum_delta = ~std::uint64_t(0), maximum_delta = 0;
+  for (std::size_t i = 1; i < count; ++i) {
+    minimum = std::min(minimum, value(i));
+    maximum = std::max(maximum, value(i));
+    auto const delta = value(i) - value(i - 1);
+    minimum_delta = std::min(minimum_delta, delta);
+    maximum_delta = std::max(maximum_delta, delta);
+  }
+  if (count == 1)
+    minimum_delta = 0;
+
+  auto const reference_bits = bit_width(maximum - minimum);
+  auto const delta_bits = bit_width(maximum_delta - minimum_delta);
+
+  Header header;
+  if (delta_bits < reference_bits)
+    header = {DELTA, delta_bits, value(0), minimum_delta};
+  else
+    header = {FRAME_OF_REFERENCE, reference_bits, minimum, 0};
+
+  // the first delta is always zero, keeping the layout uniform
+  auto const packed_value = [&](std::size_t const index) -> std::uint64_t {
+    if (header.mode == FRAME_OF_REFERENCE)
+      return value(index) - header.base;
+    return index == 0 ? 0 : value(index) - value(index - 1) - minimum_delta;
+  };
+
+  std::vector<word_type> words(packed_words(count, header.bits), 0);
+  if (header.bits > 0) {
+    for (std::size_t i = 0; i < count; ++i) {
+      auto const position = i * header.bits;
+      auto const word = position / 64, shift = position % 64;
+      auto const packed = packed_value(i);
+      words[word] |= packed << shift;
+      if (shift + header.bits > 64)
+        words[word + 1] |= packed >> (64 - shift);
+    }
+  }
+
+  auto const offset = output.size();
+  output.resize(offset + header_size + words.size() * sizeof(word_type));
+  auto *out = output.data() + offset;
+  out[0] = static_cast<char>(header.mode);
+  out[1] = static_cast<char>(header.bits);
+  std::memcpy(out + 2, &header.base, sizeof(header.base));
+  std::memcpy(out + 2 + sizeof(header.base), &header.minimum_delta,
+              sizeof(header.minimum_delta));
+  if (!words.empty())
+    std::memcpy(out + header_size, words.data(),
+                words.size() * sizeof(word_type));
+}
+
+template <typename integer_type>
+std::size_t BlockCodec<integer_type>::encoded_size(char const *header,
+                                                   std::size_t const count) {
+  auto const mode = static_cast<std::uint8_t>(header[0]);
+  auto const bits = static_cast<std::uint8_t>(header[1]);
+  if (mode > DELTA || bits > 64 || count > block_size)
+    throw InvalidFormat("Corrupted block.");
+  return header_size + packed_words(count, bits) * sizeof(word_type);
+}
+
+template <typename integer_type>
+void BlockCodec<integer_type>::decode_block(char const *input,
+                                            std::size_t const input_size,
+                                            std::size_t const count,
+                                            integer_type *values) {
+  if (input_size < header_size)
+    throw InvalidFormat("Truncated block.");
+
+  Header header;
+  header.mode = static_cast<std::uint8_t>(input[0]);
+  header.bits = static_cast<std::uint8_t>(input[1]);
+  std::memcpy(&header.base, input + 2, sizeof(header.base));
+  std::memcpy(&header.minimum_delta, input + 2 + sizeof(header.base),
+              sizeof(header.minimum_delta));
+
+  auto const number_of_words = packed_words(count, header.bits);
+  if (header.mode > DELTA || header.bits > 64 ||
+      input_size != header_size + number_of_words * sizeof(word_type))
+    throw InvalidFormat("Corrupted block.");
+
+  // the words are copied to guarantee their alignment
+  word_type words[block_size];
+  if (number_of_words > 0)
+    std::memcpy(words, input + header_size,
+                number_of_words * sizeof(word_type));
+
+  auto const mask = header.bits == 64 ? ~std::uint64_t(0)
+                                      : (std::uint64_t(1) << header.bits) - 1;
+  auto const unpack = [&](std::size_t const index) -> std::uint64_t {
+    if (header.bits == 0)
+      return 0;
+    auto const position = index * header.bits;
+    auto const word = position / 64, shift = position % 64;
+    auto packed = words[word] >> shift;
+    if (shift + header.bits > 64)
+      packed |= words[word + 1] << (64 - shift);
+    return packed & mask;
+  };
+
+  if (header.mode == FRAME_OF_REFERENCE) {
+    for (std::size_t i = 0; i < count; ++i)
+      values[i] = static_cast<integer_type>(header.base + unpack(i));
+  } else {
+    auto current = header.base;
+    values[0] = static_cast<integer_type>(current);
+    for (std::size_t i = 1; i < count; ++i) {
+      current += unpack(i) + header.minimum_delta;
+      values[i] = static_cast<integer_type>(current);
+    }
+  }
+}
+
+} // namespace io
+} // namespace project_x
+
+#endif // PROJECT_X_IO_BLOCK_CODEC_HPP_
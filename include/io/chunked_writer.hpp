@@ -0,0 +1,183 @@
+#ifndef PROJECT_X_IO_CHUNKED_WRITER_HPP_
+#define PROJECT_X_IO_CHUNKED_WRITER_HPP_
+
+#include "io/file.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace project_x {
+namespace io {
+
+// Writes a POD container to a file value by value, without the container ever
+// being held in memory. A placeholder for the size is written up front and
+// patched when the writer is finished. The result is read like any container
+// written via File::write_container, including files in mode::mCOMPRESSED:
+//
+//   ChunkedWriter<NodeID> targets(file);
+//   for (auto const &edge : edges)
+//     targets.push_back(edge.target);
+//   targets.finish();
+//
+// Patching the size invalidates running checksums, so the file must not be
+// checksumming while the writer is active. Files in mode::mAPPEND cannot be
+// patched either.
+template <typename value_type> class ChunkedWriter {
+public:
+  static_assert(std::is_pod<value_type>::value,
+                "Chunked writers only support POD types.");
+
+  explicit ChunkedWriter(File &file);
+  // A container of a known number of values. Its size is written up front and
+  // never patched, so the file may be checksumming (e.g. within a section) or
+  // appending. finish() throws std::logic_error if the count does not match.
+  ChunkedWriter(File &file, std::uint64_t const expected_size);
+  // finishes the container, if finish was not called before
+  ~ChunkedWriter();
+
+  ChunkedWriter(ChunkedWriter const &) = delete;
+  ChunkedWriter &operator=(ChunkedWriter const &) = delete;
+
+  void push_back(value_type const &value);
+  void append(value_type const *values, std::size_t const number_of_values);
+
+  // the number of values written so far
+  std::uint64_t size() const;
+
+  // writes all buffered values and patches the size, no values can be added
+  // afterwards
+  void finish();
+
+private:
+  // values are buffered and written in chunks of this size. Compressed
+  // containers are encoded in full blocks, so it is a multiple of the block
+  // size
+  static constexpr std::size_t chunk_size = 1 << 16;
+
+  void flush();
+
+  File &file;
+  bool compress;
+  std::uint64_t size_position;
+  std::uint64_t count;
+  std::vector<value_type> buffer;
+  bool finished;
+  // the size written up front, if known
+  bool sized;
+  std::uint64_t expected_size;
+};
+
+template <typename value_type>
+ChunkedWriter<value_type>::ChunkedWriter(File &file)
+    : file(file), compress(false), size_position(0), count(0),
+      finished(false), sized(false), expected_size(0) {
+  if (file.checksumming_enabled())
+    throw std::logic_error(
+        "Chunked writers cannot be used while checksumming.");
+  // appending files write at their end, wherever the size was sought to
+  if (file.appending())
+    throw std::logic_error(
+        "Chunked writers cannot be used on files in mode::mAPPEND.");
+  if constexpr (detail::is_block_packable<value_type>)
+    compress = file.compressed();
+  size_position = file.tell();
+  file.write_pod(count);
+  buffer.reserve(chunk_size);
+}
+
+template <typename value_type>
+ChunkedWriter<value_type>::ChunkedWriter(File &file,
+                                         std::uint64_t const expected_size)
+    : file(file), compress(false), size_position(0), count(0),
+      finished(false), sized(true), expected_size(expected_size) {
+  if constexpr (detail::is_block_packable<value_type>)
+    compress = file.compressed();
+  file.write_pod(expected_size);
+  buffer.reserve(std::min<std::uint64_t>(chunk_size, expected_size));
+}
+
+template <typename value_type> ChunkedWriter<value_type>::~ChunkedWriter() {
+  // destructors must not throw, a failing write results in a truncated file
+  try {
+    if (!finished)
+      finish();
+  } catch (...) {
+  }
+}
+
+template <typename value_type>
+void ChunkedWriter<value_type>::push_back(value_type const &value) {
+  buffer.push_back(value);
+  if (buffer.size() == chunk_size)
+    flush();
+}
+
+template <typename value_type>
+void ChunkedWriter<value_type>::append(value_type const *values,
+                                       std::size_t const number_of_values) {
+  for (std::size_t offset = 0; offset < number_of_values;) {
+    auto const chunk = std::min<std::size_t>(number_of_values - offset,
+                                             chunk_size - buffer.size());
+    buffer.insert(buffer.end(), values + offset, values + offset + chunk);
+    offset += chunk;
+    if (buffer.size() == chunk_size)
+      flush();
+  }
+}
+
+template <typename value_type>
+std::uint64_t ChunkedWriter<value_type>::size() const {
+  return count + buffer.size();
+}
+
+template <typename value_type> void ChunkedWriter<value_type>::flush() {
+  auto const write_raw = [this]() {
+    file.write_bytes(reinterpret_cast<char const *>(buffer.data()),
+                     buffer.size() * sizeof(value_type));
+  };
+  if constexpr (detail::is_block_packable<value_type>) {
+    if (compress)
+      file.write_blocks(buffer.data(), buffer.size());
+    else
+      write_raw();
+  } else {
+    write_raw();
+  }
+  count += buffer.size();
+  buffer.clear();
+}
+
+template <typename value_type> void ChunkedWriter<value_type>::finish() {
+  if (finished)
+    return;
+  if (sized) {
+    finished = true;
+    flush();
+    if (count != expected_size)
+      throw std::logic_error("Chunked writer expected " +
+                             std::to_string(expected_size) +
+                             " values, but got " + std::to_string(count) +
+                             ".");
+    return;
+  }
+  if (file.checksumming_enabled())
+    throw std::logic_error(
+        "Chunked writers cannot be used while checksumming.");
+  finished = true;
+  flush();
+
+  auto const end = file.tell();
+  file.seek(size_position);
+  file.write_pod(count);
+  file.seek(end);
+}
+
+} // namespace io
+} // namespace project_x
+
+#endif // PROJECT_X_IO_CHUNKED_WRITER_HPP_
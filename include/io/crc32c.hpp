@@ -0,0 +1,28 @@
+#ifndef PROJECT_X_IO_CRC32C_HPP_
+#define PROJECT_X_IO_CRC32C_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace project_x {
+namespace io {
+
+// CRC32C (Castagnoli) checksum of a block of data. Checksums of consecutive
+// blocks can be chained by passing the checksum of the previous block:
+//   crc32c(b, m, crc32c(a, n)) == crc32c(ab, n + m)
+// Uses the SSE4.2 (x86, detected at runtime) or ARMv8 CRC instructions when
+// available, and a table based implementation otherwise.
+std::uint32_t crc32c(void const *data, std::size_t const size,
+                     std::uint32_t const crc = 0);
+
+// the portable implementation, independent of the supported instructions
+std::uint32_t crc32c_portable(void const *data, std::size_t const size,
+                              std::uint32_t const crc = 0);
+
+// true if crc32c uses hardware instructions
+bool crc32c_hardware_accelerated();
+
+} // namespace io
+} // namespace project_x
+
+#endif // PROJECT_X_IO_CRC32C_HPP_
@@ -11,6 +11,16 @@ struct VersionMismatch : public std::invalid_argument {
   using std::invalid_argument::invalid_argument;
 };
 
+// InvalidFormat indicates that a file does not have the expected structure
+struct InvalidFormat : public std::invalid_argument {
+  using std::invalid_argument::invalid_argument;
+};
+
+// ChecksumMismatch indicates corrupted (e.g. truncated or bit-flipped) data
+struct ChecksumMismatch : public InvalidFormat {
+  using InvalidFormat::InvalidFormat;
+};
+
 } // namespace io
 } // namespace project_x
 
@@ -2,12 +2,19 @@
 #define PROJECT_X_IO_FILE_HPP_
 
 #include <boost/filesystem/path.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
+#include "container/default_init_allocator.hpp"
+#include "io/block_codec.hpp"
+#include "io/exceptions.hpp"
 #include "io/serialisable.hpp"
+#include "util/parallel.hpp"
 
 namespace project_x {
 namespace io {
@@ -29,6 +36,14 @@ static constexpr Enum mVERSIONED_MINOR = 1 << 6;
 static constexpr Enum mVERSIONED_MAJOR = 1 << 7;
 // simply warn on mismatch
 static constexpr Enum mVERSIONED_WARNING = 1 << 8;
+// read/write containers of integers block packed, see write_container.
+// Versioned files record the mode, readers switch to it. Unversioned files have
+// to be read in the mode they were written in
+static constexpr Enum mCOMPRESSED = 1 << 9;
+// Versioned files end in a CRC32C of everything after their header, verified
+// when a reader consumes the last byte. Files with their own checksums (e.g.
+// sectioned files) can opt out
+static constexpr Enum mNO_CHECKSUM = 1 << 10;
 } // mode
 
 // Managing access to a file, including basic checks for versions/checksums and
@@ -36,6 +51,11 @@ static constexpr Enum mVERSIONED_WARNING = 1 << 8;
 class File {
 public:
   File(boost::filesystem::path path, mode::Enum mode);
+  // closes the file, see close()
+  ~File();
+
+  File(File &&) = default;
+  File &operator=(File &&) = default;
 
   // POD types can be read/written directly
   template <typename pod_type> void write_pod(pod_type const &);
@@ -50,53 +70,134 @@ public:
   template <class container_type>
   void read_serialisable_container(container_type &);
 
+  // Containers of integers, compressed in independent blocks (see BlockCodec).
+  // Blocks are encoded/decoded on multiple threads, see set_threads
+  template <class container_type>
+  void write_compressed_container(container_type const &);
+  template <class container_type>
+  void read_compressed_container(container_type &);
+  // the blocks of a compressed container, without its size
+  template <typename value_type>
+  void write_blocks(value_type const *values, std::uint64_t const count);
+
   // write different types of containers (POD/Serialisable) and switch between
   // the appropriate types. Mostly provided for convenience, if you don't know
-  // for sure what kind of data your container holds
+  // for sure what kind of data your container holds. In mode::mCOMPRESSED,
+  // containers of integers are compressed.
   template <class container_type> void write_container(container_type const &);
   template <class container_type> void read_container(container_type &);
 
+  // position within the file in bytes, including the version header
+  std::uint64_t tell();
+  void seek(std::uint64_t const position);
+  // the size of the file in bytes
+  std::uint64_t size();
+
+  // Checksums (CRC32C) all bytes read or written between starting and
+  // stopping, stop_checksum returns the checksum
+  void start_checksum();
+  std::uint32_t stop_checksum();
+  bool checksumming_enabled() const;
+
+  // raw access, all other reads/writes pass through these as well
+  void write_bytes(char const *data, std::size_t const size);
+  void read_bytes(char *data, std::size_t const size);
+
+  // the number of threads used to encode/decode compressed containers
+  void set_threads(std::size_t const threads);
+  bool compressed() const;
+  // whether writes are appended to the end of the file (mode::mAPPEND)
+  bool appending() const;
+
+  // Writes the trailing checksum of versioned files. Throws ChecksumMismatch
+  // if a reader reached the end of the data of a corrupted file.
   void close();
 
 protected:
-  // use data stored in version.h to check validity of file
+  // containers are read in chunks of this size, see read_pod_container
+  static constexpr std::uint64_t read_chunk_bytes = 1 << 20;
+
+  // use data stored in version.h to check validity of file, the version is
+  // followed by the flags of the file format (e.g. compression)
   void write_version();
   void read_and_check_version(mode::Enum mode);
+  // the checksum of the data after the header, compared to the trailer once
+  // the last byte has been read
+  void verify_data();
 
   boost::filesystem::path path;
   std::fstream stream;
+  bool writing;
+  bool append;
+
+  bool checksumming;
+  std::uint32_t checksum;
+
+  // Trailing checksum of versioned files. Seeking breaks the running checksum
+  // of the data, writers recompute it from the file, readers skip verification.
+  bool data_checksummed;
+  bool data_checksum_running;
+  std::uint32_t data_checksum;
+  // the data of the file, the position of readers within it
+  std::uint64_t data_begin;
+  std::uint64_t data_end;
+  std::uint64_t data_position;
+
+  bool compress_integers;
+  std::size_t threads;
 };
 
+namespace detail {
+// containers of single bytes are stored raw, they mostly hold text
+template <typename value_type>
+constexpr bool is_block_packable =
+    std::is_integral<value_type>::value &&
+    !std::is_same<value_type, bool>::value && sizeof(value_type) > 1;
+} // namespace detail
+
 template <typename pod_type> void File::write_pod(pod_type const &data) {
   static_assert(std::is_pod<pod_type>::value,
                 "Supplied type to writePOD is not a POD type");
-  stream.write(reinterpret_cast<const char *>(&data), sizeof(data));
+  write_bytes(reinterpret_cast<const char *>(&data), sizeof(data));
 }
 
 template <typename pod_type> void File::read_pod(pod_type &data) {
   static_assert(std::is_pod<pod_type>::value,
                 "Supplied type to readPOD is not a POD type");
-  stream.read(reinterpret_cast<char *>(&data), sizeof(data));
+  read_bytes(reinterpret_cast<char *>(&data), sizeof(data));
 }
 
 template <typename container_type>
 void File::write_pod_container(container_type const &container) {
   std::uint64_t size = container.size();
   write_pod(size);
-  stream.write(reinterpret_cast<const char *>(container.data()),
-               sizeof(typename container_type::value_type) * size);
+  write_bytes(reinterpret_cast<const char *>(container.data()),
+              sizeof(typename container_type::value_type) * size);
 }
 
 template <typename container_type>
 void File::read_pod_container(container_type &container) {
-  std::uint_fast64_t size = 0;
+  using value_type = typename container_type::value_type;
+  std::uint64_t size = 0;
   read_pod(size);
-  container.resize(size);
-  // TODO this should be possible with container.data(), but results in const
-  // ptr, which cannot be filled.
-  auto ptr = &container[0];
-  stream.read(reinterpret_cast<char *>(ptr),
-              sizeof(typename container_type::value_type) * size);
+
+  // The container grows chunk by chunk, each chunk being read right after it
+  // has been added. Value-initialising containers zero a chunk while it is
+  // still in cache, instead of writing all memory twice. Containers using a
+  // container::DefaultInitAllocator are not initialised at all. Chunks exceed
+  // the stream buffer, so they are read without an intermediate copy.
+  auto const chunk_size =
+      std::max<std::uint64_t>(1, read_chunk_bytes / sizeof(value_type));
+  container.clear();
+  container.reserve(size);
+  for (std::uint64_t offset = 0; offset < size; offset += chunk_size) {
+    auto const chunk = std::min(chunk_size, size - offset);
+    container.resize(offset + chunk);
+    // TODO this should be possible with container.data(), but results in
+    // const ptr, which cannot be filled.
+    read_bytes(reinterpret_cast<char *>(&container[offset]),
+               sizeof(value_type) * chunk);
+  }
 }
 
 template <typename container_type>
@@ -116,6 +217,91 @@ void File::read_serialisable_container(container_type &container) {
     entity.deserialise(*this);
 }
 
+// Layout: number of values, followed by the encoded blocks. Blocks delimit
+// themselves, so containers can be written without an index (see
+// ChunkedWriter).
+template <typename container_type>
+void File::write_compressed_container(container_type const &container) {
+  std::uint64_t const size = container.size();
+  write_pod(size);
+  write_blocks(size ? &container[0] : nullptr, size);
+}
+
+template <typename value_type>
+void File::write_blocks(value_type const *values, std::uint64_t const count) {
+  using codec = BlockCodec<value_type>;
+  auto const blocks = (count + codec::block_size - 1) / codec::block_size;
+
+  // every chunk of blocks is encoded into a buffer of its own
+  auto const chunks =
+      std::max<std::size_t>(1, std::min<std::size_t>(threads, blocks));
+  std::vector<std::vector<char>> encoded(chunks);
+  util::parallel_for(
+      blocks,
+      [&](std::size_t const begin, std::size_t const end,
+          std::size_t const chunk) {
+        for (auto block = begin; block < end; ++block) {
+          auto const first = block * codec::block_size;
+          codec::encode_block(
+              values + first,
+              std::min<std::uint64_t>(codec::block_size, count - first),
+              encoded[chunk]);
+        }
+      },
+      chunks);
+
+  for (auto const &chunk : encoded)
+    write_bytes(chunk.data(), chunk.size());
+}
+
+template <typename container_type>
+void File::read_compressed_container(container_type &container) {
+  using value_type = typename container_type::value_type;
+  using codec = BlockCodec<value_type>;
+  std::uint64_t size = 0;
+  read_pod(size);
+  auto const blocks = (size + codec::block_size - 1) / codec::block_size;
+
+  // the blocks are read sequentially, remembering where each of them starts
+  std::vector<std::uint64_t> block_starts(blocks + 1, 0);
+  std::vector<char, container::DefaultInitAllocator<char>> payload;
+  for (std::uint64_t block = 0; block < blocks; ++block) {
+    auto const start = payload.size();
+    payload.resize(start + codec::header_size);
+    read_bytes(&payload[start], codec::header_size);
+    if (!stream)
+      break;
+    auto const first = block * codec::block_size;
+    auto const encoded_size = codec::encoded_size(
+        &payload[start],
+        std::min<std::uint64_t>(codec::block_size, size - first));
+    payload.resize(start + encoded_size);
+    read_bytes(&payload[start + codec::header_size],
+               encoded_size - codec::header_size);
+    block_starts[block + 1] = payload.size();
+  }
+  if (!stream)
+    throw InvalidFormat{"Truncated compressed container in: " +
+                        path.string()};
+
+  // blocks are decoded in contiguous chunks, one per thread
+  container.clear();
+  container.resize(size);
+  util::parallel_for(
+      blocks,
+      [&](std::size_t const begin, std::size_t const end, std::size_t) {
+        for (auto block = begin; block < end; ++block) {
+          auto const first = block * codec::block_size;
+          codec::decode_block(
+              payload.data() + block_starts[block],
+              block_starts[block + 1] - block_starts[block],
+              std::min<std::uint64_t>(codec::block_size, size - first),
+              &container[first]);
+        }
+      },
+      threads);
+}
+
 namespace detail {
 // Dispatch between POD / non POD files statically based on templates
 template <typename container_type>
@@ -157,11 +343,21 @@ dispatch_read(File &file, container_type &container) {
 // dispatch between POD / serialisable types
 template <typename container_type>
 void File::write_container(container_type const &container) {
+  if constexpr (detail::is_block_packable<
+                    typename container_type::value_type>) {
+    if (compress_integers)
+      return write_compressed_container(container);
+  }
   detail::dispatch_write(*this, container);
 }
 
 template <typename container_type>
 void File::read_container(container_type &container) {
+  if constexpr (detail::is_block_packable<
+                    typename container_type::value_type>) {
+    if (compress_integers)
+      return read_compressed_container(container);
+  }
   detail::dispatch_read(*this, container);
 }
 } // namespace io
@@ -0,0 +1,152 @@
+#ifndef PROJECT_X_IO_SECTION_HPP_
+#define PROJECT_X_IO_SECTION_HPP_
+
+#include "io/file.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace project_x {
+namespace io {
+
+// Sectioned files store data in named sections. Every section starts at an
+// aligned offset and is listed in a table of contents (TOC) at the end of the
+// file:
+//
+//   [version header][section 0][padding][section 1][padding]...[TOC][footer]
+//
+// The footer holds the offset and checksum of the TOC and a magic number.
+// Readers only parse the TOC when opening a file, so sections can be loaded
+// selectively, in any order and from multiple threads. Every section carries
+// a CRC32C checksum, computed while it is written.
+//
+// Sections record the encoding of their content. Readers of BLOCK_PACKED
+// sections decode containers of integers transparently, see mode::mCOMPRESSED
+enum class Encoding : std::uint32_t { RAW = 0, BLOCK_PACKED = 1 };
+
+struct SectionEntry {
+  std::string name;
+  // offset in bytes from the start of the file
+  std::uint64_t offset;
+  std::uint64_t size;
+  std::uint32_t checksum;
+  Encoding encoding;
+};
+
+class SectionWriter {
+public:
+  // with Encoding::BLOCK_PACKED, containers of integers are compressed in
+  // all sections written afterwards
+  SectionWriter(boost::filesystem::path path,
+                std::uint64_t const alignment = 64,
+                Encoding const encoding = Encoding::RAW);
+  // writes the TOC, if finish was not called before
+  ~SectionWriter();
+
+  SectionWriter(SectionWriter const &) = delete;
+  SectionWriter &operator=(SectionWriter const &) = delete;
+
+  // write a container (POD or Serialisable) into its own section
+  template <class container_type>
+  void write(std::string const &name, container_type const &container);
+
+  // Sections of arbitrary content: everything written to the returned file
+  // until end() is called belongs to the section
+  File &begin(std::string const &name);
+  void end();
+
+  // write the TOC and footer, no sections can be added afterwards
+  void finish();
+
+private:
+  File file;
+  std::uint64_t alignment;
+  Encoding encoding;
+  std::vector<SectionEntry> sections;
+  bool in_section;
+  bool finished;
+};
+
+class SectionReader {
+public:
+  // Reads the TOC, the mode can contain additional version checks (e.g.
+  // mode::mVERSIONED_MAJOR). With verification enabled, sections read via
+  // read/read_with are checked against their checksums while streaming.
+  SectionReader(boost::filesystem::path path, mode::Enum const mode = 0,
+                bool const verify_checksums = true);
+
+  bool contains(std::string const &name) const;
+  // throws std::out_of_range for unknown sections
+  SectionEntry const &section(std::string const &name) const;
+  std::vector<SectionEntry> const &sections() const;
+
+  // Opens a file positioned at the start of the section. Every call uses its
+  // own file handle, so different threads can read sections concurrently.
+  // The file reads in the encoding of the section.
+  File open(std::string const &name) const;
+
+  // the number of threads a single read uses to decode compressed sections
+  void set_threads(std::size_t const threads);
+
+  // Asks the operating system to read all sections ahead, so that later reads
+  // are served from the page cache. Returns immediately, no-op on systems
+  // without posix_fadvise
+  void prefetch() const;
+
+  template <class container_type>
+  void read(std::string const &name, container_type &container) const;
+
+  // calls read_function(file) to read a section of arbitrary content. The
+  // function has to consume the full section
+  template <typename function_type>
+  void read_with(std::string const &name, function_type read_function) const;
+
+  // Compare the content of sections against their checksums. verify_all checks
+  // the sections in parallel and throws ChecksumMismatch on corrupted data
+  bool verify(std::string const &name) const;
+  void verify_all(std::size_t const threads) const;
+
+private:
+  // throws ChecksumMismatch if the bytes read do not match the section
+  void check(SectionEntry const &entry, std::uint64_t const bytes_read,
+             std::uint32_t const checksum) const;
+
+  boost::filesystem::path path;
+  std::vector<SectionEntry> entries;
+  bool verify_checksums;
+  std::size_t threads;
+};
+
+template <class container_type>
+void SectionWriter::write(std::string const &name,
+                          container_type const &container) {
+  begin(name).write_container(container);
+  end();
+}
+
+template <class container_type>
+void SectionReader::read(std::string const &name,
+                         container_type &container) const {
+  read_with(name, [&container](File &file) { file.read_container(container); });
+}
+
+template <typename function_type>
+void SectionReader::read_with(std::string const &name,
+                              function_type read_function) const {
+  auto const &entry = section(name);
+  auto file = open(name);
+  if (verify_checksums)
+    file.start_checksum();
+  read_function(file);
+  if (verify_checksums)
+    check(entry, file.tell() - entry.offset, file.stop_checksum());
+}
+
+} // namespace io
+} // namespace project_x
+
+#endif // PROJECT_X_IO_SECTION_HPP_
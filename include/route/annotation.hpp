@@ -0,0 +1,283 @@
+#ifndef PROJECT_X_ROUTE_ANNOTATION_HPP_
+#define PROJECT_X_ROUTE_ANNOTATION_HPP_
+
+#include "graph/id.hpp"
+#include "route/route.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Annotations describe a route by the payloads of its edges (names, road
+// classes, geometry, ...). Consecutive segments with the same payload form a
+// run, so a street name is reported once for all the segments along it. Runs
+// are streamed into a preallocated buffer in a binary or JSON format, without
+// allocating per segment:
+//
+//   char memory[64 * 1024];
+//   route::OutputBuffer buffer(memory, sizeof(memory));
+//   route::JsonAnnotationWriter writer(buffer);
+//   route::annotate(route, [&](EdgeID eid) -> auto const & {
+//     return graph.payload(eid);
+//   }, writer);
+//
+// Payload functions returning references (as the decorators do) let the
+// annotation prefetch the payloads of upcoming segments, and payloads shared
+// via a dictionary compare by their address.
+namespace project_x {
+namespace route {
+
+// A block of memory owned by the caller. Writes beyond its capacity are
+// dropped, marking the buffer as overflowed.
+class OutputBuffer {
+public:
+  OutputBuffer(char *data, std::size_t const capacity)
+      : begin(data), capacity(capacity), used(0), overflow(false) {}
+
+  bool append(char const *bytes, std::size_t const size) {
+    if (overflow || size > capacity - used) {
+      overflow = true;
+      return false;
+    }
+    std::memcpy(begin + used, bytes, size);
+    used += size;
+    return true;
+  }
+  bool append(std::string_view const text) {
+    return append(text.data(), text.size());
+  }
+  bool append(char const character) { return append(&character, 1); }
+
+  char const *data() const { return begin; }
+  std::size_t size() const { return used; }
+  std::string_view view() const { return {begin, used}; }
+  bool overflowed() const { return overflow; }
+  void clear() {
+    used = 0;
+    overflow = false;
+  }
+
+private:
+  char *begin;
+  std::size_t capacity;
+  std::size_t used;
+  bool overflow;
+};
+
+// consecutive segments of a route sharing a payload
+struct AnnotationRun {
+  std::size_t first_segment;
+  std::size_t segments;
+};
+
+// Binary encoding of payloads: arithmetic and other trivially copyable types
+// verbatim, strings with their length in front. Other payloads can be supported
+// by an overload of encode_binary in their namespace.
+template <typename payload_type>
+typename std::enable_if<std::is_trivially_copyable<payload_type>::value>::type
+encode_binary(OutputBuffer &buffer, payload_type const &payload) {
+  buffer.append(reinterpret_cast<char const *>(&payload), sizeof(payload));
+}
+
+inline void write_varint(OutputBuffer &buffer, std::uint64_t value) {
+  char bytes[10];
+  std::size_t size = 0;
+  while (value >= 0x80) {
+    bytes[size++] = static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  bytes[size++] = static_cast<char>(value);
+  buffer.append(bytes, size);
+}
+
+inline void encode_binary(OutputBuffer &buffer, std::string_view const text) {
+  write_varint(buffer, text.size());
+  buffer.append(text);
+}
+
+inline void encode_binary(OutputBuffer &buffer, std::string const &text) {
+  encode_binary(buffer, std::string_view(text));
+}
+
+// JSON encoding of payloads: numbers, booleans and strings. Other payloads can
+// be supported by an overload of encode_json in their namespace.
+template <typename payload_type>
+typename std::enable_if<std::is_arithmetic<payload_type>::value>::type
+encode_json(OutputBuffer &buffer, payload_type const payload) {
+  char text[32];
+  auto const result = std::to_chars(text, text + sizeof(text), payload);
+  buffer.append(text, result.ptr - text);
+}
+
+inline void encode_json(OutputBuffer &buffer, bool const payload) {
+  buffer.append(payload ? std::string_view("true") : std::string_view("false"));
+}
+
+inline void encode_json(OutputBuffer &buffer, std::string_view const text) {
+  buffer.append('"');
+  // characters before clean are written already
+  std::size_t clean = 0;
+  for (std::size_t index = 0; index < text.size(); ++index) {
+    auto const character = static_cast<unsigned char>(text[index]);
+    if (character >= 0x20 && character != '"' && character != '\\')
+      continue;
+    buffer.append(text.substr(clean, index - clean));
+    clean = index + 1;
+    if (character == '"' || character == '\\') {
+      char const escaped[] = {'\\', static_cast<char>(character)};
+      buffer.append(escaped, 2);
+    } else {
+      char const hex[] = "0123456789abcdef";
+      char const escaped[] = {'\\', 'u', '0', '0', hex[character >> 4],
+                              hex[character & 0xF]};
+      buffer.append(escaped, sizeof(escaped));
+    }
+  }
+  buffer.append(text.substr(clean));
+  buffer.append('"');
+}
+
+inline void encode_json(OutputBuffer &buffer, std::string const &text) {
+  encode_json(buffer, std::string_view(text));
+}
+
+// Writes runs as the varint number of their segments, followed by the binary
+// encoding of their payload. The first run starts at the first segment.
+class BinaryAnnotationWriter {
+public:
+  explicit BinaryAnnotationWriter(OutputBuffer &buffer) : buffer(buffer) {}
+
+  void begin() {}
+  template <typename payload_type>
+  void run(AnnotationRun const &run, payload_type const &payload) {
+    write_varint(buffer, run.segments);
+    encode_binary(buffer, payload);
+  }
+  void end() {}
+
+private:
+  OutputBuffer &buffer;
+};
+
+// Writes runs as a JSON array: [{"segments":3,"value":"Main Street"},...]
+class JsonAnnotationWriter {
+public:
+  explicit JsonAnnotationWriter(OutputBuffer &buffer) : buffer(buffer) {}
+
+  void begin() {
+    buffer.append('[');
+    first = true;
+  }
+  template <typename payload_type>
+  void run(AnnotationRun const &run, payload_type const &payload) {
+    buffer.append(first ? std::string_view("{\"segments\":")
+                        : std::string_view(",{\"segments\":"));
+    first = false;
+    encode_json(buffer, run.segments);
+    buffer.append(",\"value\":");
+    encode_json(buffer, payload);
+    buffer.append('}');
+  }
+  void end() { buffer.append(']'); }
+
+private:
+  OutputBuffer &buffer;
+  bool first = true;
+};
+
+// Annotates a route with the payloads of its edges, payload(EdgeID) returning
+// the payload of an edge. Consecutive equal payloads (by ==) are merged into a
+// single run, the writer receives begin(), run(AnnotationRun, payload) for
+// every run and end(). Returns the number of runs.
+template <typename weight_type, typename payload_function,
+          typename writer_type>
+std::size_t annotate(Route<weight_type> const &route, payload_function payload,
+                     writer_type &writer);
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+namespace detail {
+// The payload of the current run. References are kept as pointers, so
+// payloads are neither copied nor compared if they share their address.
+template <typename result_type, typename = void> class RunPayload {
+public:
+  explicit RunPayload(result_type value) : value(std::move(value)) {}
+  bool matches(result_type const &other) const { return value == other; }
+  void reset(result_type other) { value = std::move(other); }
+  result_type const &get() const { return value; }
+
+private:
+  result_type value;
+};
+
+template <typename result_type>
+class RunPayload<result_type, typename std::enable_if<std::is_reference<
+                                  result_type>::value>::type> {
+public:
+  using value_type = typename std::remove_reference<result_type>::type;
+  explicit RunPayload(value_type &value) : value(&value) {}
+  bool matches(value_type &other) const {
+    return value == &other || *value == other;
+  }
+  void reset(value_type &other) { value = &other; }
+  value_type &get() const { return *value; }
+
+private:
+  value_type *value;
+};
+} // namespace detail
+
+template <typename weight_type, typename payload_function,
+          typename writer_type>
+std::size_t annotate(Route<weight_type> const &route, payload_function payload,
+                     writer_type &writer) {
+  using result_type = decltype(payload(EdgeID()));
+  // distance (in segments) of prefetches ahead of the current segment
+  std::size_t const prefetch_distance = 8;
+  auto const &segments = route.segments;
+  auto const prefetch = [&](std::size_t const index) {
+    if constexpr (std::is_reference<result_type>::value) {
+      if (index < segments.size())
+        __builtin_prefetch(&payload(segments[index].edge_id));
+    }
+  };
+
+  writer.begin();
+  if (segments.empty()) {
+    writer.end();
+    return 0;
+  }
+  for (std::size_t index = 0; index < prefetch_distance; ++index)
+    prefetch(index);
+
+  std::size_t runs = 0;
+  AnnotationRun run{0, 1};
+  detail::RunPayload<result_type> current(payload(segments.front().edge_id));
+  for (std::size_t index = 1; index < segments.size(); ++index) {
+    prefetch(index + prefetch_distance);
+    result_type next = payload(segments[index].edge_id);
+    if (current.matches(next)) {
+      ++run.segments;
+      continue;
+    }
+    writer.run(run, current.get());
+    ++runs;
+    run = {index, 1};
+    current.reset(std::forward<result_type>(next));
+  }
+  writer.run(run, current.get());
+  writer.end();
+  return runs + 1;
+}
+
+} // namespace route
+} // namespace project_x
+
+#endif // PROJECT_X_ROUTE_ANNOTATION_HPP_
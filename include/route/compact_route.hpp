@@ -0,0 +1,193 @@
+#ifndef PROJECT_X_ROUTE_COMPACT_ROUTE_HPP_
+#define PROJECT_X_ROUTE_COMPACT_ROUTE_HPP_
+
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+#include "route/route.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace project_x {
+namespace route {
+
+namespace detail {
+inline std::uint64_t zigzag(std::int64_t const value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^
+         static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t const value) {
+  return static_cast<std::int64_t>(value >> 1) ^
+         -static_cast<std::int64_t>(value & 1);
+}
+
+// LEB128: seven bits per byte, the high bit marks further bytes
+inline void write_varint(std::uint64_t value, std::vector<std::uint8_t> &out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline std::uint64_t read_varint(std::uint8_t const *&in) {
+  std::uint64_t value = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    auto const byte = *in++;
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+}
+
+// Encodes the weight of a segment relative to the weight of its predecessor.
+// Integral weights are stored as zig-zag encoded differences, all other
+// weights verbatim.
+template <typename weight_type, typename = void> struct WeightCodec {
+  static_assert(std::is_trivially_copyable<weight_type>::value,
+                "Weights without a codec are copied verbatim.");
+
+  static void encode(weight_type const &, weight_type const &current,
+                     std::vector<std::uint8_t> &out) {
+    auto const offset = out.size();
+    out.resize(offset + sizeof(weight_type));
+    std::memcpy(out.data() + offset, &current, sizeof(weight_type));
+  }
+
+  static weight_type decode(weight_type const &, std::uint8_t const *&in) {
+    weight_type result;
+    std::memcpy(&result, in, sizeof(weight_type));
+    in += sizeof(weight_type);
+    return result;
+  }
+};
+
+template <typename weight_type>
+struct WeightCodec<weight_type, typename std::enable_if<std::is_integral<
+                                    weight_type>::value>::type> {
+  static void encode(weight_type const previous, weight_type const current,
+                     std::vector<std::uint8_t> &out) {
+    write_varint(zigzag(static_cast<std::int64_t>(
+                     static_cast<std::uint64_t>(current) -
+                     static_cast<std::uint64_t>(previous))),
+                 out);
+  }
+
+  static weight_type decode(weight_type const previous,
+                            std::uint8_t const *&in) {
+    return static_cast<weight_type>(static_cast<std::uint64_t>(previous) +
+                                    unzigzag(read_varint(in)));
+  }
+};
+
+template <> struct WeightCodec<graph::WeightTimeDistance> {
+  using codec_type = WeightCodec<std::uint32_t>;
+
+  static void encode(graph::WeightTimeDistance const &previous,
+                     graph::WeightTimeDistance const &current,
+                     std::vector<std::uint8_t> &out) {
+    codec_type::encode(previous.weight, current.weight, out);
+    codec_type::encode(previous.time, current.time, out);
+    codec_type::encode(previous.distance, current.distance, out);
+  }
+
+  static graph::WeightTimeDistance
+  decode(graph::WeightTimeDistance const &previous, std::uint8_t const *&in) {
+    graph::WeightTimeDistance result;
+    result.weight = codec_type::decode(previous.weight, in);
+    result.time = codec_type::decode(previous.time, in);
+    result.distance = codec_type::decode(previous.distance, in);
+    return result;
+  }
+};
+} // namespace detail
+
+// A route in a compact byte encoding, for keeping or shipping routes with
+// thousands of segments. Consecutive segments of a route usually follow edges
+// with close IDs and grow the weight by a little, so every segment is stored as
+// the differences to its predecessor in variable length integers. With integral
+// weights, a segment usually takes a few bytes instead of sixteen.
+template <typename weight_type> class CompactRoute {
+public:
+  CompactRoute() = default;
+  explicit CompactRoute(Route<weight_type> const &route) { encode(route); }
+
+  // replaces the contents, reusing the allocated bytes
+  void encode(Route<weight_type> const &route);
+  // writes the segments into a route, reusing its allocated segments
+  void decode(Route<weight_type> &route) const;
+  Route<weight_type> decode() const;
+
+  // visits the segments in order, as visitor(Segment<weight_type> const &),
+  // without decoding the full route
+  template <typename visitor_type> void for_each(visitor_type visitor) const;
+
+  // the number of segments
+  std::size_t size() const { return number_of_segments; }
+  bool empty() const { return number_of_segments == 0; }
+  std::vector<std::uint8_t> const &bytes() const { return data; }
+
+private:
+  using codec_type = detail::WeightCodec<weight_type>;
+
+  std::size_t number_of_segments = 0;
+  std::vector<std::uint8_t> data;
+};
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+template <typename weight_type>
+void CompactRoute<weight_type>::encode(Route<weight_type> const &route) {
+  data.clear();
+  number_of_segments = route.segments.size();
+  EdgeID previous_edge = 0;
+  weight_type previous_weight{};
+  for (auto const &segment : route.segments) {
+    // edge IDs wrap around, so any difference fits into 64 bits
+    detail::write_varint(
+        detail::zigzag(static_cast<std::int64_t>(segment.edge_id -
+                                                 previous_edge)),
+        data);
+    codec_type::encode(previous_weight, segment.weight_at_end, data);
+    previous_edge = segment.edge_id;
+    previous_weight = segment.weight_at_end;
+  }
+}
+
+template <typename weight_type>
+template <typename visitor_type>
+void CompactRoute<weight_type>::for_each(visitor_type visitor) const {
+  auto in = data.data();
+  Segment<weight_type> segment{weight_type{}, 0};
+  for (std::size_t index = 0; index < number_of_segments; ++index) {
+    segment.edge_id += static_cast<EdgeID>(
+        detail::unzigzag(detail::read_varint(in)));
+    segment.weight_at_end = codec_type::decode(segment.weight_at_end, in);
+    visitor(static_cast<Segment<weight_type> const &>(segment));
+  }
+}
+
+template <typename weight_type>
+void CompactRoute<weight_type>::decode(Route<weight_type> &route) const {
+  route.segments.resize(number_of_segments);
+  auto segment = route.segments.begin();
+  for_each([&segment](auto const &decoded) { *segment++ = decoded; });
+}
+
+template <typename weight_type>
+Route<weight_type> CompactRoute<weight_type>::decode() const {
+  Route<weight_type> route;
+  decode(route);
+  return route;
+}
+
+} // namespace route
+} // namespace project_x
+
+#endif // PROJECT_X_ROUTE_COMPACT_ROUTE_HPP_
@@ -0,0 +1,158 @@
+#ifndef PROJECT_X_SPATIAL_GRID_INDEX_HPP_
+#define PROJECT_X_SPATIAL_GRID_INDEX_HPP_
+
+#include "algorithm/shortest_path_interface.hpp"
+#include "geometry/coordinate.hpp"
+#include "graph/id.hpp"
+#include "io/file.hpp"
+#include "io/section.hpp"
+#include "util/parallel.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace project_x {
+namespace spatial {
+
+// an edge of the graph, indexed as straight segment between its nodes
+struct IndexedEdge {
+  EdgeID edge;
+  NodeID source;
+  NodeID target;
+};
+
+// the result of snapping a coordinate onto an edge
+struct Candidate {
+  EdgeID edge;
+  NodeID source;
+  NodeID target;
+  // the closest point on the edge and its position along the edge, from 0
+  // (source) to 1 (target)
+  geometry::WGS84FixedCoorinate projected;
+  double ratio;
+  // distance in meters between the query and the projected coordinate
+  double distance;
+};
+
+// A static grid over fixed precision WGS84 coordinates, returning the edges
+// closest to a coordinate. Every edge is referenced by all cells its bounding
+// box overlaps. Only non-empty cells are stored, in the order of their row and
+// column, so the grid covers the planet without memory for empty regions.
+// Queries search rings of cells around the query coordinate until no closer
+// edge can be found.
+class GridIndex {
+public:
+  // in fixed precision units (1e-5 degrees), 0.01 degrees are about a kilometer
+  static constexpr std::int32_t default_cell_size = 1000;
+
+  GridIndex();
+  // coordinates hold the location of every node, the build runs on multiple
+  // threads
+  GridIndex(std::vector<geometry::WGS84FixedCoorinate> coordinates,
+            std::vector<IndexedEdge> edges,
+            std::size_t const threads = util::default_concurrency(),
+            std::int32_t const cell_size = default_cell_size);
+
+  // all edges of a graph (e.g. graph::ForwardStar)
+  template <typename graph_type>
+  static std::vector<IndexedEdge> edges_of(graph_type const &graph);
+
+  // the (up to) k closest edges within max_distance meters, ordered by their
+  // distance
+  std::vector<Candidate>
+  nearest(geometry::WGS84FixedCoorinate const coordinate, std::size_t const k,
+          double const max_distance = std::numeric_limits<double>::max()) const;
+
+  // batch lookups, queries are distributed over multiple threads
+  std::vector<std::vector<Candidate>>
+  nearest(std::vector<geometry::WGS84FixedCoorinate> const &coordinates,
+          std::size_t const k,
+          double const max_distance = std::numeric_limits<double>::max(),
+          std::size_t const threads = util::default_concurrency()) const;
+
+  std::size_t number_of_edges() const;
+  std::size_t number_of_cells() const;
+
+  void serialise(io::File &file) const;
+  void deserialise(io::File &file);
+  // the index is stored in sections prefixed with spatial_index
+  void serialise(io::SectionWriter &writer) const;
+  void deserialise(io::SectionReader const &reader);
+
+private:
+  using cell_type = std::uint64_t;
+
+  cell_type cell_of(std::int32_t const row, std::int32_t const column) const;
+  std::int32_t row_of(geometry::WGS84FixedCoorinate const coordinate) const;
+  std::int32_t column_of(geometry::WGS84FixedCoorinate const coordinate) const;
+
+  Candidate snap(geometry::WGS84FixedCoorinate const coordinate,
+                 IndexedEdge const &edge) const;
+
+  std::int32_t cell_size;
+  std::vector<geometry::WGS84FixedCoorinate> coordinates;
+  std::vector<IndexedEdge> edges;
+  // sorted non-empty cells, the edges of cell i are
+  // cell_edges[cell_offsets[i]] to cell_edges[cell_offsets[i + 1]]
+  std::vector<cell_type> cells;
+  std::vector<std::uint64_t> cell_offsets;
+  std::vector<std::uint64_t> cell_edges;
+  // the extent of the grid in rows/columns, to stop searches early
+  std::int32_t min_row, max_row, min_column, max_column;
+};
+
+// The part of an edge weight up to a ratio along the edge. Weights other than
+// arithmetic types have to support multiplication with a double
+template <typename weight_type>
+weight_type partial_weight(weight_type const &weight, double const ratio);
+
+// Locations to start a search at a candidate (continuing towards the target of
+// its edge) and to end it there (arriving from the source of its edge)
+template <typename weight_type>
+algorithm::Location<weight_type> source_location(Candidate const &candidate,
+                                                 weight_type const &weight);
+template <typename weight_type>
+algorithm::Location<weight_type> target_location(Candidate const &candidate,
+                                                 weight_type const &weight);
+
+template <typename graph_type>
+std::vector<IndexedEdge> GridIndex::edges_of(graph_type const &graph) {
+  std::vector<IndexedEdge> result;
+  result.reserve(graph.number_of_edges());
+  for (NodeID node = 0; node < graph.number_of_nodes(); ++node)
+    for (auto edge = graph.edges_begin(node); edge != graph.edges_end(node);
+         ++edge)
+      result.push_back({graph.edge_id(edge), node, *edge});
+  return result;
+}
+
+template <typename weight_type>
+weight_type partial_weight(weight_type const &weight, double const ratio) {
+  if constexpr (std::is_integral<weight_type>::value)
+    return static_cast<weight_type>(std::llround(weight * ratio));
+  else if constexpr (std::is_floating_point<weight_type>::value)
+    return static_cast<weight_type>(weight * ratio);
+  else
+    return weight * ratio;
+}
+
+template <typename weight_type>
+algorithm::Location<weight_type> source_location(Candidate const &candidate,
+                                                 weight_type const &weight) {
+  return {candidate.target, partial_weight(weight, 1.0 - candidate.ratio)};
+}
+
+template <typename weight_type>
+algorithm::Location<weight_type> target_location(Candidate const &candidate,
+                                                 weight_type const &weight) {
+  return {candidate.source, partial_weight(weight, candidate.ratio)};
+}
+
+} // namespace spatial
+} // namespace project_x
+
+#endif // PROJECT_X_SPATIAL_GRID_INDEX_HPP_
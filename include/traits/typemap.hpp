@@ -13,7 +13,8 @@ enum class typemap {
   tagWebMercLatitude,
   // ID types
   tagNodeID,
-  tagEdgeID
+  tagEdgeID,
+  tagDictionaryID
 };
 
 } // namespace traits
@@ -0,0 +1,59 @@
+#ifndef PROJECT_X_UTIL_PARALLEL_HPP_
+#define PROJECT_X_UTIL_PARALLEL_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace project_x {
+namespace util {
+
+// the number of threads to use if nothing else is specified
+inline std::size_t default_concurrency() {
+  return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Splits the range [0, size) into one contiguous chunk per thread and calls
+// function(chunk_begin, chunk_end, chunk_index) for every chunk in parallel.
+// Chunks are assigned in order, so chunk i covers smaller indices than chunk
+// i+1. Exceptions thrown within a chunk are rethrown on the calling thread.
+template <typename function_type>
+void parallel_for(std::size_t const size, function_type function,
+                  std::size_t const threads = default_concurrency()) {
+  auto const number_of_chunks =
+      std::max<std::size_t>(1, std::min(threads, size));
+  auto const chunk_size = (size + number_of_chunks - 1) / number_of_chunks;
+
+  if (number_of_chunks == 1) {
+    function(std::size_t(0), size, std::size_t(0));
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(number_of_chunks);
+  std::vector<std::thread> workers;
+  workers.reserve(number_of_chunks);
+  for (std::size_t chunk = 0; chunk < number_of_chunks; ++chunk) {
+    auto const begin = std::min(size, chunk * chunk_size);
+    auto const end = std::min(size, begin + chunk_size);
+    workers.emplace_back([&function, &errors, begin, end, chunk]() {
+      try {
+        function(begin, end, chunk);
+      } catch (...) {
+        errors[chunk] = std::current_exception();
+      }
+    });
+  }
+
+  for (auto &worker : workers)
+    worker.join();
+  for (auto const &error : errors)
+    if (error)
+      std::rethrow_exception(error);
+}
+
+} // namespace util
+} // namespace project_x
+
+#endif // PROJECT_X_UTIL_PARALLEL_HPP_
@@ -10,7 +10,7 @@ CmakeLists.txt
 
 namespace project_x {
 const constexpr std::uint32_t version_major = 0;
-const constexpr std::uint32_t version_minor = 0;
+const constexpr std::uint32_t version_minor = 1;
 const constexpr std::uint32_t version_patch = 0;
 }
 
@@ -3,40 +3,81 @@
 import osmium
 import sys
 import xpython
+from array import array
 from itertools import islice
 from profiles.car import OSMCar
 
+# number of edges collected before handing them to the builder in one call
+BATCH_SIZE = 1 << 16
+
 class ImportHandler(osmium.SimpleHandler):
     def __init__(self, profile, builder):
         super(ImportHandler, self).__init__()
         self.profile = profile
         self.builder = builder
+        self.payload_ids = {}
+        self.reset_batch()
+
+    def reset_batch(self):
+        self.sources = array('Q')
+        self.targets = array('Q')
+        self.weights = array('I')
+        self.times = array('I')
+        self.distances = array('I')
+        self.payloads = array('I')
+
+    # hand all collected edges to the builder in a single call
+    def flush(self):
+        if len(self.sources) > 0:
+            self.builder.add_edges(self.sources, self.targets, self.weights,
+                                   self.times, self.distances, self.payloads)
+            self.reset_batch()
+
+    # payloads are interned once, edges only refer to their ID
+    def payload_id(self, payload):
+        if payload not in self.payload_ids:
+            self.payload_ids[payload] = self.builder.add_payload(payload)
+        return self.payload_ids[payload]
 
     def way(self, osm_way):
         # check if the way has a highway tag
         if self.profile.valid(osm_way):
             self.add_way(osm_way)
 
-    # add a way (checked) to the builder 
+    # add a way (checked) to the builder
     def add_way(self,osm_way):
+        payload = self.payload_id(osm_way.tags['highway'])
+        speed = self.profile.get_speed(osm_way)
         for cur, nex in zip(osm_way.nodes,islice(osm_way.nodes,1,None)):
             source = int(str(cur))
             target = int(str(nex))
             #distance in meters
             length = 1.0 # get_distance(osm_way,cur,nex)
             #time in seconds
-            time = length / self.profile.get_speed(osm_way)
+            time = length / speed
             #compute a good routing weight: TODO
             weight = time
-            self.builder.add_edge(source, target, int(10*weight), int(10*time), int(10*length), osm_way.tags['highway'])
-        
+            self.sources.append(source)
+            self.targets.append(target)
+            self.weights.append(int(10*weight))
+            self.times.append(int(10*time))
+            self.distances.append(int(10*length))
+            self.payloads.append(payload)
+        if len(self.sources) >= BATCH_SIZE:
+            self.flush()
+
 # running the handler
 if __name__ == '__main__':
-    if len(sys.argv) != 3:
-        print('Usage: python import-osm.py <osmfile> <output>')
+    sectioned = '--sectioned' in sys.argv[3:]
+    if len(sys.argv) != 3 + sectioned:
+        print('Usage: python import-osm.py <osmfile> <output> [--sectioned]')
         sys.exit(0)
-   
+
     builder = xpython.importer.WeightTimeDistanceGraph()
     importer = ImportHandler(OSMCar(),builder)
     importer.apply_file(sys.argv[1])
-    builder.build_weighted_graph_and_store(sys.argv[2]) 
+    importer.flush()
+    if sectioned:
+        builder.build_annotated_graph_and_store_sections(sys.argv[2])
+    else:
+        builder.build_annotated_graph_and_store(sys.argv[2])
@@ -1,4 +1,7 @@
 # A car profile that decides usage / non usage of OSM tags
+#
+# The native importer (src/importer/profile.cpp) shares the speeds below, but
+# additionally honours access, maxspeed (km/h, mph, knots) and oneway tags.
 
 #from sets import Set
 
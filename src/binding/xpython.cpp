@@ -1,10 +1,17 @@
+#include <boost/python/args.hpp>
 #include <boost/python/class.hpp>
 #include <boost/python/module.hpp>
+#include <boost/python/object.hpp>
 #include <boost/python/scope.hpp>
 
 #include "builder/graph.hpp"
+#include "container/dictionary.hpp"
 #include "graph/routing.hpp"
+#include "io/section.hpp"
 
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
@@ -12,20 +19,83 @@ class ScopeImport {};
 
 using namespace project_x;
 
-// Adapter class to handle variadic template on graph side
-class BasicGraph : public builder::Graph<builder::Edge<std::string>> {
-  using Base = builder::Graph<builder::Edge<std::string>>;
+namespace {
+// Releases the global interpreter lock for the lifetime of the object, so that
+// long running C++ code does not block other python threads
+class ReleaseGIL {
+public:
+  ReleaseGIL() : state(PyEval_SaveThread()) {}
+  ~ReleaseGIL() { PyEval_RestoreThread(state); }
+
+  ReleaseGIL(ReleaseGIL const &) = delete;
+  ReleaseGIL &operator=(ReleaseGIL const &) = delete;
+
+private:
+  PyThreadState *state;
+};
+
+// Read-only view into a contiguous python buffer (array.array, numpy arrays,
+// bytes, ...) of integers. No element is converted, the data is accessed in
+// place.
+template <typename value_type> class IntegerBuffer {
+public:
+  IntegerBuffer(boost::python::object const &object, char const *name) {
+    if (PyObject_GetBuffer(object.ptr(), &view,
+                           PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+      PyErr_Clear();
+      throw std::invalid_argument(std::string(name) +
+                                  " does not support the buffer protocol.");
+    }
+
+    // skip byte order / alignment markers, only native layouts are supported
+    char const *format = view.format ? view.format : "B";
+    if (*format == '@' || *format == '=')
+      ++format;
+    if (std::strlen(format) != 1 || !std::strchr("bBhHiIlLqQ", *format) ||
+        view.itemsize != sizeof(value_type)) {
+      PyBuffer_Release(&view);
+      throw std::invalid_argument(
+          std::string(name) + " has to be a buffer of " +
+          std::to_string(8 * sizeof(value_type)) + " bit integers.");
+    }
+  }
+  ~IntegerBuffer() { PyBuffer_Release(&view); }
+
+  IntegerBuffer(IntegerBuffer const &) = delete;
+  IntegerBuffer &operator=(IntegerBuffer const &) = delete;
+
+  value_type const *data() const {
+    return static_cast<value_type const *>(view.buf);
+  }
+  std::size_t size() const { return view.len / view.itemsize; }
+
+private:
+  Py_buffer view;
+};
+} // namespace
+
+// Adapter class to handle variadic template on graph side. Payloads are
+// interned, so repeated strings are only stored once
+class BasicGraph
+    : public builder::Graph<builder::Edge<container::DictionaryID>> {
+  using Base = builder::Graph<builder::Edge<container::DictionaryID>>;
 
 public:
   void add_edge(std::uint64_t source, std::uint64_t target, std::string str) {
     Base::add_edge(source, target, std::move(str));
   }
+
+  void build_graph_and_store(std::string const path) {
+    ReleaseGIL release;
+    Base::build_graph_and_store(path);
+  }
 };
 
 using WeightedEdge =
     builder::Edge<graph::WeightTimeDistance::weight_type,
                   graph::WeightTimeDistance::time_type,
-                  graph::WeightTimeDistance::distance_type, std::string>;
+                  graph::WeightTimeDistance::distance_type,
+                  container::DictionaryID>;
 class WeightTimeDistanceGraph : public builder::Graph<WeightedEdge> {
   using Base = builder::Graph<WeightedEdge>;
 
@@ -39,9 +109,80 @@ public:
                    std::move(distance), std::move(str));
   }
 
+  std::uint32_t add_payload(std::string const &payload) {
+    return Base::add_payload(payload).base();
+  }
+
+  // Add a batch of edges from buffers (e.g. array.array('Q') for IDs and
+  // array.array('I') for the remaining columns). Payloads are referenced by
+  // the IDs returned from add_payload.
+  void add_edges(boost::python::object const &sources,
+                 boost::python::object const &targets,
+                 boost::python::object const &weights,
+                 boost::python::object const &times,
+                 boost::python::object const &distances,
+                 boost::python::object const &payload_ids) {
+    IntegerBuffer<std::uint64_t> source_buffer(sources, "sources");
+    IntegerBuffer<std::uint64_t> target_buffer(targets, "targets");
+    IntegerBuffer<graph::WeightTimeDistance::weight_type> weight_buffer(
+        weights, "weights");
+    IntegerBuffer<graph::WeightTimeDistance::time_type> time_buffer(times,
+                                                                    "times");
+    IntegerBuffer<graph::WeightTimeDistance::distance_type> distance_buffer(
+        distances, "distances");
+    IntegerBuffer<std::uint32_t> payload_buffer(payload_ids, "payload_ids");
+
+    auto const count = source_buffer.size();
+    if (target_buffer.size() != count || weight_buffer.size() != count ||
+        time_buffer.size() != count || distance_buffer.size() != count ||
+        payload_buffer.size() != count)
+      throw std::invalid_argument("All columns need to be of equal length.");
+
+    ReleaseGIL release;
+    for (std::size_t i = 0; i < count; ++i)
+      if (payload_buffer.data()[i] >= payloads().size())
+        throw std::out_of_range("Payload ID " +
+                                std::to_string(payload_buffer.data()[i]) +
+                                " has not been added.");
+
+    static_assert(sizeof(container::DictionaryID) == sizeof(std::uint32_t),
+                  "Payload IDs need to be usable in place.");
+    Base::add_edges(
+        count, source_buffer.data(), target_buffer.data(),
+        weight_buffer.data(), time_buffer.data(), distance_buffer.data(),
+        reinterpret_cast<container::DictionaryID const *>(
+            payload_buffer.data()));
+  }
+
+  void build_graph_and_store(std::string const path) {
+    ReleaseGIL release;
+    Base::build_graph_and_store(path);
+  }
+
   void build_weighted_graph_and_store(std::string const path) {
+    ReleaseGIL release;
     Base::build_weighted_graph_and_store<graph::WeightTimeDistance>(path);
   }
+
+  void build_annotated_graph_and_store(std::string const path) {
+    ReleaseGIL release;
+    Base::build_annotated_graph_and_store<graph::WeightTimeDistance>(path);
+  }
+
+  // sectioned graphs, loadable via graph::AsyncLoader
+  void build_weighted_graph_and_store_sections(std::string const path,
+                                               bool const compress) {
+    ReleaseGIL release;
+    Base::build_weighted_graph_and_store_sections<graph::WeightTimeDistance>(
+        path, compress ? io::Encoding::BLOCK_PACKED : io::Encoding::RAW);
+  }
+
+  void build_annotated_graph_and_store_sections(std::string const path,
+                                                bool const compress) {
+    ReleaseGIL release;
+    Base::build_annotated_graph_and_store_sections<graph::WeightTimeDistance>(
+        path, compress ? io::Encoding::BLOCK_PACKED : io::Encoding::RAW);
+  }
 };
 
 BOOST_PYTHON_MODULE(xpython) {
@@ -54,6 +195,18 @@ BOOST_PYTHON_MODULE(xpython) {
 
   class_<WeightTimeDistanceGraph>("WeightTimeDistanceGraph")
       .def("add_edge", &WeightTimeDistanceGraph::add_edge)
+      .def("add_payload", &WeightTimeDistanceGraph::add_payload)
+      .def("add_edges", &WeightTimeDistanceGraph::add_edges)
+      .def("build_graph_and_store",
+           &WeightTimeDistanceGraph::build_graph_and_store)
       .def("build_weighted_graph_and_store",
-           &WeightTimeDistanceGraph::build_graph_and_store);
+           &WeightTimeDistanceGraph::build_weighted_graph_and_store)
+      .def("build_annotated_graph_and_store",
+           &WeightTimeDistanceGraph::build_annotated_graph_and_store)
+      .def("build_weighted_graph_and_store_sections",
+           &WeightTimeDistanceGraph::build_weighted_graph_and_store_sections,
+           (arg("path"), arg("compress") = false))
+      .def("build_annotated_graph_and_store_sections",
+           &WeightTimeDistanceGraph::build_annotated_graph_and_store_sections,
+           (arg("path"), arg("compress") = false));
 }
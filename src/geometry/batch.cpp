@@ -0,0 +1,249 @@
+#include "geometry/batch.hpp"
+#include "geometry/constants.hpp"
+#include "geometry/coordinate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace project_x {
+namespace geometry {
+namespace batch {
+
+namespace {
+// All kernels are written branch free (selects instead of conditional code)
+// and are inlined into plain loops, so the compiler can vectorise them.
+const constexpr double pi = 3.14159265358979323846;
+const constexpr double degree_to_rad = pi / 180.0;
+const constexpr double rad_to_degree = 180.0 / pi;
+const constexpr double precision = fixed_coordinate_precision;
+const constexpr double earth_radius =
+    static_cast<double>(constants::earth_radius_meters);
+
+const constexpr double ln2_hi = 6.93147180369123816490e-01;
+const constexpr double ln2_lo = 1.90821492927058770002e-10;
+const constexpr double log2e = 1.44269504088896338700e+00;
+const constexpr double sqrt2 = 1.41421356237309504880;
+const constexpr double tan_pi_8 = 0.41421356237309504880;
+// adding 1.5 * 2^52 rounds doubles to integers in the low mantissa bits
+const constexpr double round_magic = 6755399441055744.0;
+const constexpr double two_52 = 4503599627370496.0;
+
+inline std::uint64_t bits_of(double const value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline double from_bits(std::uint64_t const bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline double to_radians(std::int32_t const fixed) {
+  return fixed * (degree_to_rad / precision);
+}
+
+// rounding half away from zero, as coordinate::to_fixed
+inline std::int32_t to_fixed(double const value) {
+  auto const scaled = value * precision;
+  return static_cast<std::int32_t>(scaled + (scaled < 0 ? -0.5 : 0.5));
+}
+
+// taylor series on [-pi/4, pi/4], errors below 1e-15
+inline double sin_kernel(double const x) {
+  auto const x2 = x * x;
+  auto p = -1.0 / 1307674368000.0;
+  p = p * x2 + 1.0 / 6227020800.0;
+  p = p * x2 - 1.0 / 39916800.0;
+  p = p * x2 + 1.0 / 362880.0;
+  p = p * x2 - 1.0 / 5040.0;
+  p = p * x2 + 1.0 / 120.0;
+  p = p * x2 - 1.0 / 6.0;
+  return x + x * x2 * p;
+}
+
+inline double cos_kernel(double const x) {
+  auto const x2 = x * x;
+  auto p = -1.0 / 87178291200.0;
+  p = p * x2 + 1.0 / 479001600.0;
+  p = p * x2 - 1.0 / 3628800.0;
+  p = p * x2 + 1.0 / 40320.0;
+  p = p * x2 - 1.0 / 720.0;
+  p = p * x2 + 1.0 / 24.0;
+  p = p * x2 - 0.5;
+  return 1.0 + x2 * p;
+}
+
+// cos on [-pi/2, pi/2], via cos(x) = sin(pi/2 - x)
+inline double cosine(double const x) {
+  auto const absolute = std::abs(x);
+  return absolute > pi / 4 ? sin_kernel(pi / 2 - absolute)
+                           : cos_kernel(absolute);
+}
+
+// sin on [-pi, pi], via sin(x) = sin(pi - x) and sin(x) = cos(pi/2 - x).
+// Values close to 1 have to be exact, they decide the distance of (almost)
+// antipodal points
+inline double sine(double const x) {
+  auto const folded = x > pi / 2 ? pi - x : (x < -pi / 2 ? -pi - x : x);
+  auto const absolute = std::abs(folded);
+  auto const result = absolute > pi / 4 ? cos_kernel(pi / 2 - absolute)
+                                        : sin_kernel(absolute);
+  return std::copysign(result, folded);
+}
+
+// natural logarithm of positive, normal numbers
+inline double log_kernel(double const x) {
+  auto const bits = bits_of(x);
+  // x = m * 2^e with m in [1, 2), moved to [sqrt(2)/2, sqrt(2))
+  auto exponent =
+      from_bits(0x4330000000000000ull | (bits >> 52)) - two_52 - 1023.0;
+  auto mantissa =
+      from_bits((bits & 0x000fffffffffffffull) | 0x3ff0000000000000ull);
+  auto const large = mantissa > sqrt2;
+  mantissa = large ? 0.5 * mantissa : mantissa;
+  exponent = large ? exponent + 1.0 : exponent;
+
+  // log(m) = 2 atanh(z), |z| < 0.172
+  auto const z = (mantissa - 1.0) / (mantissa + 1.0);
+  auto const z2 = z * z;
+  auto p = 1.0 / 17.0;
+  p = p * z2 + 1.0 / 15.0;
+  p = p * z2 + 1.0 / 13.0;
+  p = p * z2 + 1.0 / 11.0;
+  p = p * z2 + 1.0 / 9.0;
+  p = p * z2 + 1.0 / 7.0;
+  p = p * z2 + 1.0 / 5.0;
+  p = p * z2 + 1.0 / 3.0;
+  return exponent * ln2_hi + (exponent * ln2_lo + 2.0 * z * (1.0 + z2 * p));
+}
+
+// exponential function for |x| < 700
+inline double exp_kernel(double const x) {
+  // x = k ln(2) + r, |r| <= ln(2) / 2
+  auto const shifted = x * log2e + round_magic;
+  auto const k = shifted - round_magic;
+  auto const r = (x - k * ln2_hi) - k * ln2_lo;
+  auto p = 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+  // 2^k, k is held in the low bits of the rounded value
+  auto const exponent = bits_of(shifted) - bits_of(round_magic);
+  return p * from_bits((exponent + 1023) << 52);
+}
+
+// arcus tangens of non-negative numbers (including infinity)
+inline double atan_kernel(double const x) {
+  // atan(x) = pi/2 - atan(1/x) and atan(x) = pi/4 + atan((x-1)/(x+1))
+  auto const inverse = 1.0 / x;
+  auto const inverted = x > 1.0;
+  auto const u = inverted ? inverse : x;
+  auto const reduced_u = (u - 1.0) / (u + 1.0);
+  auto const shifted = u > tan_pi_8;
+  auto const v = shifted ? reduced_u : u;
+
+  // taylor series, |v| <= tan(pi/8)
+  auto const v2 = v * v;
+  auto p = -1.0 / 27.0;
+  p = p * v2 + 1.0 / 25.0;
+  p = p * v2 - 1.0 / 23.0;
+  p = p * v2 + 1.0 / 21.0;
+  p = p * v2 - 1.0 / 19.0;
+  p = p * v2 + 1.0 / 17.0;
+  p = p * v2 - 1.0 / 15.0;
+  p = p * v2 + 1.0 / 13.0;
+  p = p * v2 - 1.0 / 11.0;
+  p = p * v2 + 1.0 / 9.0;
+  p = p * v2 - 1.0 / 7.0;
+  p = p * v2 + 1.0 / 5.0;
+  p = p * v2 - 1.0 / 3.0;
+  auto const reduced = v + v * v2 * p + (shifted ? pi / 4 : 0.0);
+  return inverted ? pi / 2 - reduced : reduced;
+}
+} // namespace
+
+void projectWgsWebMerc(std::size_t const count, std::int32_t const *latitudes,
+                       std::int32_t const *longitudes,
+                       std::int32_t *merc_latitudes,
+                       std::int32_t *merc_longitudes) {
+  auto const max_latitude = to_fixed(constants::epsg3857_max_latitude);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const latitude =
+        std::min(max_latitude, std::max(-max_latitude, latitudes[i]));
+    auto const sin_lat = sine(to_radians(latitude));
+    auto const longitude = longitudes[i];
+
+    merc_latitudes[i] = to_fixed(
+        128.0 - 64.0 / pi * log_kernel((1 + sin_lat) / (1 - sin_lat)));
+    merc_longitudes[i] = to_fixed(longitude * (128.0 / 180.0 / precision) +
+                                  128.0);
+  }
+}
+
+void projectWebMercWgs(std::size_t const count,
+                       std::int32_t const *merc_latitudes,
+                       std::int32_t const *merc_longitudes,
+                       std::int32_t *latitudes, std::int32_t *longitudes) {
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const y = (128.0 - merc_latitudes[i] / precision) * (pi / 128.0);
+    auto const merc_longitude = merc_longitudes[i];
+
+    latitudes[i] =
+        to_fixed(rad_to_degree * (2 * atan_kernel(exp_kernel(y)) - pi / 2));
+    longitudes[i] =
+        to_fixed(merc_longitude * (180.0 / 128.0 / precision) - 180.0);
+  }
+}
+
+void haversine_distance(std::size_t const count,
+                        std::int32_t const *from_latitudes,
+                        std::int32_t const *from_longitudes,
+                        std::int32_t const *to_latitudes,
+                        std::int32_t const *to_longitudes, double *distances) {
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const from_lat = to_radians(from_latitudes[i]);
+    auto const to_lat = to_radians(to_latitudes[i]);
+    auto const delta_lon = to_radians(to_longitudes[i] - from_longitudes[i]);
+
+    auto const sin_half_lat = sine((to_lat - from_lat) / 2);
+    auto const sin_half_lon = sine(delta_lon / 2);
+    auto const a = std::min(1.0, sin_half_lat * sin_half_lat +
+                                     cosine(from_lat) * cosine(to_lat) *
+                                         sin_half_lon * sin_half_lon);
+    // asin(sqrt(a)) = atan(sqrt(a / (1 - a)))
+    distances[i] = earth_radius * 2 * atan_kernel(std::sqrt(a / (1 - a)));
+  }
+}
+
+void equirectangular_distance(std::size_t const count,
+                              std::int32_t const *from_latitudes,
+                              std::int32_t const *from_longitudes,
+                              std::int32_t const *to_latitudes,
+                              std::int32_t const *to_longitudes,
+                              double *distances) {
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const from_lat = to_radians(from_latitudes[i]);
+    auto const to_lat = to_radians(to_latitudes[i]);
+    auto const delta_lon = to_radians(to_longitudes[i] - from_longitudes[i]);
+
+    auto const x = delta_lon * cosine((from_lat + to_lat) / 2);
+    auto const y = to_lat - from_lat;
+    distances[i] = earth_radius * std::sqrt(x * x + y * y);
+  }
+}
+
+} // namespace batch
+} // namespace geometry
+} // namespace project_x
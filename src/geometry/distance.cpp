@@ -0,0 +1,48 @@
+#include "geometry/distance.hpp"
+#include "geometry/constants.hpp"
+
+#include <cmath>
+
+namespace {
+const constexpr double degree_to_rad = 0.017453292519943295769236907684886;
+} // namespace
+
+namespace project_x {
+namespace geometry {
+
+double haversine_distance(WGS84FixedCoorinate const from,
+                          WGS84FixedCoorinate const to) {
+  auto const from_lat = coordinate::to_floating(from.latitude) * degree_to_rad;
+  auto const to_lat = coordinate::to_floating(to.latitude) * degree_to_rad;
+  auto const delta_lat = to_lat - from_lat;
+  auto const delta_lon = (coordinate::to_floating(to.longitude) -
+                          coordinate::to_floating(from.longitude)) *
+                         degree_to_rad;
+
+  auto const sin_half_lat = std::sin(delta_lat / 2);
+  auto const sin_half_lon = std::sin(delta_lon / 2);
+  auto const a = sin_half_lat * sin_half_lat +
+                 std::cos(from_lat) * std::cos(to_lat) * sin_half_lon *
+                     sin_half_lon;
+
+  // clamp against rounding errors for antipodal points
+  auto const central_angle = 2 * std::asin(std::sqrt(std::fmin(1.0, a)));
+  return static_cast<double>(constants::earth_radius_meters) * central_angle;
+}
+
+double equirectangular_distance(WGS84FixedCoorinate const from,
+                                WGS84FixedCoorinate const to) {
+  auto const from_lat = coordinate::to_floating(from.latitude) * degree_to_rad;
+  auto const to_lat = coordinate::to_floating(to.latitude) * degree_to_rad;
+  auto const delta_lon = (coordinate::to_floating(to.longitude) -
+                          coordinate::to_floating(from.longitude)) *
+                         degree_to_rad;
+
+  auto const x = delta_lon * std::cos((from_lat + to_lat) / 2);
+  auto const y = to_lat - from_lat;
+  return static_cast<double>(constants::earth_radius_meters) *
+         std::sqrt(x * x + y * y);
+}
+
+} // namespace geometry
+} // namespace project_x
@@ -0,0 +1,178 @@
+#include "geometry/polyline.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace project_x {
+namespace geometry {
+namespace polyline {
+
+namespace {
+// coordinates per block of the encoder, the differences of a block are kept on
+// the stack
+const constexpr std::size_t block_size = 256;
+// Differences of 32-bit values scaled by ten take at most 36 bits with their
+// sign, so eight chunks of five bits cover every value.
+const constexpr std::size_t max_chunks = 8;
+
+std::int64_t scale_of(Precision const precision) {
+  return precision == Precision::polyline6 ? 10 : 1;
+}
+
+inline std::uint64_t zigzag(std::int64_t const value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^
+         static_cast<std::uint64_t>(value >> 63);
+}
+
+// Writes all eight chunk characters of a value and returns the position after
+// its last used character. Unused characters are overwritten by the next
+// value, so output buffers need max_encoded_size. The chunks are spread into
+// the bytes of a word, continuation flags and the offset of 63 are added to all
+// bytes at once.
+inline char *write_value(std::uint64_t const value, char *output) {
+  auto const bits = 64 - __builtin_clzll(value | 1);
+  auto const chunks = static_cast<unsigned>((bits + 4) / 5);
+  std::uint64_t word = 0;
+  for (unsigned chunk = 0; chunk < max_chunks; ++chunk)
+    word |= ((value >> (5 * chunk)) & 0x1F) << (8 * chunk);
+  // all but the last chunk are followed by another one
+  auto const continued = (std::uint64_t(1) << (8 * (chunks - 1))) - 1;
+  word |= continued & 0x2020202020202020ull;
+  word += 0x3F3F3F3F3F3F3F3Full;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  std::memcpy(output, &word, max_chunks);
+#else
+  for (unsigned chunk = 0; chunk < max_chunks; ++chunk)
+    output[chunk] = static_cast<char>(word >> (8 * chunk));
+#endif
+  return output + chunks;
+}
+
+template <typename latitude_function, typename longitude_function>
+std::size_t encode_blocks(std::size_t const count, latitude_function latitude,
+                          longitude_function longitude, char *const output,
+                          Precision const precision) {
+  auto const scale = scale_of(precision);
+  std::uint64_t values[2 * block_size];
+  std::int64_t previous_latitude = 0, previous_longitude = 0;
+  auto position = output;
+  for (std::size_t begin = 0; begin < count; begin += block_size) {
+    auto const size = std::min(block_size, count - begin);
+    for (std::size_t index = 0; index < size; ++index) {
+      std::int64_t const lat = latitude(begin + index);
+      std::int64_t const lon = longitude(begin + index);
+      values[2 * index] = zigzag((lat - previous_latitude) * scale);
+      values[2 * index + 1] = zigzag((lon - previous_longitude) * scale);
+      previous_latitude = lat;
+      previous_longitude = lon;
+    }
+    for (std::size_t index = 0; index < 2 * size; ++index)
+      position = write_value(values[index], position);
+  }
+  return position - output;
+}
+
+std::int64_t read_value(char const *input, std::size_t const size,
+                        std::size_t &position) {
+  std::uint64_t value = 0;
+  for (unsigned shift = 0;; shift += 5) {
+    if (position == size)
+      throw std::invalid_argument("Polyline ends within a value.");
+    auto const character = static_cast<unsigned char>(input[position++]);
+    if (character < 63 || character > 63 + 0x3F || shift >= 5 * max_chunks)
+      throw std::invalid_argument("Invalid polyline character at position " +
+                                  std::to_string(position - 1) + ".");
+    auto const chunk = static_cast<std::uint64_t>(character - 63);
+    value |= (chunk & 0x1F) << shift;
+    if (!(chunk & 0x20))
+      break;
+  }
+  return static_cast<std::int64_t>(value >> 1) ^
+         -static_cast<std::int64_t>(value & 1);
+}
+
+// back to fixed precision, rounding halves away from zero
+template <std::int64_t scale> inline std::int32_t to_fixed(std::int64_t value) {
+  if (scale != 1)
+    value = (value + (value < 0 ? -scale / 2 : scale / 2)) / scale;
+  return static_cast<std::int32_t>(value);
+}
+
+template <std::int64_t scale>
+std::size_t decode_values(char const *input, std::size_t const size,
+                          std::int32_t *latitudes, std::int32_t *longitudes) {
+  std::int64_t latitude = 0, longitude = 0;
+  std::size_t position = 0, count = 0;
+  while (position < size) {
+    latitude += read_value(input, size, position);
+    longitude += read_value(input, size, position);
+    latitudes[count] = to_fixed<scale>(latitude);
+    longitudes[count] = to_fixed<scale>(longitude);
+    ++count;
+  }
+  return count;
+}
+} // namespace
+
+std::size_t max_encoded_size(std::size_t const count) {
+  return 2 * max_chunks * count;
+}
+
+std::size_t encode(std::size_t const count, std::int32_t const *latitudes,
+                   std::int32_t const *longitudes, char *output,
+                   Precision const precision) {
+  return encode_blocks(
+      count, [latitudes](std::size_t const index) { return latitudes[index]; },
+      [longitudes](std::size_t const index) { return longitudes[index]; },
+      output, precision);
+}
+
+std::size_t encode(std::size_t const count,
+                   WGS84FixedCoorinate const *coordinates, char *output,
+                   Precision const precision) {
+  return encode_blocks(
+      count,
+      [coordinates](std::size_t const index) {
+        return coordinates[index].latitude.base();
+      },
+      [coordinates](std::size_t const index) {
+        return coordinates[index].longitude.base();
+      },
+      output, precision);
+}
+
+std::string encode(std::vector<WGS84FixedCoorinate> const &coordinates,
+                   Precision const precision) {
+  std::string result(max_encoded_size(coordinates.size()), '\0');
+  result.resize(
+      encode(coordinates.size(), coordinates.data(), &result[0], precision));
+  return result;
+}
+
+std::size_t decode(char const *input, std::size_t const size,
+                   std::int32_t *latitudes, std::int32_t *longitudes,
+                   Precision const precision) {
+  if (precision == Precision::polyline6)
+    return decode_values<10>(input, size, latitudes, longitudes);
+  return decode_values<1>(input, size, latitudes, longitudes);
+}
+
+std::vector<WGS84FixedCoorinate> decode(std::string const &polyline,
+                                        Precision const precision) {
+  std::vector<std::int32_t> latitudes(polyline.size() / 2),
+      longitudes(polyline.size() / 2);
+  auto const count = decode(polyline.data(), polyline.size(), latitudes.data(),
+                            longitudes.data(), precision);
+  std::vector<WGS84FixedCoorinate> result;
+  result.reserve(count);
+  for (std::size_t index = 0; index < count; ++index)
+    result.push_back({FixedWGSLatitude{latitudes[index]},
+                      FixedWGSLongitude{longitudes[index]}});
+  return result;
+}
+
+} // namespace polyline
+} // namespace geometry
+} // namespace project_x
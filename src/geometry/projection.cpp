@@ -38,5 +38,23 @@ WebMercatorFixedCoorinate projectWgsWebMerc(WGS84FixedCoorinate const wgs) {
   return {std::move(web_latitude), std::move(web_longitude)};
 }
 
+WGS84FixedCoorinate projectWebMercWgs(WebMercatorFixedCoorinate const merc) {
+  auto const longitude_radians =
+      coordinate::to_floating(merc.longitude) * M_PI / 128.0 - M_PI;
+
+  auto wgs_longitude = FixedWGSLongitude{
+      coordinate::to_fixed(rad_to_degree * longitude_radians)};
+
+  // inverse of the gudermannian function
+  auto const y =
+      (128.0 - coordinate::to_floating(merc.latitude)) * M_PI / 128.;
+  auto const latitude_radians = 2 * std::atan(std::exp(y)) - M_PI / 2;
+
+  auto wgs_latitude =
+      FixedWGSLatitude{coordinate::to_fixed(rad_to_degree * latitude_radians)};
+
+  return {std::move(wgs_latitude), std::move(wgs_longitude)};
+}
+
 } // namespace geometry
 } // namespace project_x
@@ -158,5 +158,24 @@ void ForwardStar::deserialise(io::File &file) {
                      " edges.");
 }
 
+void ForwardStar::serialise(io::SectionWriter &writer) const {
+  writer.write("forward_star.offsets", node_offsets);
+  writer.write("forward_star.targets", edge_storage);
+}
+
+void ForwardStar::deserialise(io::SectionReader const &reader) {
+  deserialise_layer(reader);
+}
+
+void ForwardStar::deserialise_layer(io::SectionReader const &reader) {
+  reader.read("forward_star.offsets", node_offsets);
+  reader.read("forward_star.targets", edge_storage);
+  log::Logger logger;
+  logger.message(log::Level::DEBUG,
+                 "Deserialise: got " + std::to_string(node_offsets.size() - 1) +
+                     " nodes and " + std::to_string(edge_storage.size()) +
+                     " edges from sections.");
+}
+
 } // namespace graph
 } // namespace project_x
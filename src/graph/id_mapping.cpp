@@ -0,0 +1,46 @@
+#include "graph/id_mapping.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace project_x {
+namespace graph {
+
+IDMapping::IDMapping(std::vector<std::pair<std::uint64_t, NodeID>> mapping) {
+  std::sort(mapping.begin(), mapping.end());
+
+  external_ids.reserve(mapping.size());
+  node_ids.reserve(mapping.size());
+  for (auto const &entry : mapping) {
+    if (!external_ids.empty() && external_ids.back() == entry.first)
+      throw std::invalid_argument("External ID " + std::to_string(entry.first) +
+                                  " is mapped more than once.");
+    external_ids.push_back(entry.first);
+    node_ids.push_back(entry.second);
+  }
+}
+
+std::optional<NodeID>
+IDMapping::node_id(std::uint64_t const external_id) const {
+  auto const itr =
+      std::lower_bound(external_ids.begin(), external_ids.end(), external_id);
+  if (itr == external_ids.end() || *itr != external_id)
+    return {};
+  return node_ids[std::distance(external_ids.begin(), itr)];
+}
+
+std::size_t IDMapping::size() const { return external_ids.size(); }
+
+void IDMapping::serialise(io::File &file) const {
+  file.write_container(external_ids);
+  file.write_container(node_ids);
+}
+
+void IDMapping::deserialise(io::File &file) {
+  file.read_container(external_ids);
+  file.read_container(node_ids);
+}
+
+} // namespace graph
+} // namespace project_x
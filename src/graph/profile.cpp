@@ -0,0 +1,103 @@
+#include "graph/profile.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace project_x {
+namespace graph {
+
+namespace {
+// a single evaluation, shared by the scalar and the batch interface. The
+// departure is relative to midnight already.
+inline std::uint32_t evaluate(std::uint16_t const *samples,
+                              std::uint32_t const size,
+                              std::uint32_t const static_time,
+                              std::uint32_t const time_of_day) {
+  double const position = static_cast<double>(time_of_day) * size /
+                          ProfileTable::period;
+  auto const index = static_cast<std::uint32_t>(position);
+  double const fraction = position - index;
+  // the last sample interpolates towards the first one of the next day
+  auto const next = (index + 1) % size;
+  double const factor =
+      samples[index] + (double(samples[next]) - samples[index]) * fraction;
+  return static_cast<std::uint32_t>(static_time * factor /
+                                        ProfileTable::factor_scale +
+                                    0.5);
+}
+} // namespace
+
+ProfileTable::ProfileTable() : offsets(1, 0) {
+  add(std::vector<double>(1, 1.0));
+}
+
+ProfileID ProfileTable::add(std::vector<double> const &factors) {
+  if (factors.empty())
+    throw std::invalid_argument("Profiles require at least one sample.");
+
+  std::vector<std::uint16_t> profile;
+  profile.reserve(factors.size());
+  for (auto const factor : factors) {
+    auto const value = std::lround(factor * factor_scale);
+    if (!(factor > 0) || value < 1 || value > 0xFFFF)
+      throw std::invalid_argument("Profile factor " + std::to_string(factor) +
+                                  " is out of range.");
+    profile.push_back(static_cast<std::uint16_t>(value));
+  }
+
+  auto const existing = lookup.find(profile);
+  if (existing != lookup.end())
+    return existing->second;
+
+  ProfileID const id = size();
+  samples.insert(samples.end(), profile.begin(), profile.end());
+  offsets.push_back(samples.size());
+  lookup.emplace(std::move(profile), id);
+  return id;
+}
+
+std::size_t ProfileTable::size() const { return offsets.size() - 1; }
+
+std::uint32_t ProfileTable::travel_time(ProfileID const profile,
+                                        std::uint32_t const static_time,
+                                        std::uint32_t const departure) const {
+  return evaluate(samples.data() + offsets[profile],
+                  offsets[profile + 1] - offsets[profile], static_time,
+                  departure % period);
+}
+
+void ProfileTable::travel_times(std::size_t const count,
+                                ProfileID const *profiles,
+                                std::uint32_t const *static_times,
+                                std::uint32_t const departure,
+                                std::uint32_t *result) const {
+  auto const time_of_day = departure % period;
+  auto const *const offset = offsets.data();
+  auto const *const sample = samples.data();
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const profile = profiles[i];
+    result[i] = evaluate(sample + offset[profile],
+                         offset[profile + 1] - offset[profile],
+                         static_times[i], time_of_day);
+  }
+}
+
+void ProfileTable::serialise(io::File &file) const {
+  file.write_container(offsets);
+  file.write_container(samples);
+}
+
+void ProfileTable::deserialise(io::File &file) {
+  file.read_container(offsets);
+  file.read_container(samples);
+  lookup.clear();
+  for (ProfileID id = 0; id < size(); ++id)
+    lookup.emplace(
+        std::vector<std::uint16_t>(samples.begin() + offsets[id],
+                                   samples.begin() + offsets[id + 1]),
+        id);
+}
+
+} // namespace graph
+} // namespace project_x
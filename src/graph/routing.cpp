@@ -1,5 +1,6 @@
 #include "graph/routing.hpp"
 
+#include <cmath>
 #include <tuple>
 
 namespace project_x {
@@ -65,5 +66,11 @@ operator-(WeightTimeDistance const &other) const {
   return copy;
 }
 
+WeightTimeDistance WeightTimeDistance::operator*(double const factor) const {
+  return {static_cast<weight_type>(std::llround(weight * factor)),
+          static_cast<time_type>(std::llround(time * factor)),
+          static_cast<distance_type>(std::llround(distance * factor))};
+}
+
 } // namespace graph
 } // namespace project_x
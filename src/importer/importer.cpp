@@ -0,0 +1,169 @@
+#include "importer/importer.hpp"
+#include "container/flat_hash_map.hpp"
+#include "geometry/distance.hpp"
+#include "importer/osm_xml.hpp"
+#include "log/logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace project_x {
+namespace importer {
+
+namespace {
+// a way accepted by the profile, its nodes are stored in a shared array
+struct WayRecord {
+  std::size_t first_node;
+  std::size_t number_of_nodes;
+  double speed;
+  bool forward;
+  bool backward;
+  container::DictionaryID payload;
+};
+
+// edges in the column layout expected by builder::Graph::add_edges
+struct EdgeBatch {
+  void add(std::uint64_t source, std::uint64_t target,
+           graph::WeightTimeDistance const &cost,
+           container::DictionaryID payload) {
+    sources.push_back(source);
+    targets.push_back(target);
+    weights.push_back(cost.weight);
+    times.push_back(cost.time);
+    distances.push_back(cost.distance);
+    payloads.push_back(payload);
+  }
+
+  void clear() {
+    sources.clear();
+    targets.clear();
+    weights.clear();
+    times.clear();
+    distances.clear();
+    payloads.clear();
+  }
+
+  std::vector<std::uint64_t> sources;
+  std::vector<std::uint64_t> targets;
+  std::vector<graph::WeightTimeDistance::weight_type> weights;
+  std::vector<graph::WeightTimeDistance::time_type> times;
+  std::vector<graph::WeightTimeDistance::distance_type> distances;
+  std::vector<container::DictionaryID> payloads;
+};
+
+// costs are stored in tenth of seconds / meters
+std::uint32_t to_deci_units(double const value) {
+  return static_cast<std::uint32_t>(std::lround(10 * value));
+}
+} // namespace
+
+ImportStatistics import_osm(std::istream &input, ImportGraph &builder,
+                            CarProfile const &profile,
+                            ImportOptions const &options) {
+  log::Logger logger;
+  ImportStatistics statistics;
+
+  container::FlatHashMap<std::uint64_t, std::uint64_t> node_index;
+  std::vector<geometry::WGS84FixedCoorinate> coordinates;
+  std::vector<std::uint64_t> way_nodes;
+  std::vector<WayRecord> ways;
+
+  OSMXMLParser parser(input);
+  parser.parse(
+      [&](OSMNode const &node) {
+        if (node_index.insert(node.id, coordinates.size()).second)
+          coordinates.push_back(node.coordinate);
+      },
+      [&](OSMWay const &way) {
+        if (way.nodes.size() < 2)
+          return;
+        auto const settings = profile.evaluate(way.tags);
+        if (!settings || settings->speed <= 0 ||
+            (!settings->forward && !settings->backward))
+          return;
+        ways.push_back({way_nodes.size(), way.nodes.size(), settings->speed,
+                        settings->forward, settings->backward,
+                        builder.add_payload(settings->road_class)});
+        way_nodes.insert(way_nodes.end(), way.nodes.begin(), way.nodes.end());
+      });
+  statistics.nodes = coordinates.size();
+  statistics.ways = ways.size();
+  logger.message(log::Level::INFO,
+                 "Parsed " + std::to_string(coordinates.size()) +
+                     " nodes and " + std::to_string(ways.size()) +
+                     " routable ways.");
+
+  auto const threads = std::max<std::size_t>(1, options.threads);
+  auto const batch_size = std::max<std::size_t>(1, options.batch_size);
+  std::vector<EdgeBatch> batches(threads);
+
+  for (std::size_t window = 0; window < ways.size(); window += batch_size) {
+    auto const window_end = std::min(ways.size(), window + batch_size);
+
+    // translate the ways of the window into edges, one batch per thread
+    util::parallel_for(
+        window_end - window,
+        [&](std::size_t const begin, std::size_t const end,
+            std::size_t const chunk) {
+          auto &batch = batches[chunk];
+          batch.clear();
+          for (auto way = window + begin; way < window + end; ++way) {
+            auto const &record = ways[way];
+            auto const meters_per_second = record.speed / 3.6;
+            for (std::size_t i = 1; i < record.number_of_nodes; ++i) {
+              auto const from = way_nodes[record.first_node + i - 1];
+              auto const to = way_nodes[record.first_node + i];
+              // repeated references would add zero length self-loops
+              if (from == to)
+                continue;
+              auto const from_index = node_index.find(from);
+              auto const to_index = node_index.find(to);
+              // ways can reference nodes outside of the extract
+              if (!from_index || !to_index)
+                continue;
+
+              auto const length = geometry::haversine_distance(
+                  coordinates[*from_index], coordinates[*to_index]);
+              auto const time = length / meters_per_second;
+              graph::WeightTimeDistance const cost = {
+                  to_deci_units(time), to_deci_units(time),
+                  to_deci_units(length)};
+              if (record.forward)
+                batch.add(from, to, cost, record.payload);
+              if (record.backward)
+                batch.add(to, from, cost, record.payload);
+            }
+          }
+        },
+        threads);
+
+    // the builder itself is sequential, batches are added in order to keep
+    // the result independent of the number of threads
+    for (auto const &batch : batches) {
+      builder.add_edges(batch.sources.size(), batch.sources.data(),
+                        batch.targets.data(), batch.weights.data(),
+                        batch.times.data(), batch.distances.data(),
+                        batch.payloads.data());
+      statistics.edges += batch.sources.size();
+    }
+    for (auto &batch : batches)
+      batch.clear();
+  }
+
+  // locate the nodes of the graph, for its spatial index
+  std::vector<std::uint64_t> node_ids(coordinates.size());
+  node_index.for_each([&node_ids](auto const id, auto const index) {
+    node_ids[index] = id;
+  });
+  builder.add_coordinates(node_ids.size(), node_ids.data(),
+                          coordinates.data());
+
+  logger.message(log::Level::INFO,
+                 "Created " + std::to_string(statistics.edges) + " edges.");
+  return statistics;
+}
+
+} // namespace importer
+} // namespace project_x
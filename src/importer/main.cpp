@@ -0,0 +1,91 @@
+#include "importer/importer.hpp"
+#include "log/logger.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace project_x;
+
+namespace {
+void usage() {
+  std::cout << "Usage: import-osm <osmfile> <output> [--threads N] "
+               "[--mapping <id mapping output>] "
+               "[--index <spatial index output>] [--compress] [--sectioned]"
+            << std::endl;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  std::string const input_path = argv[1];
+  std::string const output_path = argv[2];
+  std::string mapping_path;
+  std::string index_path;
+  io::mode::Enum output_mode = 0;
+  bool sectioned = false;
+  importer::ImportOptions options;
+  for (int arg = 3; arg < argc; ++arg) {
+    std::string const flag = argv[arg];
+    if (flag == "--compress") {
+      output_mode |= io::mode::mCOMPRESSED;
+      continue;
+    }
+    if (flag == "--sectioned") {
+      sectioned = true;
+      continue;
+    }
+    if (arg + 1 == argc) {
+      usage();
+      return EXIT_FAILURE;
+    }
+    if (flag == "--threads") {
+      options.threads = std::stoul(argv[++arg]);
+    } else if (flag == "--mapping") {
+      mapping_path = argv[++arg];
+    } else if (flag == "--index") {
+      index_path = argv[++arg];
+    } else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  log::Logger logger;
+  logger.set_stream(&std::cout);
+  logger.set_level(log::Level::INFO);
+
+  try {
+    std::ifstream input(input_path);
+    if (!input)
+      throw std::runtime_error("Failed to open " + input_path);
+
+    importer::ImportGraph builder;
+    importer::import_osm(input, builder, importer::CarProfile(), options);
+    // sectioned graphs can be loaded via graph::AsyncLoader
+    if (sectioned)
+      builder.build_annotated_graph_and_store_sections<
+          graph::WeightTimeDistance>(output_path,
+                                     (output_mode & io::mode::mCOMPRESSED)
+                                         ? io::Encoding::BLOCK_PACKED
+                                         : io::Encoding::RAW);
+    else
+      builder.build_annotated_graph_and_store<graph::WeightTimeDistance>(
+          output_path, output_mode);
+    if (!mapping_path.empty())
+      builder.store_id_mapping(mapping_path);
+    if (!index_path.empty())
+      builder.build_spatial_index_and_store(index_path, options.threads,
+                                            output_mode);
+  } catch (std::exception const &error) {
+    std::cerr << "Import failed: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+#include "importer/osm_xml.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace project_x {
+namespace importer {
+
+namespace {
+// replace the predefined XML entities within an attribute value
+std::string unescape(std::string value) {
+  if (value.find('&') == std::string::npos)
+    return value;
+
+  std::string result;
+  result.reserve(value.size());
+  for (std::size_t i = 0; i < value.size(); ++i) {
+    if (value[i] != '&') {
+      result.push_back(value[i]);
+      continue;
+    }
+    auto const end = value.find(';', i);
+    if (end == std::string::npos) {
+      result.append(value, i, std::string::npos);
+      break;
+    }
+    auto const entity = value.substr(i + 1, end - i - 1);
+    if (entity == "amp")
+      result.push_back('&');
+    else if (entity == "lt")
+      result.push_back('<');
+    else if (entity == "gt")
+      result.push_back('>');
+    else if (entity == "quot")
+      result.push_back('"');
+    else if (entity == "apos")
+      result.push_back('\'');
+    else if (!entity.empty() && entity[0] == '#') {
+      // numeric character references, only the ASCII range is translated
+      auto const code = entity.size() > 1 && entity[1] == 'x'
+                            ? std::strtoul(entity.c_str() + 2, nullptr, 16)
+                            : std::strtoul(entity.c_str() + 1, nullptr, 10);
+      if (code < 128)
+        result.push_back(static_cast<char>(code));
+      else
+        result.append(value, i, end - i + 1);
+    } else {
+      result.append(value, i, end - i + 1);
+    }
+    i = end;
+  }
+  return result;
+}
+
+std::string const *
+find_attribute(std::vector<std::pair<std::string, std::string>> const &list,
+               std::string const &key) {
+  for (auto const &entry : list)
+    if (entry.first == key)
+      return &entry.second;
+  return nullptr;
+}
+
+std::uint64_t to_id(std::string const *value) {
+  if (!value)
+    throw std::runtime_error("OSM element is missing an id/ref attribute.");
+  return std::strtoull(value->c_str(), nullptr, 10);
+}
+
+bool is_space(char const c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+} // namespace
+
+std::string const *find_tag(Tags const &tags, std::string const &key) {
+  return find_attribute(tags, key);
+}
+
+OSMXMLParser::OSMXMLParser(std::istream &input) : input(input) {}
+
+bool OSMXMLParser::next_element(Element &element) {
+  // skip text content between elements
+  if (!std::getline(input, buffer, '<'))
+    return false;
+  if (!std::getline(input, buffer, '>'))
+    return false;
+
+  // comments/processing instructions/declarations
+  if (buffer.empty() || buffer[0] == '?' || buffer[0] == '!') {
+    // comments may contain '>', continue until the end of the comment
+    while (buffer.compare(0, 3, "!--") == 0 &&
+           (buffer.size() < 5 ||
+            buffer.compare(buffer.size() - 2, 2, "--") != 0)) {
+      std::string remainder;
+      if (!std::getline(input, remainder, '>'))
+        return false;
+      buffer += '>' + remainder;
+    }
+    element.name.clear();
+    element.attributes.clear();
+    element.closing = element.self_closing = false;
+    return true;
+  }
+
+  element.closing = buffer[0] == '/';
+  element.self_closing = buffer.back() == '/';
+  auto const begin = element.closing ? 1 : 0;
+  auto const end = element.self_closing ? buffer.size() - 1 : buffer.size();
+
+  auto position = static_cast<std::size_t>(begin);
+  while (position < end && !is_space(buffer[position]))
+    ++position;
+  element.name.assign(buffer, begin, position - begin);
+
+  // attributes of the form key="value" or key='value'
+  element.attributes.clear();
+  while (position < end) {
+    while (position < end && is_space(buffer[position]))
+      ++position;
+    auto const equals = buffer.find('=', position);
+    if (equals == std::string::npos || equals >= end)
+      break;
+    auto key_end = equals;
+    while (key_end > position && is_space(buffer[key_end - 1]))
+      --key_end;
+    auto quote = equals + 1;
+    while (quote < end && is_space(buffer[quote]))
+      ++quote;
+    if (quote >= end)
+      break;
+    auto const closing_quote = buffer.find(buffer[quote], quote + 1);
+    if (closing_quote == std::string::npos)
+      break;
+    element.attributes.emplace_back(
+        buffer.substr(position, key_end - position),
+        unescape(buffer.substr(quote + 1, closing_quote - quote - 1)));
+    position = closing_quote + 1;
+  }
+  return true;
+}
+
+void OSMXMLParser::parse(node_handler on_node, way_handler on_way) {
+  Element element;
+  OSMWay way;
+  bool in_way = false;
+
+  while (next_element(element)) {
+    if (element.name.empty())
+      continue;
+
+    if (element.name == "node" && !element.closing) {
+      auto const lat = find_attribute(element.attributes, "lat");
+      auto const lon = find_attribute(element.attributes, "lon");
+      if (!lat || !lon)
+        continue;
+      OSMNode node;
+      node.id = to_id(find_attribute(element.attributes, "id"));
+      node.coordinate = {
+          geometry::FixedWGSLatitude{
+              geometry::coordinate::to_fixed(std::strtod(lat->c_str(), 0))},
+          geometry::FixedWGSLongitude{
+              geometry::coordinate::to_fixed(std::strtod(lon->c_str(), 0))}};
+      if (on_node)
+        on_node(node);
+    } else if (element.name == "way") {
+      if (element.closing) {
+        if (in_way && on_way)
+          on_way(way);
+        in_way = false;
+      } else {
+        way.id = to_id(find_attribute(element.attributes, "id"));
+        way.nodes.clear();
+        way.tags.clear();
+        in_way = !element.self_closing;
+      }
+    } else if (in_way && element.name == "nd") {
+      way.nodes.push_back(to_id(find_attribute(element.attributes, "ref")));
+    } else if (in_way && element.name == "tag") {
+      auto const key = find_attribute(element.attributes, "k");
+      auto const value = find_attribute(element.attributes, "v");
+      if (key && value)
+        way.tags.emplace_back(*key, *value);
+    }
+  }
+}
+
+} // namespace importer
+} // namespace project_x
@@ -0,0 +1,87 @@
+#include "importer/profile.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace project_x {
+namespace importer {
+
+namespace {
+// a posted speed limit in km/h. Limits are given in km/h unless followed by
+// "mph" or "knots", non-numeric limits (e.g. "none", "DE:urban") and unknown
+// units are ignored. Of multiple limits ("50;30") the first one is used
+std::optional<double> parse_maxspeed(std::string const &value) {
+  char *end = nullptr;
+  auto const limit = std::strtod(value.c_str(), &end);
+  if (end == value.c_str() || !(limit > 0))
+    return {};
+  while (*end == ' ')
+    ++end;
+  auto const unit = [end](char const *name) {
+    return std::strncmp(end, name, std::strlen(name)) == 0;
+  };
+  if (unit("mph"))
+    return limit * 1.609344;
+  if (unit("knots"))
+    return limit * 1.852;
+  if (*end == '\0' || *end == ';' || unit("km/h") || unit("kmh") ||
+      unit("kph"))
+    return limit;
+  return {};
+}
+} // namespace
+
+CarProfile::CarProfile()
+    : highway_speeds({{"motorway", 90},
+                      {"motorway_link", 40},
+                      {"trunk", 80},
+                      {"trunk_link", 35},
+                      {"primary", 50},
+                      {"primary_link", 35},
+                      {"secondary", 45},
+                      {"secondary_link", 30},
+                      {"tertiary", 40},
+                      {"tertiary_link", 30},
+                      {"unclassified", 40},
+                      {"residential", 30},
+                      {"living_street", 10},
+                      {"service", 5}}) {}
+
+std::optional<WaySettings> CarProfile::evaluate(Tags const &tags) const {
+  auto const highway = find_tag(tags, "highway");
+  if (!highway)
+    return {};
+  auto const speed = highway_speeds.find(*highway);
+  if (speed == highway_speeds.end())
+    return {};
+
+  auto const access = find_tag(tags, "access");
+  if (access && (*access == "no" || *access == "private"))
+    return {};
+
+  WaySettings settings{speed->second, true, true, *highway};
+
+  // posted speed limits cap the speed of the road class
+  auto const maxspeed = find_tag(tags, "maxspeed");
+  if (maxspeed) {
+    if (auto const limit = parse_maxspeed(*maxspeed))
+      settings.speed = std::min(settings.speed, *limit);
+  }
+
+  auto const oneway = find_tag(tags, "oneway");
+  auto const junction = find_tag(tags, "junction");
+  if (oneway && (*oneway == "yes" || *oneway == "1" || *oneway == "true")) {
+    settings.backward = false;
+  } else if (oneway && *oneway == "-1") {
+    settings.forward = false;
+  } else if (!oneway && ((junction && *junction == "roundabout") ||
+                         *highway == "motorway")) {
+    // implied oneways
+    settings.backward = false;
+  }
+  return settings;
+}
+
+} // namespace importer
+} // namespace project_x
@@ -0,0 +1,130 @@
+#include "io/crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define PROJECT_X_CRC32C_SSE42
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define PROJECT_X_CRC32C_ARMV8
+#endif
+
+namespace project_x {
+namespace io {
+
+namespace {
+// reflected polynomial of CRC32C
+constexpr std::uint32_t polynomial = 0x82f63b78;
+
+// Tables for slicing-by-8: table[k][b] is the CRC of byte b followed by k zero
+// bytes, which allows processing eight bytes per step
+using SliceTables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+SliceTables make_tables() {
+  SliceTables tables;
+  for (std::uint32_t byte = 0; byte < 256; ++byte) {
+    auto crc = byte;
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+    tables[0][byte] = crc;
+  }
+  for (std::size_t slice = 1; slice < tables.size(); ++slice)
+    for (std::size_t byte = 0; byte < 256; ++byte)
+      tables[slice][byte] = (tables[slice - 1][byte] >> 8) ^
+                            tables[0][tables[slice - 1][byte] & 0xff];
+  return tables;
+}
+
+SliceTables const &tables() {
+  static SliceTables const tables = make_tables();
+  return tables;
+}
+
+std::uint32_t update_portable(std::uint32_t crc, unsigned char const *data,
+                              std::size_t size) {
+  auto const &table = tables();
+  // the 64 bit loads are little endian, as are all targets we build for
+  while (size >= 8) {
+    std::uint64_t block;
+    std::memcpy(&block, data, sizeof(block));
+    block ^= crc;
+    crc = table[7][block & 0xff] ^ table[6][(block >> 8) & 0xff] ^
+          table[5][(block >> 16) & 0xff] ^ table[4][(block >> 24) & 0xff] ^
+          table[3][(block >> 32) & 0xff] ^ table[2][(block >> 40) & 0xff] ^
+          table[1][(block >> 48) & 0xff] ^ table[0][block >> 56];
+    data += 8;
+    size -= 8;
+  }
+  while (size--)
+    crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xff];
+  return crc;
+}
+
+#if defined(PROJECT_X_CRC32C_SSE42)
+__attribute__((target("sse4.2"))) std::uint32_t
+update_hardware(std::uint32_t crc, unsigned char const *data,
+                std::size_t size) {
+  std::uint64_t crc64 = crc;
+  while (size >= 8) {
+    std::uint64_t block;
+    std::memcpy(&block, data, sizeof(block));
+    crc64 = _mm_crc32_u64(crc64, block);
+    data += 8;
+    size -= 8;
+  }
+  crc = static_cast<std::uint32_t>(crc64);
+  while (size--)
+    crc = _mm_crc32_u8(crc, *data++);
+  return crc;
+}
+
+bool has_hardware_support() {
+  static bool const supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+}
+#elif defined(PROJECT_X_CRC32C_ARMV8)
+std::uint32_t update_hardware(std::uint32_t crc, unsigned char const *data,
+                              std::size_t size) {
+  while (size >= 8) {
+    std::uint64_t block;
+    std::memcpy(&block, data, sizeof(block));
+    crc = __crc32cd(crc, block);
+    data += 8;
+    size -= 8;
+  }
+  while (size--)
+    crc = __crc32cb(crc, *data++);
+  return crc;
+}
+
+bool has_hardware_support() { return true; }
+#else
+std::uint32_t update_hardware(std::uint32_t crc, unsigned char const *data,
+                              std::size_t size) {
+  return update_portable(crc, data, size);
+}
+
+bool has_hardware_support() { return false; }
+#endif
+} // namespace
+
+std::uint32_t crc32c(void const *data, std::size_t const size,
+                     std::uint32_t const crc) {
+  auto const bytes = static_cast<unsigned char const *>(data);
+  if (has_hardware_support())
+    return ~update_hardware(~crc, bytes, size);
+  return ~update_portable(~crc, bytes, size);
+}
+
+std::uint32_t crc32c_portable(void const *data, std::size_t const size,
+                              std::uint32_t const crc) {
+  return ~update_portable(~crc, static_cast<unsigned char const *>(data),
+                          size);
+}
+
+bool crc32c_hardware_accelerated() { return has_hardware_support(); }
+
+} // namespace io
+} // namespace project_x
@@ -1,10 +1,14 @@
 #include "io/file.hpp"
+#include "io/crc32c.hpp"
 #include "io/exceptions.hpp"
 #include "log/logger.hpp"
 #include "version.h"
 
 #include <cstdint>
 #include <ios>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace project_x {
 namespace io {
@@ -16,15 +20,42 @@ struct HeaderVersion {
   std::uint32_t patch;
 };
 
+// Versioned files store the flags of their format after the version, so readers
+// can switch to the mode they were written in
+constexpr std::uint32_t format_compressed = 1 << 0;
+// the file ends in a CRC32C of its data, see mode::mNO_CHECKSUM
+constexpr std::uint32_t format_checksummed = 1 << 1;
+constexpr std::uint32_t known_format_flags =
+    format_compressed | format_checksummed;
+
 // Check if a flag is set in the provided mode
 bool is_set(mode::Enum mode, mode::Enum flag) { return (mode & flag) == flag; }
 bool any_of(mode::Enum mode, std::uint32_t flags) {
   return (mode & flags) != 0;
 }
 
+// checksum of a file from an offset to its end, for writers that seeked
+std::uint32_t checksum_from(boost::filesystem::path const &path,
+                            std::uint64_t const offset) {
+  std::ifstream in(path.string(), std::ios::binary);
+  in.seekg(offset);
+  std::vector<char> buffer(1 << 20);
+  std::uint32_t checksum = 0;
+  while (in) {
+    in.read(buffer.data(), buffer.size());
+    checksum = crc32c(buffer.data(), in.gcount(), checksum);
+  }
+  return checksum;
+}
+
 } // namespace detail
 
-File::File(boost::filesystem::path path_, mode::Enum mode) : path(path_) {
+File::File(boost::filesystem::path path_, mode::Enum mode)
+    : path(path_), writing(false), append(false), checksumming(false),
+      checksum(0), data_checksummed(false), data_checksum_running(false),
+      data_checksum(0), data_begin(0), data_end(0), data_position(0),
+      compress_integers(detail::is_set(mode, mode::mCOMPRESSED)),
+      threads(util::default_concurrency()) {
   std::ios_base::openmode file_mode;
 
   if (detail::is_set(mode, mode::mREAD)) {
@@ -44,21 +75,131 @@ File::File(boost::filesystem::path path_, mode::Enum mode) : path(path_) {
     throw std::invalid_argument{"Couldn't open: " + path.string() +
                                 ", Error: " + strerror(errno)};
 
-  if ((detail::is_set(mode, mode::mWRITE) ||
-       detail::is_set(mode, mode::mAPPEND)) &&
-      detail::is_set(mode, mode::mVERSIONED))
+  writing = !detail::is_set(mode, mode::mREAD);
+  append = writing && detail::is_set(mode, mode::mAPPEND);
+  // appended data cannot be followed by a single trailing checksum
+  data_checksummed = detail::is_set(mode, mode::mVERSIONED) &&
+                     !detail::is_set(mode, mode::mNO_CHECKSUM) && !append;
+
+  if (writing && detail::is_set(mode, mode::mVERSIONED)) {
     write_version();
+    data_begin = tell();
+    data_checksum_running = data_checksummed;
+  }
 
-  if (detail::is_set(mode, mode::mREAD) &&
-      detail::is_set(mode, mode::mVERSIONED))
+  if (!writing && detail::is_set(mode, mode::mVERSIONED))
     read_and_check_version(mode);
 }
 
-void File::close() { stream.close(); }
+File::~File() {
+  // destructors must not throw, corrupted data is only reported by close()
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+void File::close() {
+  if (!stream.is_open())
+    return;
+  if (writing && data_checksummed) {
+    stream.flush();
+    if (!data_checksum_running)
+      data_checksum = detail::checksum_from(path, data_begin);
+    stream.seekp(0, std::ios::end);
+    stream.write(reinterpret_cast<char const *>(&data_checksum),
+                 sizeof(data_checksum));
+  }
+  stream.close();
+}
+
+void File::write_bytes(char const *data, std::size_t const size) {
+  stream.write(data, size);
+  if (checksumming)
+    checksum = crc32c(data, size, checksum);
+  if (data_checksum_running)
+    data_checksum = crc32c(data, size, data_checksum);
+}
+
+void File::read_bytes(char *data, std::size_t const size) {
+  if (data_checksum_running && size > data_end - data_position)
+    throw ChecksumMismatch{"Unexpected end of data in: " + path.string() +
+                           ", the file is truncated or corrupted."};
+  stream.read(data, size);
+  if (checksumming)
+    checksum = crc32c(data, stream.gcount(), checksum);
+  if (data_checksum_running) {
+    data_checksum = crc32c(data, stream.gcount(), data_checksum);
+    data_position += stream.gcount();
+    if (data_position == data_end)
+      verify_data();
+  }
+}
+
+void File::verify_data() {
+  data_checksum_running = false;
+  std::uint32_t expected = 0;
+  stream.read(reinterpret_cast<char *>(&expected), sizeof(expected));
+  if (!stream || expected != data_checksum)
+    throw ChecksumMismatch{"Checksum mismatch in: " + path.string() +
+                           ", the file is corrupted."};
+}
+
+bool File::appending() const { return append; }
+
+void File::set_threads(std::size_t const threads_) {
+  threads = std::max<std::size_t>(1, threads_);
+}
+
+bool File::compressed() const { return compress_integers; }
+
+void File::start_checksum() {
+  checksumming = true;
+  checksum = 0;
+}
+
+std::uint32_t File::stop_checksum() {
+  checksumming = false;
+  return checksum;
+}
+
+bool File::checksumming_enabled() const { return checksumming; }
+
+std::uint64_t File::tell() {
+  // input and output share the position of the underlying file buffer
+  auto const position = stream.rdbuf()->pubseekoff(0, std::ios::cur);
+  if (position == std::streampos(-1))
+    throw std::runtime_error{"Failed to query position in: " + path.string()};
+  return static_cast<std::uint64_t>(position);
+}
+
+void File::seek(std::uint64_t const position) {
+  data_checksum_running = false;
+  stream.clear();
+  if (stream.rdbuf()->pubseekpos(position) == std::streampos(-1))
+    throw std::runtime_error{"Failed to seek to " + std::to_string(position) +
+                             " in: " + path.string()};
+}
+
+std::uint64_t File::size() {
+  auto const position = tell();
+  auto const end = stream.rdbuf()->pubseekoff(0, std::ios::end);
+  // returning to the same position keeps running checksums intact
+  auto const running = data_checksum_running;
+  seek(position);
+  data_checksum_running = running;
+  if (end == std::streampos(-1))
+    throw std::runtime_error{"Failed to query size of: " + path.string()};
+  return static_cast<std::uint64_t>(end);
+}
 
 void File::write_version() {
   detail::HeaderVersion version = {version_major, version_minor, version_patch};
   write_pod(version);
+  std::uint32_t const flags =
+      (compress_integers ? detail::format_compressed : 0) |
+      (data_checksummed ? detail::format_checksummed : 0);
+  write_pod(flags);
 }
 
 void File::read_and_check_version(mode::Enum mode) {
@@ -100,6 +241,30 @@ void File::read_and_check_version(mode::Enum mode) {
                           std::to_string(version_patch);
     log_or_throw(std::move(message));
   }
+
+  std::uint32_t flags = 0;
+  read_pod(flags);
+  if (flags & ~detail::known_format_flags)
+    throw InvalidFormat{"Unknown format flags in: " + path.string()};
+  auto const file_compressed = (flags & detail::format_compressed) != 0;
+  if (compress_integers && !file_compressed)
+    throw InvalidFormat{path.string() + " is not compressed, but was opened "
+                                        "in mode::mCOMPRESSED."};
+  compress_integers = file_compressed;
+
+  if ((flags & detail::format_checksummed) &&
+      !detail::is_set(mode, mode::mNO_CHECKSUM)) {
+    data_begin = tell();
+    auto const file_size = size();
+    if (file_size < data_begin + sizeof(std::uint32_t))
+      throw ChecksumMismatch{"Missing checksum in: " + path.string() +
+                             ", the file is truncated."};
+    data_end = file_size - sizeof(std::uint32_t);
+    data_position = data_begin;
+    data_checksum_running = true;
+    if (data_position == data_end)
+      verify_data();
+  }
 }
 
 } // namespace io
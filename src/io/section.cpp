@@ -0,0 +1,230 @@
+#include "io/section.hpp"
+#include "io/exceptions.hpp"
+#include "util/parallel.hpp"
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace project_x {
+namespace io {
+
+namespace {
+// "XSECTION" as little endian number, marks the end of a sectioned file
+constexpr std::uint64_t section_magic = 0x4e4f495443455358ull;
+
+struct Footer {
+  std::uint64_t toc_offset;
+  std::uint32_t toc_checksum;
+  std::uint32_t reserved;
+  std::uint64_t magic;
+};
+
+// block size used for verifying sections
+constexpr std::size_t verification_block_size = 1 << 20;
+} // namespace
+
+SectionWriter::SectionWriter(boost::filesystem::path path,
+                             std::uint64_t const alignment,
+                             Encoding const encoding)
+    : file(std::move(path),
+           mode::mWRITE | mode::mBINARY | mode::mVERSIONED |
+               mode::mNO_CHECKSUM |
+               (encoding == Encoding::BLOCK_PACKED ? mode::mCOMPRESSED : 0)),
+      alignment(std::max<std::uint64_t>(1, alignment)), encoding(encoding),
+      in_section(false), finished(false) {}
+
+SectionWriter::~SectionWriter() {
+  // destructors must not throw, a failing TOC results in an unreadable file
+  try {
+    if (!finished)
+      finish();
+  } catch (...) {
+  }
+}
+
+File &SectionWriter::begin(std::string const &name) {
+  if (finished || in_section)
+    throw std::logic_error("Cannot begin section " + name +
+                           " while another section is written or after the "
+                           "file has been finished.");
+  for (auto const &section : sections)
+    if (section.name == name)
+      throw std::invalid_argument("Duplicated section: " + name);
+
+  // pad to the alignment of the section
+  auto const position = file.tell();
+  auto const padding = (alignment - position % alignment) % alignment;
+  for (std::uint64_t i = 0; i < padding; ++i)
+    file.write_pod(char(0));
+
+  sections.push_back({name, position + padding, 0, 0, encoding});
+  in_section = true;
+  file.start_checksum();
+  return file;
+}
+
+void SectionWriter::end() {
+  if (!in_section)
+    throw std::logic_error("No section has been started.");
+  sections.back().checksum = file.stop_checksum();
+  sections.back().size = file.tell() - sections.back().offset;
+  in_section = false;
+}
+
+void SectionWriter::finish() {
+  if (in_section)
+    end();
+  if (finished)
+    return;
+  finished = true;
+
+  Footer footer = {file.tell(), 0, 0, section_magic};
+  file.start_checksum();
+  file.write_pod(static_cast<std::uint64_t>(sections.size()));
+  for (auto const &section : sections) {
+    file.write_pod_container(section.name);
+    file.write_pod(section.offset);
+    file.write_pod(section.size);
+    file.write_pod(section.checksum);
+    file.write_pod(section.encoding);
+  }
+  footer.toc_checksum = file.stop_checksum();
+  file.write_pod(footer);
+  file.close();
+}
+
+SectionReader::SectionReader(boost::filesystem::path path_,
+                             mode::Enum const mode,
+                             bool const verify_checksums)
+    : path(std::move(path_)), verify_checksums(verify_checksums),
+      threads(util::default_concurrency()) {
+  File file(path, mode::mREAD | mode::mBINARY | mode::mVERSIONED | mode);
+  auto const header_size = file.tell();
+  auto const file_size = file.size();
+  if (file_size < header_size + sizeof(Footer))
+    throw InvalidFormat("Not a sectioned file: " + path.string());
+
+  Footer footer;
+  file.seek(file_size - sizeof(Footer));
+  file.read_pod(footer);
+  if (footer.magic != section_magic || footer.toc_offset < header_size ||
+      footer.toc_offset > file_size - sizeof(Footer))
+    throw InvalidFormat("Not a sectioned file: " + path.string());
+
+  file.seek(footer.toc_offset);
+  file.start_checksum();
+  std::uint64_t count = 0;
+  file.read_pod(count);
+  // every entry requires at least three 64 bit numbers
+  if (count > (file_size - footer.toc_offset) / (3 * sizeof(std::uint64_t)))
+    throw InvalidFormat("Corrupted table of contents in: " + path.string());
+
+  entries.resize(count);
+  for (auto &entry : entries) {
+    file.read_pod_container(entry.name);
+    file.read_pod(entry.offset);
+    file.read_pod(entry.size);
+    file.read_pod(entry.checksum);
+    file.read_pod(entry.encoding);
+    if (entry.offset < header_size || entry.offset > footer.toc_offset ||
+        entry.size > footer.toc_offset - entry.offset ||
+        entry.encoding > Encoding::BLOCK_PACKED)
+      throw InvalidFormat("Corrupted table of contents in: " + path.string());
+  }
+  if (file.stop_checksum() != footer.toc_checksum)
+    throw ChecksumMismatch("Corrupted table of contents in: " +
+                           path.string());
+}
+
+bool SectionReader::contains(std::string const &name) const {
+  return std::any_of(entries.begin(), entries.end(),
+                     [&name](auto const &entry) { return entry.name == name; });
+}
+
+SectionEntry const &SectionReader::section(std::string const &name) const {
+  auto const entry =
+      std::find_if(entries.begin(), entries.end(),
+                   [&name](auto const &entry) { return entry.name == name; });
+  if (entry == entries.end())
+    throw std::out_of_range("No section " + name + " in " + path.string());
+  return *entry;
+}
+
+std::vector<SectionEntry> const &SectionReader::sections() const {
+  return entries;
+}
+
+File SectionReader::open(std::string const &name) const {
+  auto const &entry = section(name);
+  File file(path, mode::mREAD | mode::mBINARY |
+                      (entry.encoding == Encoding::BLOCK_PACKED
+                           ? mode::mCOMPRESSED
+                           : 0));
+  file.set_threads(threads);
+  file.seek(entry.offset);
+  return file;
+}
+
+void SectionReader::set_threads(std::size_t const threads_) {
+  threads = std::max<std::size_t>(1, threads_);
+}
+
+void SectionReader::prefetch() const {
+#if defined(__unix__) && defined(POSIX_FADV_WILLNEED)
+  auto const descriptor = ::open(path.c_str(), O_RDONLY);
+  if (descriptor < 0)
+    return;
+  for (auto const &entry : entries)
+    ::posix_fadvise(descriptor, entry.offset, entry.size,
+                    POSIX_FADV_WILLNEED);
+  ::close(descriptor);
+#endif
+}
+
+void SectionReader::check(SectionEntry const &entry,
+                          std::uint64_t const bytes_read,
+                          std::uint32_t const checksum) const {
+  if (bytes_read != entry.size || checksum != entry.checksum)
+    throw ChecksumMismatch("Section " + entry.name + " of " + path.string() +
+                           " is corrupted.");
+}
+
+bool SectionReader::verify(std::string const &name) const {
+  auto const &entry = section(name);
+  auto file = open(name);
+  file.start_checksum();
+
+  std::vector<char> block(
+      std::min<std::uint64_t>(entry.size, verification_block_size));
+  for (std::uint64_t remaining = entry.size; remaining > 0;) {
+    auto const size = std::min<std::uint64_t>(remaining, block.size());
+    file.read_bytes(block.data(), size);
+    remaining -= size;
+  }
+  return file.stop_checksum() == entry.checksum &&
+         file.tell() - entry.offset == entry.size;
+}
+
+void SectionReader::verify_all(std::size_t const threads) const {
+  // sections are verified independently, every chunk reports the first
+  // corrupted section it finds
+  util::parallel_for(
+      entries.size(),
+      [this](std::size_t const begin, std::size_t const end, std::size_t) {
+        for (auto index = begin; index < end; ++index)
+          if (!verify(entries[index].name))
+            throw ChecksumMismatch("Section " + entries[index].name + " of " +
+                                   path.string() + " is corrupted.");
+      },
+      threads);
+}
+
+} // namespace io
+} // namespace project_x
@@ -0,0 +1,365 @@
+#include "spatial/grid_index.hpp"
+#include "geometry/constants.hpp"
+#include "geometry/distance.hpp"
+#include "io/exceptions.hpp"
+#include "log/logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace project_x {
+namespace spatial {
+
+namespace {
+const constexpr double degree_to_rad = 0.017453292519943295769236907684886;
+
+// fixed precision units to radians
+double to_radians(double const units) {
+  return units / geometry::fixed_coordinate_precision * degree_to_rad;
+}
+
+// rounding towards negative infinity, so cells do not span the equator or the
+// prime meridian
+std::int32_t floor_div(std::int32_t const value, std::int32_t const divisor) {
+  auto const quotient = value / divisor;
+  return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+bool by_distance(Candidate const &lhs, Candidate const &rhs) {
+  return std::tie(lhs.distance, lhs.edge) < std::tie(rhs.distance, rhs.edge);
+}
+} // namespace
+
+GridIndex::GridIndex()
+    : cell_size(default_cell_size), min_row(0), max_row(-1), min_column(0),
+      max_column(-1) {}
+
+GridIndex::GridIndex(std::vector<geometry::WGS84FixedCoorinate> coordinates_,
+                     std::vector<IndexedEdge> edges_,
+                     std::size_t const threads, std::int32_t const cell_size_)
+    : GridIndex() {
+  if (cell_size_ <= 0)
+    throw std::invalid_argument("Cell size has to be positive.");
+  cell_size = cell_size_;
+  coordinates = std::move(coordinates_);
+  edges = std::move(edges_);
+  for (auto const &edge : edges)
+    if (edge.source >= coordinates.size() || edge.target >= coordinates.size())
+      throw std::out_of_range("Edge " + std::to_string(edge.edge) +
+                              " references a node without coordinate.");
+
+  // every chunk of edges collects the cells overlapped by the bounding boxes
+  // of its edges, sorted by cell
+  using entry_type = std::pair<cell_type, std::uint64_t>;
+  auto const chunks = std::max<std::size_t>(
+      1, std::min<std::size_t>(threads, edges.size()));
+  std::vector<std::vector<entry_type>> entries(chunks);
+  util::parallel_for(
+      edges.size(),
+      [&](std::size_t const begin, std::size_t const end,
+          std::size_t const chunk) {
+        auto &chunk_entries = entries[chunk];
+        for (auto index = begin; index < end; ++index) {
+          auto const &from = coordinates[edges[index].source];
+          auto const &to = coordinates[edges[index].target];
+          // initializer lists copy the values, the pair of references
+          // returned for two arguments would refer to the temporaries
+          auto const [first_row, last_row] =
+              std::minmax({row_of(from), row_of(to)});
+          auto const [first_column, last_column] =
+              std::minmax({column_of(from), column_of(to)});
+          for (auto row = first_row; row <= last_row; ++row)
+            for (auto column = first_column; column <= last_column; ++column)
+              chunk_entries.emplace_back(cell_of(row, column), index);
+        }
+        std::sort(chunk_entries.begin(), chunk_entries.end());
+      },
+      chunks);
+
+  // merge the sorted chunks pairwise, in parallel within every round
+  std::vector<std::size_t> bounds = {0};
+  std::vector<entry_type> merged;
+  for (auto const &chunk_entries : entries)
+    bounds.push_back(bounds.back() + chunk_entries.size());
+  merged.reserve(bounds.back());
+  for (auto &chunk_entries : entries) {
+    merged.insert(merged.end(), chunk_entries.begin(), chunk_entries.end());
+    std::vector<entry_type>().swap(chunk_entries);
+  }
+  while (bounds.size() > 2) {
+    auto const pairs = (bounds.size() - 1) / 2;
+    util::parallel_for(
+        pairs,
+        [&](std::size_t const begin, std::size_t const end, std::size_t) {
+          for (auto pair = begin; pair < end; ++pair)
+            std::inplace_merge(merged.begin() + bounds[2 * pair],
+                               merged.begin() + bounds[2 * pair + 1],
+                               merged.begin() + bounds[2 * pair + 2]);
+        },
+        threads);
+    std::vector<std::size_t> merged_bounds;
+    for (std::size_t bound = 0; bound < bounds.size(); bound += 2)
+      merged_bounds.push_back(bounds[bound]);
+    if (merged_bounds.back() != bounds.back())
+      merged_bounds.push_back(bounds.back());
+    bounds.swap(merged_bounds);
+  }
+
+  cell_edges.reserve(merged.size());
+  for (auto const &entry : merged) {
+    if (cells.empty() || cells.back() != entry.first) {
+      cells.push_back(entry.first);
+      cell_offsets.push_back(cell_edges.size());
+    }
+    cell_edges.push_back(entry.second);
+  }
+  cell_offsets.push_back(cell_edges.size());
+
+  if (!cells.empty()) {
+    min_row = static_cast<std::int32_t>((cells.front() >> 32) ^ 0x80000000u);
+    max_row = static_cast<std::int32_t>((cells.back() >> 32) ^ 0x80000000u);
+    min_column = std::numeric_limits<std::int32_t>::max();
+    max_column = std::numeric_limits<std::int32_t>::min();
+    for (auto const cell : cells) {
+      auto const column =
+          static_cast<std::int32_t>((cell & 0xffffffffu) ^ 0x80000000u);
+      min_column = std::min(min_column, column);
+      max_column = std::max(max_column, column);
+    }
+  }
+
+  log::Logger logger;
+  logger.message(log::Level::DEBUG,
+                 "Spatial index: " + std::to_string(edges.size()) +
+                     " edges in " + std::to_string(cells.size()) +
+                     " cells, " + std::to_string(cell_edges.size()) +
+                     " references.");
+}
+
+GridIndex::cell_type GridIndex::cell_of(std::int32_t const row,
+                                        std::int32_t const column) const {
+  // flipping the sign bit keeps the order of negative rows/columns
+  return (static_cast<cell_type>(static_cast<std::uint32_t>(row) ^
+                                 0x80000000u)
+          << 32) |
+         (static_cast<std::uint32_t>(column) ^ 0x80000000u);
+}
+
+std::int32_t
+GridIndex::row_of(geometry::WGS84FixedCoorinate const coordinate) const {
+  return floor_div(coordinate.latitude.base(), cell_size);
+}
+
+std::int32_t
+GridIndex::column_of(geometry::WGS84FixedCoorinate const coordinate) const {
+  return floor_div(coordinate.longitude.base(), cell_size);
+}
+
+Candidate GridIndex::snap(geometry::WGS84FixedCoorinate const coordinate,
+                          IndexedEdge const &edge) const {
+  auto const &from = coordinates[edge.source];
+  auto const &to = coordinates[edge.target];
+
+  // project in a local equirectangular frame around the query
+  auto const scale = std::cos(to_radians(coordinate.latitude.base()));
+  auto const x = [scale](geometry::WGS84FixedCoorinate const point) {
+    return scale * point.longitude.base();
+  };
+  auto const y = [](geometry::WGS84FixedCoorinate const point) {
+    return static_cast<double>(point.latitude.base());
+  };
+  auto const dx = x(to) - x(from), dy = y(to) - y(from);
+  auto const squared_length = dx * dx + dy * dy;
+  auto ratio = 0.0;
+  if (squared_length > 0) {
+    auto const dot = (x(coordinate) - x(from)) * dx +
+                     (y(coordinate) - y(from)) * dy;
+    ratio = std::min(1.0, std::max(0.0, dot / squared_length));
+  }
+
+  auto const interpolate = [ratio](std::int32_t const lhs,
+                                   std::int32_t const rhs) {
+    return static_cast<std::int32_t>(std::lround(lhs + ratio * (rhs - lhs)));
+  };
+  geometry::WGS84FixedCoorinate const projected = {
+      geometry::FixedWGSLatitude{
+          interpolate(from.latitude.base(), to.latitude.base())},
+      geometry::FixedWGSLongitude{
+          interpolate(from.longitude.base(), to.longitude.base())}};
+
+  return {edge.edge,
+          edge.source,
+          edge.target,
+          projected,
+          ratio,
+          geometry::haversine_distance(coordinate, projected)};
+}
+
+std::vector<Candidate>
+GridIndex::nearest(geometry::WGS84FixedCoorinate const coordinate,
+                   std::size_t const k, double const max_distance) const {
+  std::vector<Candidate> candidates;
+  if (k == 0 || cells.empty())
+    return candidates;
+
+  auto const row = row_of(coordinate), column = column_of(coordinate);
+  auto const latitude = static_cast<double>(coordinate.latitude.base());
+  auto const longitude = static_cast<double>(coordinate.longitude.base());
+  auto const radius = static_cast<double>(
+      geometry::constants::earth_radius_meters);
+
+  auto const visit = [&](std::int32_t const cell_row,
+                         std::int32_t const first_column,
+                         std::int32_t const last_column) {
+    if (cell_row < min_row || cell_row > max_row)
+      return;
+    auto const first = std::lower_bound(
+        cells.begin(), cells.end(),
+        cell_of(cell_row, std::max(first_column, min_column)));
+    auto const last = std::upper_bound(
+        first, cells.end(),
+        cell_of(cell_row, std::min(last_column, max_column)));
+    for (auto cell = first; cell != last; ++cell) {
+      auto const index = std::distance(cells.begin(), cell);
+      for (auto reference = cell_offsets[index];
+           reference < cell_offsets[index + 1]; ++reference) {
+        auto candidate = snap(coordinate, edges[cell_edges[reference]]);
+        if (candidate.distance <= max_distance)
+          candidates.push_back(candidate);
+      }
+    }
+  };
+
+  for (std::int64_t ring = 0;; ++ring) {
+    auto const ring32 = static_cast<std::int32_t>(ring);
+    if (ring == 0) {
+      visit(row, column, column);
+    } else {
+      visit(row - ring32, column - ring32, column + ring32);
+      visit(row + ring32, column - ring32, column + ring32);
+      for (auto cell_row = row - ring32 + 1; cell_row < row + ring32;
+           ++cell_row) {
+        visit(cell_row, column - ring32, column - ring32);
+        visit(cell_row, column + ring32, column + ring32);
+      }
+    }
+
+    // edges are referenced by multiple cells, duplicates are adjacent
+    std::sort(candidates.begin(), candidates.end(), by_distance);
+    candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                 [](auto const &lhs, auto const &rhs) {
+                                   return lhs.edge == rhs.edge;
+                                 }),
+                     candidates.end());
+    if (candidates.size() > k)
+      candidates.resize(k);
+
+    if (row - ring <= min_row && row + ring >= max_row &&
+        column - ring <= min_column && column + ring >= max_column)
+      break;
+
+    // Lower bound of the distance to all cells outside of the ring. Cells
+    // outside of the rows are separated by their latitude. Within the rows,
+    // the longitude difference is bounded via the largest latitude covered.
+    auto const latitude_gap =
+        std::min(latitude - (row - ring) * cell_size,
+                 (row + ring + 1) * static_cast<double>(cell_size) - latitude);
+    auto const longitude_gap = std::min(
+        longitude - (column - ring) * cell_size,
+        (column + ring + 1) * static_cast<double>(cell_size) - longitude);
+    auto const band_latitude =
+        std::min(90.0 * geometry::fixed_coordinate_precision,
+                 std::abs(latitude) + (ring + 1) * cell_size);
+    auto const cosines = std::max(0.0, std::cos(to_radians(latitude)) *
+                                           std::cos(to_radians(band_latitude)));
+    auto const half_angle = std::min(
+        1.0, std::sqrt(cosines) * std::sin(to_radians(longitude_gap) / 2));
+    auto const bound = std::min(radius * to_radians(latitude_gap),
+                                2 * radius * std::asin(half_angle));
+    if (bound > max_distance ||
+        (candidates.size() == k && candidates.back().distance <= bound))
+      break;
+  }
+  return candidates;
+}
+
+std::vector<std::vector<Candidate>> GridIndex::nearest(
+    std::vector<geometry::WGS84FixedCoorinate> const &coordinates,
+    std::size_t const k, double const max_distance,
+    std::size_t const threads) const {
+  std::vector<std::vector<Candidate>> results(coordinates.size());
+  util::parallel_for(
+      coordinates.size(),
+      [&](std::size_t const begin, std::size_t const end, std::size_t) {
+        for (auto query = begin; query < end; ++query)
+          results[query] = nearest(coordinates[query], k, max_distance);
+      },
+      threads);
+  return results;
+}
+
+std::size_t GridIndex::number_of_edges() const { return edges.size(); }
+
+std::size_t GridIndex::number_of_cells() const { return cells.size(); }
+
+void GridIndex::serialise(io::File &file) const {
+  file.write_pod(cell_size);
+  file.write_pod(min_row);
+  file.write_pod(max_row);
+  file.write_pod(min_column);
+  file.write_pod(max_column);
+  file.write_container(coordinates);
+  file.write_container(edges);
+  file.write_container(cells);
+  file.write_container(cell_offsets);
+  file.write_container(cell_edges);
+}
+
+void GridIndex::deserialise(io::File &file) {
+  file.read_pod(cell_size);
+  file.read_pod(min_row);
+  file.read_pod(max_row);
+  file.read_pod(min_column);
+  file.read_pod(max_column);
+  file.read_container(coordinates);
+  file.read_container(edges);
+  file.read_container(cells);
+  file.read_container(cell_offsets);
+  file.read_container(cell_edges);
+}
+
+void GridIndex::serialise(io::SectionWriter &writer) const {
+  writer.write("spatial_index.grid",
+               std::vector<std::int32_t>{cell_size, min_row, max_row,
+                                         min_column, max_column});
+  writer.write("spatial_index.coordinates", coordinates);
+  writer.write("spatial_index.edges", edges);
+  writer.write("spatial_index.cells", cells);
+  writer.write("spatial_index.cell_offsets", cell_offsets);
+  writer.write("spatial_index.cell_edges", cell_edges);
+}
+
+void GridIndex::deserialise(io::SectionReader const &reader) {
+  std::vector<std::int32_t> grid;
+  reader.read("spatial_index.grid", grid);
+  if (grid.size() != 5)
+    throw io::InvalidFormat("Corrupted spatial index.");
+  cell_size = grid[0];
+  min_row = grid[1];
+  max_row = grid[2];
+  min_column = grid[3];
+  max_column = grid[4];
+  reader.read("spatial_index.coordinates", coordinates);
+  reader.read("spatial_index.edges", edges);
+  reader.read("spatial_index.cells", cells);
+  reader.read("spatial_index.cell_offsets", cell_offsets);
+  reader.read("spatial_index.cell_edges", cell_edges);
+}
+
+} // namespace spatial
+} // namespace project_x
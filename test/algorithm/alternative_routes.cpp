@@ -0,0 +1,158 @@
+#include "algorithm/alternative_routes.hpp"
+#include "algorithm/dijkstra.hpp"
+#include "fixture/graph.hpp"
+#include "graph/decorator.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+
+#include <random>
+#include <set>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE AlternativeRoutes
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+using test::DecoratedGraph;
+using test::Edge;
+using test::make_graph;
+
+namespace {
+std::vector<EdgeID> edge_ids(route::Route<int> const &route) {
+  std::vector<EdgeID> result;
+  for (auto const &segment : route.segments)
+    result.push_back(segment.edge_id);
+  return result;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(two_corridors) {
+  //     1 - (5) - 2
+  //   (3)         (3)
+  //   0             5
+  //   (4)         (4)
+  //     3 - (4) - 4
+  std::vector<Edge> edges{{0, 1, 3}, {1, 2, 5}, {2, 5, 3},
+                          {0, 3, 4}, {3, 4, 4}, {4, 5, 4}};
+  auto const graph = make_graph(6, edges);
+
+  algorithm::AlternativeRoutes<DecoratedGraph> alternatives(graph);
+  auto const routes = alternatives({0, 0}, {5, 0});
+  BOOST_REQUIRE_EQUAL(routes.size(), 2);
+  BOOST_CHECK_EQUAL(routes[0].segments.back().weight_at_end, 11);
+  BOOST_CHECK_EQUAL(routes[1].segments.back().weight_at_end, 12);
+  BOOST_CHECK_EQUAL(edges[routes[1].segments.front().edge_id].target, 3);
+
+  // the lower corridor is too long
+  algorithm::AlternativeParameters parameters;
+  parameters.max_stretch = 0.05;
+  algorithm::AlternativeRoutes<DecoratedGraph> strict(graph, parameters);
+  BOOST_CHECK_EQUAL(strict({0, 0}, {5, 0}).size(), 1);
+
+  // no route at all
+  BOOST_CHECK(alternatives({5, 0}, {0, 0}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(sharing) {
+  // both routes share the long edge 0 -> 1
+  //               2
+  //             (1) (1)
+  //  0 - (10) - 1     4
+  //             (1) (2)
+  //               3
+  std::vector<Edge> edges{
+      {0, 1, 10}, {1, 2, 1}, {2, 4, 1}, {1, 3, 1}, {3, 4, 2}};
+  auto const graph = make_graph(5, edges);
+
+  algorithm::AlternativeRoutes<DecoratedGraph> alternatives(graph);
+  BOOST_CHECK_EQUAL(alternatives({0, 0}, {4, 0}).size(), 1);
+
+  algorithm::AlternativeParameters parameters;
+  parameters.max_sharing = 0.9;
+  parameters.min_plateau = 0;
+  algorithm::AlternativeRoutes<DecoratedGraph> shared(graph, parameters);
+  auto const routes = shared({0, 0}, {4, 0});
+  BOOST_REQUIRE_EQUAL(routes.size(), 2);
+  BOOST_CHECK_EQUAL(routes[1].segments.back().weight_at_end, 13);
+
+  // without a limit on sharing, the shortest route is not repeated
+  parameters.max_sharing = 1.0;
+  algorithm::AlternativeRoutes<DecoratedGraph> unlimited(graph, parameters);
+  auto const unlimited_routes = unlimited({0, 0}, {4, 0});
+  BOOST_REQUIRE_EQUAL(unlimited_routes.size(), 2);
+  BOOST_CHECK(edge_ids(unlimited_routes[0]) != edge_ids(unlimited_routes[1]));
+  BOOST_CHECK_EQUAL(unlimited_routes[1].segments.back().weight_at_end, 13);
+}
+
+BOOST_AUTO_TEST_CASE(valid_routes) {
+  std::mt19937 generator(42);
+  NodeID const width = 20;
+  auto edges = test::grid_edges(generator, width, 5, 10);
+  auto const graph = make_graph(width * width, edges);
+
+  algorithm::AlternativeParameters parameters;
+  parameters.max_routes = 4;
+  algorithm::AlternativeRoutes<DecoratedGraph> alternatives(graph, parameters);
+  algorithm::Dijkstra<DecoratedGraph> dijkstra(graph);
+
+  std::uniform_int_distribution<NodeID> node(0, width * width - 1);
+  std::size_t found_alternatives = 0;
+  for (int query = 0; query < 30; ++query) {
+    algorithm::Location<int> const from = {node(generator), 2};
+    algorithm::Location<int> const to = {node(generator), 0};
+    if (from.node == to.node)
+      continue;
+    auto const routes = alternatives(from, to);
+    BOOST_REQUIRE(!routes.empty());
+    found_alternatives += routes.size() - 1;
+    BOOST_CHECK_LE(routes.size(), parameters.max_routes);
+
+    auto const shortest = dijkstra(from, to);
+    BOOST_CHECK_EQUAL(routes[0].segments.back().weight_at_end,
+                      shortest.segments.back().weight_at_end);
+
+    std::set<std::vector<EdgeID>> distinct;
+    for (auto const &route : routes) {
+      BOOST_CHECK(distinct.insert(edge_ids(route)).second);
+      BOOST_CHECK_LE(route.segments.back().weight_at_end,
+                     routes[0].segments.back().weight_at_end * 1.25);
+
+      // connected, simple paths from the source to the target
+      std::set<NodeID> visited = {from.node};
+      auto at = from.node;
+      auto weight = from.offset;
+      for (auto const &segment : route.segments) {
+        auto const &edge = edges[segment.edge_id];
+        BOOST_CHECK_EQUAL(edge.source, at);
+        BOOST_CHECK(visited.insert(edge.target).second);
+        weight += edge.weight;
+        BOOST_CHECK_EQUAL(segment.weight_at_end, weight);
+        at = edge.target;
+      }
+      BOOST_CHECK_EQUAL(at, to.node);
+    }
+  }
+  BOOST_CHECK_GT(found_alternatives, 0);
+}
+
+BOOST_AUTO_TEST_CASE(routing_graph) {
+  struct RoutingEdge {
+    NodeID source, target;
+    graph::WeightTimeDistance cost;
+  };
+  std::vector<RoutingEdge> edges{{0, 1, {3, 3, 30}}, {1, 2, {5, 5, 50}},
+                                 {2, 5, {3, 3, 30}}, {0, 3, {4, 4, 40}},
+                                 {3, 4, {4, 4, 40}}, {4, 5, {4, 4, 40}}};
+  auto const graph = make_graph<graph::RoutingGraph>(
+      6, edges, [](auto const &edge) { return edge.cost; });
+
+  algorithm::AlternativeRoutes<graph::RoutingGraph> alternatives(graph);
+  auto const routes = alternatives({0, {0, 0, 0}}, {5, {0, 0, 0}});
+  BOOST_REQUIRE_EQUAL(routes.size(), 2);
+  BOOST_CHECK_EQUAL(routes[0].segments.back().weight_at_end.distance, 110);
+  BOOST_CHECK_EQUAL(routes[1].segments.back().weight_at_end.distance, 120);
+}
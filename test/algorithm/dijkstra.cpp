@@ -74,3 +74,35 @@ BOOST_AUTO_TEST_CASE(reach_first_with_high_weight_multi_source) {
   auto no_route = dijkstra(sources, targets);
   BOOST_CHECK(no_route.segments.empty());
 }
+
+BOOST_AUTO_TEST_CASE(segment_weights) {
+  //   (2)- - - 2
+  //  /         |
+  //  |        (5)
+  //  |         |
+  //  0- (10) - 1 - (1) -> 3
+  std::vector<Edge> edges{{0, 1, 10}, {0, 2, 2}, {2, 1, 5}, {1, 3, 1}};
+  DecoratedGraph graph =
+      graph::ForwardStarFactory::produce_directed_from_edges(4, edges);
+  graph::DecoratorFactory decorator_factory;
+  decorator_factory.decorate<DecoratedGraph>(
+      graph, edges, [](auto const &edge) { return edge.weight; });
+
+  algorithm::Dijkstra<DecoratedGraph> dijkstra(graph);
+  route::Route<int> route;
+  BOOST_REQUIRE(dijkstra({0, 3}, {3, 0}, route));
+  std::vector<int> weights;
+  for (auto const &segment : route.segments)
+    weights.push_back(segment.weight_at_end);
+  std::vector<int> const expected = {5, 10, 11};
+  BOOST_CHECK_EQUAL_COLLECTIONS(weights.begin(), weights.end(),
+                                expected.begin(), expected.end());
+
+  // the route is reused, and emptied without a path
+  auto const capacity = route.segments.capacity();
+  BOOST_REQUIRE(dijkstra({2, 0}, {3, 0}, route));
+  BOOST_CHECK_EQUAL(route.segments.size(), 2);
+  BOOST_CHECK_EQUAL(route.segments.capacity(), capacity);
+  BOOST_CHECK(!dijkstra({3, 0}, {0, 0}, route));
+  BOOST_CHECK(route.segments.empty());
+}
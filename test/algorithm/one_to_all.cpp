@@ -0,0 +1,122 @@
+#include "algorithm/one_to_all.hpp"
+#include "fixture/graph.hpp"
+#include "graph/decorator.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/id.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE OneToAll
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+using test::DecoratedGraph;
+using test::Edge;
+using test::make_graph;
+
+BOOST_AUTO_TEST_CASE(bounded_search) {
+  //   (2)- - - 2
+  //  /         |
+  //  |        (5)
+  //  |         |
+  //  0- (10) - 1 <- (4) - 3
+  std::vector<Edge> edges{{0, 1, 10}, {0, 2, 2}, {2, 1, 5}, {3, 1, 4}};
+  auto const graph = make_graph(4, edges);
+  algorithm::OneToAll<DecoratedGraph> search(graph);
+
+  auto const all = search({0, 0}, 100);
+  BOOST_CHECK_EQUAL(all.size(), 3);
+  std::vector<NodeID> const nodes = {0, 2, 1};
+  std::vector<int> const weights = {0, 2, 7};
+  BOOST_CHECK_EQUAL_COLLECTIONS(all.nodes.begin(), all.nodes.end(),
+                                nodes.begin(), nodes.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(all.weights.begin(), all.weights.end(),
+                                weights.begin(), weights.end());
+
+  // the budget is inclusive
+  BOOST_CHECK_EQUAL(search({0, 0}, 7).size(), 3);
+  BOOST_CHECK_EQUAL(search({0, 0}, 6).size(), 2);
+  // offsets count towards the budget
+  BOOST_CHECK_EQUAL(search({0, 5}, 6).size(), 1);
+  BOOST_CHECK(search({0, 7}, 6).empty());
+}
+
+BOOST_AUTO_TEST_CASE(catchment) {
+  // a line 0 - 1 - 2 - 3 - 4 in both directions
+  std::vector<Edge> edges;
+  for (NodeID node = 0; node < 4; ++node) {
+    edges.push_back({node, node + 1, 1});
+    edges.push_back({node + 1, node, 1});
+  }
+  auto const graph = make_graph(5, edges);
+  algorithm::OneToAll<DecoratedGraph> search(graph);
+
+  // the second location is closer to 3 and 4 than the first one
+  auto const isochrone = search({{0, 0}, {4, 1}, {4, 2}}, 10);
+  BOOST_REQUIRE_EQUAL(isochrone.size(), 5);
+  for (std::size_t i = 0; i < isochrone.size(); ++i) {
+    auto const node = isochrone.nodes[i];
+    BOOST_CHECK_EQUAL(isochrone.origins[i], node <= 2 ? 0 : 1);
+    BOOST_CHECK_EQUAL(isochrone.weights[i], node <= 2 ? node : 5 - node);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(matches_bellman_ford) {
+  std::mt19937 generator(42);
+  std::size_t const number_of_nodes = 300;
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  std::uniform_int_distribution<int> weight(0, 20);
+  std::vector<Edge> edges;
+  for (int edge = 0; edge < 1200; ++edge)
+    edges.push_back({node(generator), node(generator), weight(generator)});
+  auto const graph = make_graph(number_of_nodes, edges);
+
+  algorithm::OneToAll<DecoratedGraph> search(graph);
+  for (int budget : {0, 10, 40, 1000}) {
+    std::vector<algorithm::Location<int>> const from = {
+        {node(generator), 0}, {node(generator), 3}};
+    auto const expected = test::bellman_ford(number_of_nodes, edges, from);
+
+    std::vector<int> found(number_of_nodes, -1);
+    int last_weight = 0;
+    search.search(from, budget,
+                  [&](NodeID const node, int const weight, std::uint32_t) {
+                    BOOST_CHECK_EQUAL(found[node], -1);
+                    BOOST_CHECK_LE(last_weight, weight);
+                    found[node] = weight;
+                    last_weight = weight;
+                  });
+    for (NodeID node = 0; node < number_of_nodes; ++node)
+      BOOST_CHECK_EQUAL(found[node],
+                        expected[node] <= budget ? expected[node] : -1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_isochrones) {
+  std::mt19937 generator(7);
+  std::size_t const number_of_nodes = 200;
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  std::uniform_int_distribution<int> weight(1, 10);
+  std::vector<Edge> edges;
+  for (int edge = 0; edge < 800; ++edge)
+    edges.push_back({node(generator), node(generator), weight(generator)});
+  auto const graph = make_graph(number_of_nodes, edges);
+
+  std::vector<algorithm::Location<int>> sources;
+  for (int source = 0; source < 50; ++source)
+    sources.push_back({node(generator), 0});
+
+  auto const results = algorithm::isochrones(graph, sources, 15, 4);
+  BOOST_REQUIRE_EQUAL(results.size(), sources.size());
+  algorithm::OneToAll<DecoratedGraph> search(graph);
+  for (std::size_t source = 0; source < sources.size(); ++source) {
+    auto const expected = search(sources[source], 15);
+    BOOST_CHECK(results[source].nodes == expected.nodes);
+    BOOST_CHECK(results[source].weights == expected.weights);
+  }
+}
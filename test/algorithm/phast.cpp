@@ -0,0 +1,135 @@
+#include "algorithm/contraction.hpp"
+#include "algorithm/phast.hpp"
+#include "fixture/graph.hpp"
+#include "graph/decorator.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/id.hpp"
+#include "io/file.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE PHAST
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+using test::DecoratedGraph;
+using test::Edge;
+using test::make_graph;
+
+namespace {
+std::vector<Edge> random_edges(std::mt19937 &generator,
+                               std::size_t const number_of_nodes,
+                               std::size_t const number_of_edges) {
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  std::uniform_int_distribution<int> weight(0, 20);
+  std::vector<Edge> edges;
+  for (std::size_t edge = 0; edge < number_of_edges; ++edge)
+    edges.push_back({node(generator), node(generator), weight(generator)});
+  return edges;
+}
+
+void check_ranks(algorithm::Hierarchy<int> const &hierarchy) {
+  for (auto const *graph : {&hierarchy.upward, &hierarchy.downward})
+    for (NodeID node = 0; node < hierarchy.number_of_nodes(); ++node)
+      std::for_each(
+          graph->edges_begin(node), graph->edges_end(node),
+          [node](NodeID const target) { BOOST_CHECK_LT(target, node); });
+  for (NodeID node = 0; node < hierarchy.number_of_nodes(); ++node)
+    BOOST_CHECK_EQUAL(hierarchy.original_id[hierarchy.hierarchy_id[node]],
+                      node);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(small_graph) {
+  //   (2)- - - 2
+  //  /         |
+  //  |        (5)
+  //  |         |
+  //  0- (10) - 1 <- (4) - 3
+  std::vector<Edge> edges{{0, 1, 10}, {0, 2, 2}, {2, 1, 5}, {3, 1, 4}};
+  auto const graph = make_graph(4, edges);
+  auto const hierarchy = algorithm::contract(graph);
+  check_ranks(hierarchy);
+
+  algorithm::PHAST<int> phast(hierarchy);
+  auto const unreached = algorithm::PHAST<int>::unreached;
+  std::vector<int> const from_zero = {0, 7, 2, unreached};
+  auto const weights = phast({0, 0});
+  BOOST_CHECK_EQUAL_COLLECTIONS(weights.begin(), weights.end(),
+                                from_zero.begin(), from_zero.end());
+
+  std::vector<int> const from_three = {unreached, 5, unreached, 1};
+  auto const offset = phast({3, 1});
+  BOOST_CHECK_EQUAL_COLLECTIONS(offset.begin(), offset.end(),
+                                from_three.begin(), from_three.end());
+}
+
+BOOST_AUTO_TEST_CASE(matches_bellman_ford) {
+  std::mt19937 generator(42);
+  std::size_t const number_of_nodes = 300;
+  auto random = random_edges(generator, number_of_nodes, 900);
+  auto grid = test::grid_edges(generator, 15, 1, 10);
+
+  for (auto *edges : {&random, &grid}) {
+    auto const nodes = edges == &random ? number_of_nodes : 15 * 15;
+    auto const graph = make_graph(nodes, *edges);
+    auto const hierarchy = algorithm::contract(graph);
+    check_ranks(hierarchy);
+
+    algorithm::PHAST<int> phast(hierarchy);
+    std::uniform_int_distribution<NodeID> node(0, nodes - 1);
+    for (int source = 0; source < 20; ++source) {
+      algorithm::Location<int> const from = {node(generator), source % 3};
+      auto const weights = phast(from);
+      auto const expected = test::bellman_ford(nodes, *edges, {from});
+      BOOST_CHECK(weights == expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(multiple_sources) {
+  std::mt19937 generator(7);
+  std::size_t const number_of_nodes = 200;
+  auto edges = random_edges(generator, number_of_nodes, 700);
+  auto const graph = make_graph(number_of_nodes, edges);
+  auto const hierarchy = algorithm::contract(graph);
+  algorithm::PHAST<int> phast(hierarchy);
+
+  // more than a single group of lanes, with the last one only partially used
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  std::vector<algorithm::Location<int>> sources;
+  for (int source = 0; source < 19; ++source)
+    sources.push_back({node(generator), source % 4});
+
+  auto const results = phast(sources);
+  BOOST_REQUIRE_EQUAL(results.size(), sources.size());
+  for (std::size_t source = 0; source < sources.size(); ++source)
+    BOOST_CHECK(results[source] == phast(sources[source]));
+}
+
+BOOST_AUTO_TEST_CASE(serialisation) {
+  std::mt19937 generator(3);
+  auto edges = test::grid_edges(generator, 8, 1, 10);
+  auto const graph = make_graph(64, edges);
+  auto const hierarchy = algorithm::contract(graph);
+
+  io::File out_file("hierarchy.ch", io::mode::mWRITE | io::mode::mBINARY |
+                                        io::mode::mVERSIONED);
+  hierarchy.serialise(out_file);
+  out_file.close();
+
+  algorithm::Hierarchy<int> read_hierarchy;
+  io::File in_file("hierarchy.ch",
+                   io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  read_hierarchy.deserialise(in_file);
+
+  BOOST_CHECK(read_hierarchy.original_id == hierarchy.original_id);
+  algorithm::PHAST<int> phast(hierarchy), read_phast(read_hierarchy);
+  for (NodeID node = 0; node < 64; node += 9)
+    BOOST_CHECK(read_phast({node, 0}) == phast({node, 0}));
+}
@@ -0,0 +1,145 @@
+#include "algorithm/dijkstra.hpp"
+#include "algorithm/route_cache.hpp"
+#include "fixture/graph.hpp"
+#include "graph/decorator.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/id.hpp"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE RouteCache
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+using test::DecoratedGraph;
+using test::Edge;
+
+namespace {
+using Cache = algorithm::RouteCache<int>;
+
+// a line 0 - 1 - ... - n-1, in both directions
+DecoratedGraph make_line(std::size_t const number_of_nodes) {
+  std::vector<Edge> edges;
+  for (NodeID node = 0; node + 1 < number_of_nodes; ++node) {
+    edges.push_back({node, node + 1, 1});
+    edges.push_back({node + 1, node, 1});
+  }
+  return test::make_graph(number_of_nodes, edges);
+}
+
+route::Route<int> route_of_length(std::size_t const length) {
+  route::Route<int> route;
+  for (std::size_t segment = 0; segment < length; ++segment)
+    route.segments.push_back({static_cast<int>(segment + 1), segment});
+  return route;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(hits_and_misses) {
+  auto const graph = make_line(10);
+  algorithm::Dijkstra<DecoratedGraph> dijkstra(graph);
+  Cache cache(1 << 20);
+
+  std::size_t computations = 0;
+  auto const query = [&]() {
+    ++computations;
+    return dijkstra({0, 0}, {9, 0});
+  };
+  auto const first = cache.find_or_compute({0, 0}, {9, 0}, query);
+  auto const second = cache.find_or_compute({0, 0}, {9, 0}, query);
+  BOOST_CHECK_EQUAL(computations, 1);
+  BOOST_CHECK_EQUAL(first, second);
+  BOOST_CHECK_EQUAL(second->segments.size(), 9);
+  BOOST_CHECK_EQUAL(second->segments.back().weight_at_end, 9);
+
+  // offsets are part of the key
+  BOOST_CHECK(!cache.find({0, 1}, {9, 0}));
+  BOOST_CHECK(!cache.find({9, 0}, {0, 0}));
+
+  auto const statistics = cache.statistics();
+  BOOST_CHECK_EQUAL(statistics.hits, 1);
+  BOOST_CHECK_EQUAL(statistics.misses, 3);
+  BOOST_CHECK_EQUAL(statistics.entries, 1);
+  BOOST_CHECK_GT(statistics.bytes, 0);
+  BOOST_CHECK_CLOSE(statistics.hit_rate(), 0.25, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(invalidation) {
+  Cache cache(1 << 20);
+  auto const version = cache.version();
+  cache.insert({0, 0}, {1, 0}, route_of_length(3), version);
+  BOOST_REQUIRE(cache.find({0, 0}, {1, 0}));
+
+  // routes keep their contents after being outdated
+  auto const route = cache.find({0, 0}, {1, 0});
+  cache.invalidate();
+  BOOST_CHECK(!cache.find({0, 0}, {1, 0}));
+  BOOST_CHECK_EQUAL(route->segments.size(), 3);
+  BOOST_CHECK_EQUAL(cache.statistics().stale, 1);
+  BOOST_CHECK_EQUAL(cache.statistics().entries, 0);
+
+  // routes computed before the invalidation are not cached anymore
+  cache.insert({0, 0}, {1, 0}, route_of_length(3), version);
+  BOOST_CHECK(!cache.find({0, 0}, {1, 0}));
+  cache.insert({0, 0}, {1, 0}, route_of_length(3), cache.version());
+  BOOST_CHECK(cache.find({0, 0}, {1, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(byte_budget) {
+  std::size_t const budget = 4096;
+  Cache cache(budget, 1);
+  cache.insert({0, 0}, {0, 0}, route_of_length(10), cache.version());
+  for (NodeID node = 1; node < 100; ++node) {
+    cache.insert({node, 0}, {node, 0}, route_of_length(10), cache.version());
+    // the first route stays, as it is used all the time
+    BOOST_CHECK(cache.find({0, 0}, {0, 0}));
+    BOOST_CHECK_LE(cache.statistics().bytes, budget);
+  }
+  auto const statistics = cache.statistics();
+  BOOST_CHECK_GT(statistics.evictions, 0);
+  BOOST_CHECK_LT(statistics.entries, 100);
+  BOOST_CHECK(!cache.find({1, 0}, {1, 0}));
+  BOOST_CHECK(cache.find({99, 0}, {99, 0}));
+
+  // routes larger than a shard are not cached at all
+  cache.insert({0, 0}, {1, 0}, route_of_length(1000), cache.version());
+  BOOST_CHECK(!cache.find({0, 0}, {1, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_queries) {
+  std::size_t const number_of_nodes = 50;
+  auto const graph = make_line(number_of_nodes);
+  Cache cache(1 << 20, 4);
+
+  std::atomic<std::size_t> wrong_routes(0);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; ++thread)
+    threads.emplace_back([&, thread]() {
+      algorithm::Dijkstra<DecoratedGraph> dijkstra(graph);
+      std::mt19937 generator(thread);
+      std::uniform_int_distribution<NodeID> node(0, 9);
+      for (int query = 0; query < 500; ++query) {
+        NodeID const from = node(generator), to = 40 + node(generator);
+        auto const route = cache.find_or_compute(
+            {from, 0}, {to, 0}, [&]() { return dijkstra({from, 0}, {to, 0}); });
+        if (route->segments.size() != to - from ||
+            route->segments.back().weight_at_end != static_cast<int>(to - from))
+          ++wrong_routes;
+        if (query % 100 == 99)
+          cache.invalidate();
+      }
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  BOOST_CHECK_EQUAL(wrong_routes.load(), 0);
+  auto const statistics = cache.statistics();
+  BOOST_CHECK_EQUAL(statistics.hits + statistics.misses, 2000);
+  BOOST_CHECK_GT(statistics.hits, 0);
+}
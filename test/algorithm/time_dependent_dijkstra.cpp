@@ -0,0 +1,158 @@
+#include "algorithm/dijkstra.hpp"
+#include "algorithm/time_dependent_dijkstra.hpp"
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "graph/profile.hpp"
+#include "graph/routing.hpp"
+#include "graph/time_dependent.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE TimeDependentDijkstra
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+std::uint32_t const hour = 60 * 60;
+using StaticLocation = algorithm::Location<graph::WeightTimeDistance>;
+
+struct Edge {
+  NodeID source, target;
+  std::uint32_t time;
+  graph::ProfileID profile;
+};
+
+// sorts the edges, as the factory requires. Weights equal the static times.
+graph::TimeDependentGraph make_graph(std::size_t const number_of_nodes,
+                                     std::vector<Edge> &edges,
+                                     graph::ProfileTable profiles) {
+  graph::TimeDependentGraph graph =
+      graph::ForwardStarFactory::produce_directed_from_edges(number_of_nodes,
+                                                             edges);
+  graph::DecoratorFactory factory;
+  factory.decorate_layers(
+      graph, edges,
+      factory.layer<graph::RoutingGraph>([](auto const &edge) {
+        return graph::WeightTimeDistance{edge.time, edge.time, 0};
+      }),
+      factory.layer<graph::TimeDependentGraph>(
+          [](auto const &edge) { return edge.profile; }));
+  factory.attach_profiles(graph, std::move(profiles));
+  return graph;
+}
+
+std::vector<Edge> random_edges(std::mt19937 &generator,
+                               std::size_t const number_of_nodes,
+                               std::size_t const number_of_edges,
+                               std::size_t const number_of_profiles) {
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  std::uniform_int_distribution<std::uint32_t> time(60, 600);
+  std::uniform_int_distribution<graph::ProfileID> profile(
+      0, number_of_profiles - 1);
+  std::vector<Edge> edges;
+  for (std::size_t edge = 0; edge < number_of_edges; ++edge)
+    edges.push_back({node(generator), node(generator), time(generator),
+                     profile(generator)});
+  return edges;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(rush_hour) {
+  // the highway is fast, unless it is congested in the morning
+  //
+  //  0 - highway (100s) - 1
+  //   \                  /
+  //    -- road (150s) --
+  graph::ProfileTable profiles;
+  std::vector<double> morning(24, 1.0);
+  morning[8] = 3.0;
+  auto const congested = profiles.add(morning);
+  std::vector<Edge> edges{{0, 1, 100, congested},
+                          {0, 2, 75, graph::ProfileTable::free_flow},
+                          {2, 1, 75, graph::ProfileTable::free_flow}};
+  auto const graph = make_graph(3, edges, profiles);
+
+  algorithm::TimeDependentDijkstra<graph::TimeDependentGraph> dijkstra(graph);
+  auto const night = dijkstra({0, 0}, {1, 0}, 3 * hour);
+  BOOST_REQUIRE_EQUAL(night.segments.size(), 1);
+  BOOST_CHECK_EQUAL(night.segments[0].weight_at_end, 3 * hour + 100);
+
+  auto const morning_route = dijkstra({0, 0}, {1, 0}, 8 * hour);
+  BOOST_REQUIRE_EQUAL(morning_route.segments.size(), 2);
+  BOOST_CHECK_EQUAL(morning_route.segments[0].weight_at_end, 8 * hour + 75);
+  BOOST_CHECK_EQUAL(morning_route.segments[1].weight_at_end, 8 * hour + 150);
+
+  // offsets delay the departure
+  auto const offset = dijkstra({0, 10}, {1, 0}, 3 * hour);
+  BOOST_CHECK_EQUAL(offset.segments.back().weight_at_end, 3 * hour + 110);
+  BOOST_CHECK(dijkstra({1, 0}, {0, 0}, 0).segments.empty());
+}
+
+BOOST_AUTO_TEST_CASE(free_flow_matches_static) {
+  std::mt19937 generator(42);
+  std::size_t const number_of_nodes = 300;
+  auto edges = random_edges(generator, number_of_nodes, 1200, 1);
+  auto const graph = make_graph(number_of_nodes, edges, {});
+
+  algorithm::TimeDependentDijkstra<graph::TimeDependentGraph> td(graph);
+  algorithm::Dijkstra<graph::RoutingGraph> dijkstra(graph);
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  for (int query = 0; query < 50; ++query) {
+    NodeID const from = node(generator), to = node(generator);
+    std::uint32_t const departure = 1000 * query;
+    auto const expected = dijkstra(StaticLocation{from, {0, 0, 0}},
+                                   StaticLocation{to, {0, 0, 0}});
+    auto const route = td({from, 0}, {to, 0}, departure);
+    BOOST_REQUIRE_EQUAL(route.segments.empty(), expected.segments.empty());
+    if (!route.segments.empty())
+      BOOST_CHECK_EQUAL(route.segments.back().weight_at_end - departure,
+                        expected.segments.back().weight_at_end.time);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(first_in_first_out) {
+  // gentle profiles keep the FIFO property, leaving later never arrives
+  // earlier
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> factor(1.0, 2.0);
+  graph::ProfileTable profiles;
+  for (int profile = 0; profile < 10; ++profile) {
+    std::vector<double> factors(96);
+    for (auto &value : factors)
+      value = factor(generator);
+    profiles.add(factors);
+  }
+  std::size_t const number_of_nodes = 200;
+  auto edges =
+      random_edges(generator, number_of_nodes, 800, profiles.size());
+  auto const graph = make_graph(number_of_nodes, edges, profiles);
+
+  algorithm::TimeDependentDijkstra<graph::TimeDependentGraph> dijkstra(graph);
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  for (int query = 0; query < 20; ++query) {
+    NodeID const from = node(generator), to = node(generator);
+    std::uint32_t last_arrival = 0;
+    for (std::uint32_t departure = 6 * hour; departure < 10 * hour;
+         departure += 600) {
+      auto const route = dijkstra({from, 0}, {to, 0}, departure);
+      if (route.segments.empty())
+        break;
+      auto const arrival = route.segments.back().weight_at_end;
+      BOOST_CHECK_LE(last_arrival, arrival);
+      last_arrival = arrival;
+
+      // arrivals are the sum of the travel times along the route
+      auto time = departure;
+      for (auto const &segment : route.segments) {
+        time += graph.travel_time(segment.edge_id, time);
+        BOOST_CHECK_EQUAL(segment.weight_at_end, time);
+      }
+    }
+  }
+}
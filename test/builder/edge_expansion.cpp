@@ -0,0 +1,176 @@
+#include "algorithm/dijkstra.hpp"
+#include "builder/edge_expansion.hpp"
+#include "fixture/graph.hpp"
+#include "graph/decorator.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/id.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE EdgeExpansion
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+using test::DecoratedGraph;
+using test::Edge;
+using test::make_graph;
+
+namespace {
+EdgeID edge_id(std::vector<Edge> const &edges, NodeID const source,
+               NodeID const target) {
+  auto const edge =
+      std::find_if(edges.begin(), edges.end(), [&](auto const &edge) {
+        return edge.source == source && edge.target == target;
+      });
+  BOOST_REQUIRE(edge != edges.end());
+  return std::distance(edges.begin(), edge);
+}
+
+// the edges reachable with a single turn
+std::vector<EdgeID> turns(DecoratedGraph const &expanded, EdgeID const from) {
+  return {expanded.edges_begin(from), expanded.edges_end(from)};
+}
+
+int no_turn_cost(builder::Turn const &) { return 0; }
+} // namespace
+
+BOOST_AUTO_TEST_CASE(u_turns) {
+  // 0 <-> 1 <-> 2
+  std::vector<Edge> edges{{0, 1, 1}, {1, 0, 1}, {1, 2, 2}, {2, 1, 2}};
+  auto const graph = make_graph(3, edges);
+  auto const expanded = builder::expand_edges(graph, {}, no_turn_cost);
+  BOOST_CHECK_EQUAL(expanded.graph.number_of_nodes(), 4);
+
+  // no turning back at 1, but at the dead end 2
+  auto const from_left = turns(expanded.graph, edge_id(edges, 0, 1));
+  BOOST_REQUIRE_EQUAL(from_left.size(), 1);
+  BOOST_CHECK_EQUAL(from_left[0], edge_id(edges, 1, 2));
+  auto const at_end = turns(expanded.graph, edge_id(edges, 1, 2));
+  BOOST_REQUIRE_EQUAL(at_end.size(), 1);
+  BOOST_CHECK_EQUAL(at_end[0], edge_id(edges, 2, 1));
+  // turns cost the edge turned onto
+  BOOST_CHECK_EQUAL(
+      expanded.graph.cost(expanded.graph.edge_id(
+          expanded.graph.edges_begin(edge_id(edges, 0, 1)))),
+      2);
+
+  builder::ExpansionParameters parameters;
+  parameters.allow_u_turns = true;
+  auto const with_u_turns =
+      builder::expand_edges(graph, {}, no_turn_cost, parameters);
+  BOOST_CHECK_EQUAL(turns(with_u_turns.graph, edge_id(edges, 0, 1)).size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(restrictions) {
+  //       2
+  //       |
+  //  1 -- 0 -- 3
+  //       |
+  //       4
+  std::vector<Edge> edges;
+  for (NodeID node = 1; node <= 4; ++node) {
+    edges.push_back({0, node, 1});
+    edges.push_back({node, 0, 1});
+  }
+  auto const graph = make_graph(5, edges);
+  auto const from = edge_id(edges, 1, 0);
+
+  auto const prohibited = builder::expand_edges(
+      graph, {{from, edge_id(edges, 0, 2)}}, no_turn_cost);
+  std::vector<EdgeID> expected = {edge_id(edges, 0, 3), edge_id(edges, 0, 4)};
+  auto found = turns(prohibited.graph, from);
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(),
+                                expected.end());
+
+  auto const mandatory = builder::expand_edges(
+      graph, {{from, edge_id(edges, 0, 4), true}}, no_turn_cost);
+  expected = {edge_id(edges, 0, 4)};
+  found = turns(mandatory.graph, from);
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(),
+                                expected.end());
+  // other edges are not affected
+  BOOST_CHECK_EQUAL(turns(mandatory.graph, edge_id(edges, 2, 0)).size(), 3);
+
+  BOOST_CHECK_THROW(
+      builder::expand_edges(graph, {{from, edges.size()}}, no_turn_cost),
+      std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(routes_avoid_restricted_turns) {
+  // 0 -> 1 -> 2 is the shortest path, but turning at 1 is prohibited
+  //
+  //  0 - (1) - 1 - (1) - 2
+  //            |         |
+  //           (5)       (1)
+  //            |         |
+  //            3 - (1) - 4
+  std::vector<Edge> edges{{0, 1, 1}, {1, 2, 1}, {1, 3, 5},
+                          {3, 4, 1}, {4, 2, 1}, {2, 5, 1}};
+  auto const graph = make_graph(6, edges);
+  auto const from = edge_id(edges, 0, 1);
+  auto const to = edge_id(edges, 2, 5);
+  auto const turn_cost = [&](builder::Turn const &turn) {
+    // penalise the turn onto the shortcut at 4
+    return turn.to == edge_id(edges, 4, 2) ? 2 : 0;
+  };
+  auto const expanded = builder::expand_edges(
+      graph, {{from, edge_id(edges, 1, 2)}}, turn_cost);
+
+  algorithm::Dijkstra<DecoratedGraph> dijkstra(expanded.graph);
+  auto const route =
+      expanded.original_route(dijkstra({from, 1}, {to, 0}), {from, 1});
+  std::vector<EdgeID> expected = {from, edge_id(edges, 1, 3),
+                                  edge_id(edges, 3, 4), edge_id(edges, 4, 2),
+                                  to};
+  BOOST_REQUIRE_EQUAL(route.segments.size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i)
+    BOOST_CHECK_EQUAL(route.segments[i].edge_id, expected[i]);
+  BOOST_CHECK_EQUAL(route.segments.back().weight_at_end, 1 + 5 + 1 + 3 + 1);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_construction) {
+  std::mt19937 generator(42);
+  std::size_t const number_of_nodes = 500;
+  std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+  std::uniform_int_distribution<int> weight(1, 20);
+  std::vector<Edge> edges;
+  for (int edge = 0; edge < 3000; ++edge)
+    edges.push_back({node(generator), node(generator), weight(generator)});
+  auto const graph = make_graph(number_of_nodes, edges);
+
+  std::uniform_int_distribution<EdgeID> edge(0, edges.size() - 1);
+  std::vector<builder::TurnRestriction> restrictions;
+  for (int restriction = 0; restriction < 200; ++restriction)
+    restrictions.push_back(
+        {edge(generator), edge(generator), restriction % 10 == 0});
+  auto const turn_cost = [](builder::Turn const &turn) {
+    return turn.u_turn ? 10 : static_cast<int>(turn.to % 3);
+  };
+
+  builder::ExpansionParameters parameters;
+  parameters.threads = 1;
+  auto const sequential =
+      builder::expand_edges(graph, restrictions, turn_cost, parameters);
+  parameters.threads = 7;
+  auto const parallel =
+      builder::expand_edges(graph, restrictions, turn_cost, parameters);
+
+  BOOST_REQUIRE_EQUAL(sequential.graph.number_of_edges(),
+                      parallel.graph.number_of_edges());
+  for (EdgeID from = 0; from < edges.size(); ++from) {
+    auto const expected = turns(sequential.graph, from);
+    auto const found = turns(parallel.graph, from);
+    BOOST_CHECK(expected == found);
+  }
+  for (EdgeID turn = 0; turn < parallel.graph.number_of_edges(); ++turn) {
+    BOOST_CHECK_EQUAL(sequential.graph.cost(turn), parallel.graph.cost(turn));
+    BOOST_CHECK_EQUAL(parallel.original_edge(turn),
+                      *sequential.graph.edge(turn));
+  }
+}
@@ -0,0 +1,183 @@
+#include "builder/external_graph.hpp"
+#include "builder/external_sorter.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+#include "io/file.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE ExternalGraph
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+BOOST_AUTO_TEST_CASE(external_sort) {
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> distribution(0, 100);
+  std::vector<int> data(10000);
+  std::generate(data.begin(), data.end(),
+                [&]() { return distribution(generator); });
+
+  // tiny buffers force a large number of runs
+  builder::ExternalSorter<int> sorter(boost::filesystem::current_path(),
+                                      256 * sizeof(int));
+  for (auto value : data)
+    sorter.push(value);
+  sorter.finish();
+  BOOST_CHECK(sorter.number_of_runs() > 1);
+  BOOST_CHECK_EQUAL(sorter.size(), data.size());
+
+  std::sort(data.begin(), data.end());
+  // streams can be replayed
+  for (int pass = 0; pass < 2; ++pass) {
+    auto stream = sorter.stream();
+    std::vector<int> sorted;
+    int value;
+    while (stream.next(value))
+      sorted.push_back(value);
+    BOOST_CHECK(sorted == data);
+  }
+  // spilled sorters hold no buffer once finished
+  BOOST_CHECK_EQUAL(sorter.memory_usage(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(external_sort_bounded_fan_in) {
+  struct Record {
+    int key;
+    int sequence;
+  };
+  auto const by_key = [](Record const &lhs, Record const &rhs) {
+    return lhs.key < rhs.key;
+  };
+
+  // a budget of a few records spills far more runs than it can merge at once
+  builder::ExternalSorter<Record, decltype(by_key)> sorter(
+      boost::filesystem::current_path(), 8 * sizeof(Record), by_key);
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> distribution(0, 20);
+  for (int sequence = 0; sequence < 2000; ++sequence)
+    sorter.push({distribution(generator), sequence});
+  sorter.finish();
+  BOOST_CHECK(sorter.number_of_runs() > 1);
+  BOOST_CHECK(sorter.number_of_runs() <= sorter.merge_fan_in());
+
+  // sorted by key, equal keys in the order they were pushed
+  auto stream = sorter.stream();
+  Record record, previous{-1, -1};
+  std::size_t count = 0;
+  while (stream.next(record)) {
+    BOOST_CHECK(previous.key <= record.key);
+    if (previous.key == record.key)
+      BOOST_CHECK(previous.sequence < record.sequence);
+    previous = record;
+    ++count;
+  }
+  BOOST_CHECK_EQUAL(count, 2000);
+}
+
+BOOST_AUTO_TEST_CASE(external_sort_release_memory) {
+  builder::ExternalSorter<int> sorter(boost::filesystem::current_path(),
+                                      1024 * sizeof(int));
+  for (int value = 100; value > 0; --value)
+    sorter.push(value);
+  sorter.finish();
+  BOOST_CHECK_EQUAL(sorter.number_of_runs(), 0);
+  BOOST_CHECK(sorter.memory_usage() >= 100 * sizeof(int));
+
+  // the sorted records move into a run and can still be streamed
+  sorter.release_memory();
+  BOOST_CHECK_EQUAL(sorter.memory_usage(), 0);
+  BOOST_CHECK_EQUAL(sorter.number_of_runs(), 1);
+  auto stream = sorter.stream();
+  int value, expected = 1;
+  while (stream.next(value))
+    BOOST_CHECK_EQUAL(value, expected++);
+  BOOST_CHECK_EQUAL(expected, 101);
+}
+
+BOOST_AUTO_TEST_CASE(external_builder_matches_internal_layout) {
+  // 10 -> 30 <-> 20    50 <-> 40
+  // ranks: 10 -> 0, 20 -> 1, 30 -> 2, 40 -> 3, 50 -> 4
+  builder::ExternalGraph<graph::WeightTimeDistance> builder(
+      boost::filesystem::current_path(), 64);
+  builder.add_edge(10, 30, {1, 2, 3});
+  builder.add_edge(30, 20, {4, 5, 6});
+  builder.add_edge(20, 30, {7, 8, 9});
+  builder.add_edge(50, 40, {10, 11, 12});
+  builder.add_edge(40, 50, {13, 14, 15});
+  builder.add_edge(10, 20, {16, 17, 18});
+  builder.build_weighted_graph_and_store<graph::WeightTimeDistance>(
+      "external.gr");
+
+  graph::RoutingGraph graph;
+  io::File in("external.gr",
+              io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  graph.deserialise(in);
+
+  BOOST_CHECK_EQUAL(graph.number_of_nodes(), 5);
+  BOOST_CHECK_EQUAL(graph.number_of_edges(), 6);
+
+  // edges of a node retain the input order
+  std::vector<std::tuple<NodeID, NodeID, std::uint32_t>> expected = {
+      {0, 2, 1}, {0, 1, 16}, {1, 2, 7}, {2, 1, 4}, {3, 4, 13}, {4, 3, 10}};
+  std::vector<std::tuple<NodeID, NodeID, std::uint32_t>> result;
+  for (NodeID node = 0; node < graph.number_of_nodes(); ++node)
+    for (auto itr = graph.edges_begin(node); itr != graph.edges_end(node);
+         ++itr)
+      result.emplace_back(node, *itr, graph.cost(graph.edge_id(itr)).weight);
+  BOOST_CHECK(result == expected);
+}
+
+BOOST_AUTO_TEST_CASE(external_builder_random) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::uint64_t> id_distribution(0, 1000);
+
+  builder::ExternalGraph<std::uint32_t> builder(
+      boost::filesystem::current_path(), 1024);
+  std::vector<std::tuple<std::uint64_t, std::uint64_t, std::uint32_t>> input;
+  for (std::uint32_t i = 0; i < 5000; ++i) {
+    auto const source = id_distribution(generator) * 1000003;
+    auto const target = id_distribution(generator) * 1000003;
+    builder.add_edge(source, target, i);
+    input.emplace_back(source, target, i);
+  }
+  builder.build_weighted_graph_and_store<std::uint32_t>("external_random.gr");
+
+  graph::edge::CostDecorator<std::uint32_t, graph::ForwardStar> graph;
+  io::File in("external_random.gr",
+              io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  graph.deserialise(in);
+
+  std::vector<std::uint64_t> ids;
+  for (auto const &edge : input) {
+    ids.push_back(std::get<0>(edge));
+    ids.push_back(std::get<1>(edge));
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  BOOST_CHECK_EQUAL(graph.number_of_nodes(), ids.size());
+  BOOST_CHECK_EQUAL(graph.number_of_edges(), input.size());
+
+  auto const rank = [&ids](auto const id) {
+    return std::distance(ids.begin(),
+                         std::lower_bound(ids.begin(), ids.end(), id));
+  };
+  std::stable_sort(input.begin(), input.end(),
+                   [&](auto const &lhs, auto const &rhs) {
+                     return rank(std::get<0>(lhs)) < rank(std::get<0>(rhs));
+                   });
+  for (EdgeID edge = 0; edge < input.size(); ++edge) {
+    BOOST_CHECK_EQUAL(*graph.edge(edge), rank(std::get<1>(input[edge])));
+    BOOST_CHECK_EQUAL(graph.cost(edge), std::get<2>(input[edge]));
+  }
+}
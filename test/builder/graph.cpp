@@ -1,10 +1,23 @@
 #include "builder/graph.hpp"
+#include "container/dictionary.hpp"
+#include "graph/async_loader.hpp"
+#include "graph/decorator.hpp"
 #include "graph/forward_star.hpp"
 #include "graph/forward_star_factory.hpp"
 #include "graph/id.hpp"
+#include "graph/id_mapping.hpp"
+#include "graph/routing.hpp"
 #include "io/file.hpp"
+#include "io/section.hpp"
 #include "log/logger.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
 // make sure we get a new main function here
 #define BOOST_TEST_MODULE Builder
 #define BOOST_TEST_MAIN
@@ -31,3 +44,174 @@ BOOST_AUTO_TEST_CASE(construct_builder) {
   BOOST_CHECK_EQUAL(*graph.edges_begin((NodeID)0), 1);
   BOOST_CHECK_EQUAL(*graph.edges_begin((NodeID)2), 1);
 }
+
+// payloads are interned into a dictionary and stored once per distinct value
+BOOST_AUTO_TEST_CASE(annotated_builder) {
+  using Edge = builder::Edge<graph::WeightTimeDistance::weight_type,
+                             graph::WeightTimeDistance::time_type,
+                             graph::WeightTimeDistance::distance_type,
+                             container::DictionaryID>;
+  builder::Graph<Edge> builder;
+  builder.add_edge(1, 2, 1u, 2u, 3u, std::string("residential"));
+  builder.add_edge(2, 3, 4u, 5u, 6u, "primary");
+  builder.add_edge(3, 1, 7u, 8u, 9u, std::string("residential"));
+  BOOST_CHECK_EQUAL(builder.payloads().size(), 2);
+
+  builder.build_annotated_graph_and_store<graph::WeightTimeDistance>(
+      "annotated.gr");
+
+  graph::edge::DictionaryDecorator<std::string, graph::RoutingGraph> graph;
+  io::File in("annotated.gr",
+              io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  graph.deserialise(in);
+
+  BOOST_CHECK_EQUAL(graph.number_of_nodes(), 3);
+  BOOST_CHECK_EQUAL(graph.dictionary().size(), 2);
+  BOOST_CHECK_EQUAL(graph.payload(0), "residential");
+  BOOST_CHECK_EQUAL(graph.payload(1), "primary");
+  BOOST_CHECK_EQUAL(graph.payload(2), "residential");
+  BOOST_CHECK(graph.payload_id(0) == graph.payload_id(2));
+  BOOST_CHECK_EQUAL(graph.cost(1).weight, 4);
+  BOOST_CHECK_EQUAL(graph.cost(1).distance, 6);
+
+  // payload IDs and the dictionary are stored in their own sections
+  {
+    io::SectionWriter writer("annotated.sgr");
+    graph.serialise(writer);
+  }
+  graph::edge::DictionaryDecorator<std::string, graph::RoutingGraph> sectioned;
+  sectioned.deserialise(io::SectionReader("annotated.sgr"));
+  BOOST_CHECK_EQUAL(sectioned.dictionary().size(), 2);
+  BOOST_CHECK_EQUAL(sectioned.payload(1), "primary");
+  BOOST_CHECK_EQUAL(sectioned.cost(2).time, 8);
+}
+
+// batches are numbered like single edges and the mapping resolves external IDs
+BOOST_AUTO_TEST_CASE(batch_builder_and_id_mapping) {
+  std::vector<std::uint64_t> sources = {1, 2, 3, 4, 5};
+  std::vector<std::uint64_t> targets = {2, 3, 2, 5, 4};
+  std::vector<std::string> names = {"a", "b", "a", "c", "c"};
+
+  builder::Graph<builder::Edge<container::DictionaryID>> builder;
+  builder.reserve(5, 5);
+  builder.add_edges(sources.size(), sources.data(), targets.data(),
+                    names.data());
+  BOOST_CHECK_EQUAL(builder.payloads().size(), 3);
+
+  builder.build_graph_and_store("batch.gr");
+  builder.store_id_mapping("batch.map");
+
+  auto graph = graph::ForwardStarFactory::produce_from_file("batch.gr");
+  BOOST_CHECK_EQUAL(graph.number_of_nodes(), 5);
+  BOOST_CHECK_EQUAL(*graph.edges_begin((NodeID)0), 1);
+  BOOST_CHECK_EQUAL(*graph.edges_begin((NodeID)2), 1);
+
+  graph::IDMapping mapping;
+  io::File in("batch.map",
+              io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  mapping.deserialise(in);
+  BOOST_CHECK_EQUAL(mapping.size(), 5);
+  for (std::uint64_t external = 1; external <= 5; ++external)
+    BOOST_CHECK_EQUAL(*mapping.node_id(external), external - 1);
+  BOOST_CHECK(!mapping.node_id(6));
+}
+
+// graphs are streamed into the file, the result matches the serialisation of
+// the graph built in memory
+BOOST_AUTO_TEST_CASE(streamed_graph_matches_serialised_graph) {
+  using Edge = builder::Edge<graph::WeightTimeDistance::weight_type,
+                             graph::WeightTimeDistance::time_type,
+                             graph::WeightTimeDistance::distance_type>;
+  builder::Graph<Edge> builder;
+  for (std::uint32_t i = 0; i < 3000; ++i) {
+    auto const source = (i * 7919) % 1000, target = (i * 104729) % 1000;
+    builder.add_edge(source, target, i, 2 * i, 3 * i);
+  }
+
+  for (auto const mode : {io::mode::Enum(0), io::mode::mCOMPRESSED}) {
+    builder.build_weighted_graph_and_store<graph::WeightTimeDistance>(
+        "streamed.gr", mode);
+
+    graph::RoutingGraph streamed;
+    io::File in("streamed.gr", io::mode::mREAD | io::mode::mBINARY |
+                                   io::mode::mVERSIONED | mode);
+    streamed.deserialise(in);
+
+    // the streamed layout is the one of CostDecorator::serialise
+    {
+      io::File out("serialised.gr", io::mode::mWRITE | io::mode::mBINARY |
+                                        io::mode::mVERSIONED | mode);
+      streamed.serialise(out);
+    }
+    std::ifstream lhs("streamed.gr", std::ios::binary),
+        rhs("serialised.gr", std::ios::binary);
+    BOOST_CHECK(std::string(std::istreambuf_iterator<char>(lhs), {}) ==
+                std::string(std::istreambuf_iterator<char>(rhs), {}));
+
+    BOOST_CHECK_EQUAL(streamed.number_of_nodes(), 1000);
+    BOOST_CHECK_EQUAL(streamed.number_of_edges(), 3000);
+    // edges of a node keep the order in which they were added
+    BOOST_CHECK_EQUAL(*streamed.edges_begin((NodeID)0), 0);
+    BOOST_CHECK_EQUAL(streamed.cost(0).weight, 0);
+    BOOST_CHECK_EQUAL(streamed.cost(1).weight, 1000);
+    BOOST_CHECK_EQUAL(streamed.cost(1).distance, 3000);
+
+    // loaders do not need to know whether the graph was compressed
+    auto const loaded = graph::ForwardStarFactory::produce_from_file(
+        "streamed.gr");
+    BOOST_CHECK_EQUAL(loaded.number_of_edges(), 3000);
+    BOOST_CHECK_EQUAL(*loaded.edges_begin((NodeID)0), 0);
+  }
+}
+
+// sectioned output is loaded layer by layer via the asynchronous loader
+BOOST_AUTO_TEST_CASE(sectioned_graph_loads_asynchronously) {
+  using Edge = builder::Edge<graph::WeightTimeDistance::weight_type,
+                             graph::WeightTimeDistance::time_type,
+                             graph::WeightTimeDistance::distance_type,
+                             container::DictionaryID>;
+  using AnnotatedGraph =
+      graph::edge::DictionaryDecorator<std::string, graph::RoutingGraph>;
+  builder::Graph<Edge> builder;
+  for (std::uint32_t i = 0; i < 3000; ++i) {
+    auto const source = (i * 7919) % 1000, target = (i * 104729) % 1000;
+    builder.add_edge(source, target, i, 2 * i, 3 * i,
+                     std::to_string(i % 10));
+  }
+
+  builder.build_annotated_graph_and_store<graph::WeightTimeDistance>(
+      "sectioned.gr");
+  AnnotatedGraph streamed;
+  io::File in("sectioned.gr",
+              io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  streamed.deserialise(in);
+
+  for (auto const encoding : {io::Encoding::RAW, io::Encoding::BLOCK_PACKED}) {
+    builder.build_annotated_graph_and_store_sections<
+        graph::WeightTimeDistance>("annotated.sgr", encoding);
+    graph::AsyncLoader<AnnotatedGraph> loader("annotated.sgr", 2);
+    auto const &graph = loader.wait();
+    BOOST_CHECK_EQUAL(graph.number_of_nodes(), 1000);
+    BOOST_CHECK_EQUAL(graph.number_of_edges(), 3000);
+    BOOST_CHECK_EQUAL(graph.dictionary().size(), 10);
+    for (NodeID node = 0; node < graph.number_of_nodes(); ++node)
+      BOOST_CHECK(std::equal(graph.edges_begin(node), graph.edges_end(node),
+                             streamed.edges_begin(node),
+                             streamed.edges_end(node)));
+    for (EdgeID edge = 0; edge < graph.number_of_edges(); ++edge) {
+      BOOST_CHECK_EQUAL(graph.cost(edge).time, streamed.cost(edge).time);
+      BOOST_CHECK_EQUAL(graph.payload(edge), streamed.payload(edge));
+    }
+
+    builder.build_weighted_graph_and_store_sections<
+        graph::WeightTimeDistance>("weighted.sgr", encoding);
+    graph::AsyncLoader<graph::RoutingGraph> weighted("weighted.sgr");
+    BOOST_CHECK_EQUAL(weighted.wait().cost(1).distance,
+                      streamed.cost(1).distance);
+
+    builder.build_graph_and_store_sections("plain.sgr", encoding);
+    graph::ForwardStar plain;
+    plain.deserialise(io::SectionReader("plain.sgr"));
+    BOOST_CHECK_EQUAL(plain.number_of_edges(), 3000);
+  }
+}
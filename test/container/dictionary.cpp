@@ -0,0 +1,59 @@
+#include "container/dictionary.hpp"
+#include "io/file.hpp"
+
+#include <string>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Dictionary
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+BOOST_AUTO_TEST_CASE(intern_strings) {
+  container::Dictionary<std::string> dictionary;
+  BOOST_CHECK(dictionary.empty());
+
+  auto const residential = dictionary.intern("residential");
+  auto const primary = dictionary.intern("primary");
+  BOOST_CHECK(residential != primary);
+  BOOST_CHECK(dictionary.intern("residential") == residential);
+  BOOST_CHECK_EQUAL(dictionary.size(), 2);
+
+  BOOST_CHECK_EQUAL(dictionary[residential], "residential");
+  BOOST_CHECK_EQUAL(dictionary[primary], "primary");
+
+  BOOST_CHECK(*dictionary.find("primary") == primary);
+  BOOST_CHECK(!dictionary.find("motorway"));
+}
+
+BOOST_AUTO_TEST_CASE(serialise_dictionary) {
+  container::Dictionary<std::string> dictionary;
+  dictionary.intern("residential");
+  dictionary.intern("");
+  dictionary.intern("primary");
+  {
+    io::File out("dictionary.tmp", io::mode::mWRITE | io::mode::mBINARY);
+    dictionary.serialise(out);
+  }
+
+  container::Dictionary<std::string> read_dictionary;
+  io::File in("dictionary.tmp", io::mode::mREAD | io::mode::mBINARY);
+  read_dictionary.deserialise(in);
+
+  BOOST_CHECK_EQUAL(read_dictionary.size(), 3);
+  for (std::uint32_t id = 0; id < dictionary.size(); ++id)
+    BOOST_CHECK_EQUAL(read_dictionary[{id}], dictionary[{id}]);
+
+  // interning continues to work with the restored lookup
+  BOOST_CHECK(read_dictionary.intern("primary") == *dictionary.find("primary"));
+  BOOST_CHECK_EQUAL(read_dictionary.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(intern_pod) {
+  container::Dictionary<int> dictionary;
+  BOOST_CHECK_EQUAL(dictionary.intern(42).base(), 0);
+  BOOST_CHECK_EQUAL(dictionary.intern(7).base(), 1);
+  BOOST_CHECK_EQUAL(dictionary.intern(42).base(), 0);
+  BOOST_CHECK_EQUAL(dictionary[{1}], 7);
+}
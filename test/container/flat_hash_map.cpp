@@ -0,0 +1,72 @@
+#include "container/flat_hash_map.hpp"
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE FlatHashMap
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+BOOST_AUTO_TEST_CASE(insert_and_find) {
+  container::FlatHashMap<std::uint64_t, std::uint64_t> map;
+  BOOST_CHECK(map.empty());
+
+  auto const inserted = map.insert(42, 1);
+  BOOST_CHECK_EQUAL(inserted.first, 1);
+  BOOST_CHECK(inserted.second);
+
+  // existing keys keep their value
+  auto const existing = map.insert(42, 2);
+  BOOST_CHECK_EQUAL(existing.first, 1);
+  BOOST_CHECK(!existing.second);
+
+  BOOST_CHECK_EQUAL(*map.find(42), 1);
+  BOOST_CHECK(!map.find(7));
+  BOOST_CHECK_EQUAL(map.size(), 1);
+
+  BOOST_CHECK_THROW(map.insert(~std::uint64_t(0), 0), std::invalid_argument);
+
+  map.clear();
+  BOOST_CHECK(map.empty());
+  BOOST_CHECK(!map.find(42));
+}
+
+BOOST_AUTO_TEST_CASE(growth_against_reference) {
+  std::mt19937_64 generator(1337);
+  container::FlatHashMap<std::uint64_t, std::uint32_t> map;
+  std::unordered_map<std::uint64_t, std::uint32_t> reference;
+
+  for (std::uint32_t i = 0; i < 100000; ++i) {
+    auto const key = generator() % 50000;
+    auto const result = map.insert(key, i);
+    auto const expected = reference.insert({key, i});
+    BOOST_REQUIRE_EQUAL(result.first, expected.first->second);
+    BOOST_REQUIRE_EQUAL(result.second, expected.second);
+  }
+  BOOST_CHECK_EQUAL(map.size(), reference.size());
+
+  std::size_t visited = 0;
+  map.for_each([&](auto const key, auto const value) {
+    BOOST_CHECK_EQUAL(reference[key], value);
+    ++visited;
+  });
+  BOOST_CHECK_EQUAL(visited, reference.size());
+}
+
+BOOST_AUTO_TEST_CASE(batch_insertion) {
+  container::FlatHashMap<std::uint64_t, std::uint64_t> map;
+  std::vector<std::uint64_t> keys = {5, 3, 5, 9, 3, 11, 5};
+  std::vector<std::uint64_t> values(keys.size());
+
+  map.insert_batch(keys.data(), keys.size(), values.data(),
+                   [&map]() { return map.size(); });
+  std::vector<std::uint64_t> expected = {0, 1, 0, 2, 1, 3, 0};
+  BOOST_CHECK(values == expected);
+  BOOST_CHECK_EQUAL(map.size(), 4);
+}
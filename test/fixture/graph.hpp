@@ -0,0 +1,109 @@
+#ifndef PROJECT_X_TEST_FIXTURE_GRAPH_HPP_
+#define PROJECT_X_TEST_FIXTURE_GRAPH_HPP_
+
+#include "algorithm/shortest_path_interface.hpp"
+#include "graph/decorator.hpp"
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Graphs and reference results shared by the unit tests
+namespace project_x {
+namespace test {
+
+struct Edge {
+  NodeID source, target;
+  int weight;
+};
+
+using DecoratedGraph = graph::edge::CostDecorator<int, graph::ForwardStar>;
+
+// A directed graph over the edges, decorated with the costs the converter
+// derives from each edge. Sorts the edges, as the factory requires. Afterwards
+// edges[eid] describes the edge eid of the graph.
+template <typename graph_type, typename edge_type, typename converter_type>
+graph_type make_graph(std::size_t const number_of_nodes,
+                      std::vector<edge_type> &edges, converter_type cvt);
+// decorated with the weights of the edges
+template <typename graph_type = DecoratedGraph, typename edge_type>
+graph_type make_graph(std::size_t const number_of_nodes,
+                      std::vector<edge_type> &edges);
+
+// a width x width grid in both directions, similar to road networks, weights
+// are drawn from [min_weight, max_weight]
+std::vector<Edge> grid_edges(std::mt19937 &generator, NodeID const width,
+                             int const min_weight, int const max_weight);
+
+// shortest path weights from any of the locations via Bellman-Ford, unreached
+// nodes have the maximal weight
+std::vector<int>
+bellman_ford(std::size_t const number_of_nodes, std::vector<Edge> const &edges,
+             std::vector<algorithm::Location<int>> const &from);
+
+//////////////////////////////////////////////////////////////////
+// Implementations
+//////////////////////////////////////////////////////////////////
+
+template <typename graph_type, typename edge_type, typename converter_type>
+graph_type make_graph(std::size_t const number_of_nodes,
+                      std::vector<edge_type> &edges, converter_type cvt) {
+  graph_type graph = graph::ForwardStarFactory::produce_directed_from_edges(
+      number_of_nodes, edges);
+  graph::DecoratorFactory().decorate<graph_type>(graph, edges, cvt);
+  return graph;
+}
+
+template <typename graph_type, typename edge_type>
+graph_type make_graph(std::size_t const number_of_nodes,
+                      std::vector<edge_type> &edges) {
+  return make_graph<graph_type>(number_of_nodes, edges,
+                                [](auto const &edge) { return edge.weight; });
+}
+
+inline std::vector<Edge> grid_edges(std::mt19937 &generator,
+                                    NodeID const width, int const min_weight,
+                                    int const max_weight) {
+  std::uniform_int_distribution<int> weight(min_weight, max_weight);
+  std::vector<Edge> edges;
+  for (NodeID row = 0; row < width; ++row) {
+    for (NodeID column = 0; column < width; ++column) {
+      auto const node = row * width + column;
+      if (column + 1 < width) {
+        edges.push_back({node, node + 1, weight(generator)});
+        edges.push_back({node + 1, node, weight(generator)});
+      }
+      if (row + 1 < width) {
+        edges.push_back({node, node + width, weight(generator)});
+        edges.push_back({node + width, node, weight(generator)});
+      }
+    }
+  }
+  return edges;
+}
+
+inline std::vector<int>
+bellman_ford(std::size_t const number_of_nodes, std::vector<Edge> const &edges,
+             std::vector<algorithm::Location<int>> const &from) {
+  auto const unreached = std::numeric_limits<int>::max();
+  std::vector<int> result(number_of_nodes, unreached);
+  for (auto const &location : from)
+    result[location.node] = std::min(result[location.node], location.offset);
+  for (std::size_t round = 0; round < number_of_nodes; ++round)
+    for (auto const &edge : edges)
+      if (result[edge.source] != unreached)
+        result[edge.target] = std::min(result[edge.target],
+                                       result[edge.source] + edge.weight);
+  return result;
+}
+
+} // namespace test
+} // namespace project_x
+
+#endif // PROJECT_X_TEST_FIXTURE_GRAPH_HPP_
@@ -0,0 +1,196 @@
+#include "geometry/batch.hpp"
+#include "geometry/constants.hpp"
+#include "geometry/coordinate.hpp"
+#include "geometry/distance.hpp"
+#include "geometry/projection.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Geometry
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+struct Coordinates {
+  std::vector<std::int32_t> latitudes;
+  std::vector<std::int32_t> longitudes;
+
+  geometry::WGS84FixedCoorinate operator[](std::size_t const index) const {
+    return {geometry::FixedWGSLatitude{latitudes[index]},
+            geometry::FixedWGSLongitude{longitudes[index]}};
+  }
+};
+
+Coordinates random_coordinates(std::mt19937 &generator,
+                               std::size_t const count,
+                               double const max_latitude) {
+  auto const limit = geometry::coordinate::to_fixed(max_latitude);
+  std::uniform_int_distribution<std::int32_t> latitude(-limit, limit);
+  std::uniform_int_distribution<std::int32_t> longitude(-18000000, 18000000);
+  Coordinates result;
+  for (std::size_t i = 0; i < count; ++i) {
+    result.latitudes.push_back(latitude(generator));
+    result.longitudes.push_back(longitude(generator));
+  }
+  return result;
+}
+
+// coordinates close to the ones given, for short distances
+Coordinates nearby(std::mt19937 &generator, Coordinates const &coordinates,
+                   std::int32_t const spread) {
+  std::uniform_int_distribution<std::int32_t> offset(-spread, spread);
+  Coordinates result;
+  for (std::size_t i = 0; i < coordinates.latitudes.size(); ++i) {
+    result.latitudes.push_back(coordinates.latitudes[i] + offset(generator));
+    result.longitudes.push_back(coordinates.longitudes[i] + offset(generator));
+  }
+  return result;
+}
+
+void check_distance(double const batch, double const scalar) {
+  BOOST_CHECK_LE(std::abs(batch - scalar), 1e-6 + 1e-9 * scalar);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(forward_projection) {
+  std::mt19937 generator(42);
+  auto const max_latitude = geometry::constants::epsg3857_max_latitude;
+  auto coordinates = random_coordinates(generator, 100000, max_latitude);
+  // the extremes of the projection
+  coordinates.latitudes.insert(coordinates.latitudes.end(),
+                               {0, 0, geometry::coordinate::to_fixed(85.05),
+                                geometry::coordinate::to_fixed(-85.05)});
+  coordinates.longitudes.insert(coordinates.longitudes.end(),
+                                {-18000000, 18000000, 0, 0});
+
+  auto const count = coordinates.latitudes.size();
+  std::vector<std::int32_t> latitudes(count), longitudes(count);
+  geometry::batch::projectWgsWebMerc(count, coordinates.latitudes.data(),
+                                     coordinates.longitudes.data(),
+                                     latitudes.data(), longitudes.data());
+
+  std::size_t mismatches = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const scalar = geometry::projectWgsWebMerc(coordinates[i]);
+    BOOST_CHECK_LE(std::abs(latitudes[i] - scalar.latitude.base()), 1);
+    BOOST_CHECK_LE(std::abs(longitudes[i] - scalar.longitude.base()), 1);
+    mismatches += latitudes[i] != scalar.latitude.base();
+  }
+  // off by one only when rounding values very close to .5
+  BOOST_CHECK_LT(mismatches, count / 1000);
+}
+
+BOOST_AUTO_TEST_CASE(clamped_latitudes) {
+  std::vector<std::int32_t> latitudes = {9000000, -9000000};
+  std::vector<std::int32_t> longitudes = {0, 0};
+  std::vector<std::int32_t> merc_latitudes(2), merc_longitudes(2);
+  geometry::batch::projectWgsWebMerc(2, latitudes.data(), longitudes.data(),
+                                     merc_latitudes.data(),
+                                     merc_longitudes.data());
+  // the square web mercator map covers [0, 256] in both directions
+  BOOST_CHECK_LE(std::abs(merc_latitudes[0]), 1);
+  BOOST_CHECK_LE(std::abs(merc_latitudes[1] - 25600000), 1);
+}
+
+BOOST_AUTO_TEST_CASE(inverse_projection) {
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<std::int32_t> merc(0, 25600000);
+  std::vector<std::int32_t> merc_latitudes, merc_longitudes;
+  for (std::size_t i = 0; i < 100000; ++i) {
+    merc_latitudes.push_back(merc(generator));
+    merc_longitudes.push_back(merc(generator));
+  }
+
+  auto const count = merc_latitudes.size();
+  std::vector<std::int32_t> latitudes(count), longitudes(count);
+  geometry::batch::projectWebMercWgs(count, merc_latitudes.data(),
+                                     merc_longitudes.data(), latitudes.data(),
+                                     longitudes.data());
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const scalar = geometry::projectWebMercWgs(
+        {geometry::FixedWebMercLatitude{merc_latitudes[i]},
+         geometry::FixedWebMercLongitude{merc_longitudes[i]}});
+    BOOST_CHECK_LE(std::abs(latitudes[i] - scalar.latitude.base()), 1);
+    BOOST_CHECK_LE(std::abs(longitudes[i] - scalar.longitude.base()), 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(roundtrip) {
+  std::mt19937 generator(3);
+  auto const coordinates = random_coordinates(generator, 10000, 85.0);
+  auto const count = coordinates.latitudes.size();
+
+  // projecting in place
+  auto latitudes = coordinates.latitudes;
+  auto longitudes = coordinates.longitudes;
+  geometry::batch::projectWgsWebMerc(count, latitudes.data(),
+                                     longitudes.data(), latitudes.data(),
+                                     longitudes.data());
+  geometry::batch::projectWebMercWgs(count, latitudes.data(),
+                                     longitudes.data(), latitudes.data(),
+                                     longitudes.data());
+
+  for (std::size_t i = 0; i < count; ++i) {
+    // the web mercator precision is coarser than the WGS84 one, by up to a
+    // factor of 1 / cos(85 degrees) towards the poles
+    BOOST_CHECK_LE(std::abs(latitudes[i] - coordinates.latitudes[i]), 8);
+    BOOST_CHECK_LE(std::abs(longitudes[i] - coordinates.longitudes[i]), 1);
+
+    auto const scalar = geometry::projectWebMercWgs(
+        geometry::projectWgsWebMerc(coordinates[i]));
+    BOOST_CHECK_LE(
+        std::abs(scalar.latitude.base() - coordinates.latitudes[i]), 8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(distances) {
+  std::mt19937 generator(11);
+  auto const from = random_coordinates(generator, 50000, 89.0);
+  auto const far = random_coordinates(generator, 50000, 89.0);
+  auto const close = nearby(generator, from, 1000);
+  auto const count = from.latitudes.size();
+
+  std::vector<double> distances(count);
+  for (auto const *to : {&far, &close}) {
+    geometry::batch::haversine_distance(
+        count, from.latitudes.data(), from.longitudes.data(),
+        to->latitudes.data(), to->longitudes.data(), distances.data());
+    for (std::size_t i = 0; i < count; ++i)
+      check_distance(distances[i],
+                     geometry::haversine_distance(from[i], (*to)[i]));
+
+    geometry::batch::equirectangular_distance(
+        count, from.latitudes.data(), from.longitudes.data(),
+        to->latitudes.data(), to->longitudes.data(), distances.data());
+    for (std::size_t i = 0; i < count; ++i)
+      check_distance(distances[i],
+                     geometry::equirectangular_distance(from[i], (*to)[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(special_distances) {
+  // identical, antipodal and across the antimeridian
+  std::vector<std::int32_t> from_latitudes = {5000000, 0, 0, -1000000};
+  std::vector<std::int32_t> from_longitudes = {1000000, 0, 17999000, 0};
+  std::vector<std::int32_t> to_latitudes = {5000000, 0, 0, 1000000};
+  std::vector<std::int32_t> to_longitudes = {1000000, 18000000, -17999000, 0};
+  std::vector<double> distances(4);
+  geometry::batch::haversine_distance(
+      4, from_latitudes.data(), from_longitudes.data(), to_latitudes.data(),
+      to_longitudes.data(), distances.data());
+
+  auto const radius =
+      static_cast<double>(geometry::constants::earth_radius_meters);
+  BOOST_CHECK_EQUAL(distances[0], 0);
+  BOOST_CHECK_CLOSE(distances[1], radius * M_PI, 1e-9);
+  // 0.02 degrees along the equator
+  BOOST_CHECK_CLOSE(distances[2], radius * 0.02 * M_PI / 180, 1e-6);
+  BOOST_CHECK_CLOSE(distances[3], radius * 20 * M_PI / 180, 1e-9);
+}
@@ -0,0 +1,46 @@
+#include "geometry/coordinate.hpp"
+#include "geometry/distance.hpp"
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Geometry
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+geometry::WGS84FixedCoorinate make_coordinate(double lat, double lon) {
+  return {geometry::FixedWGSLatitude{geometry::coordinate::to_fixed(lat)},
+          geometry::FixedWGSLongitude{geometry::coordinate::to_fixed(lon)}};
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(haversine) {
+  auto const berlin = make_coordinate(52.5200, 13.4050);
+  auto const paris = make_coordinate(48.8566, 2.3522);
+  // ~878km between the city centres
+  BOOST_CHECK_CLOSE(geometry::haversine_distance(berlin, paris), 877500, 0.5);
+  BOOST_CHECK_EQUAL(geometry::haversine_distance(berlin, berlin), 0);
+
+  // one degree along the equator
+  auto const origin = make_coordinate(0, 0);
+  auto const east = make_coordinate(0, 1);
+  BOOST_CHECK_CLOSE(geometry::haversine_distance(origin, east), 111226.3,
+                    0.01);
+  BOOST_CHECK_CLOSE(geometry::haversine_distance(origin, east),
+                    geometry::haversine_distance(east, origin), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(equirectangular) {
+  auto const origin = make_coordinate(0, 0);
+  auto const east = make_coordinate(0, 1);
+  BOOST_CHECK_CLOSE(geometry::equirectangular_distance(origin, east),
+                    geometry::haversine_distance(origin, east), 1e-3);
+
+  // short distances outside of the polar regions
+  auto const berlin = make_coordinate(52.5200, 13.4050);
+  auto const potsdam = make_coordinate(52.3906, 13.0645);
+  BOOST_CHECK_CLOSE(geometry::equirectangular_distance(berlin, potsdam),
+                    geometry::haversine_distance(berlin, potsdam), 0.1);
+  BOOST_CHECK_EQUAL(geometry::equirectangular_distance(berlin, berlin), 0);
+}
@@ -0,0 +1,117 @@
+#include "geometry/coordinate.hpp"
+#include "geometry/polyline.hpp"
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Polyline
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+using geometry::polyline::Precision;
+
+namespace {
+geometry::WGS84FixedCoorinate make_coordinate(double lat, double lon) {
+  return {geometry::FixedWGSLatitude{geometry::coordinate::to_fixed(lat)},
+          geometry::FixedWGSLongitude{geometry::coordinate::to_fixed(lon)}};
+}
+
+void check_equal(std::vector<geometry::WGS84FixedCoorinate> const &lhs,
+                 std::vector<geometry::WGS84FixedCoorinate> const &rhs) {
+  BOOST_REQUIRE_EQUAL(lhs.size(), rhs.size());
+  for (std::size_t index = 0; index < lhs.size(); ++index) {
+    BOOST_CHECK_EQUAL(lhs[index].latitude.base(), rhs[index].latitude.base());
+    BOOST_CHECK_EQUAL(lhs[index].longitude.base(),
+                      rhs[index].longitude.base());
+  }
+}
+
+// the example of the format description
+std::vector<geometry::WGS84FixedCoorinate> const example = {
+    make_coordinate(38.5, -120.2), make_coordinate(40.7, -120.95),
+    make_coordinate(43.252, -126.453)};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(reference_example) {
+  BOOST_CHECK_EQUAL(geometry::polyline::encode(example),
+                    "_p~iF~ps|U_ulLnnqC_mqNvxq`@");
+  BOOST_CHECK_EQUAL(geometry::polyline::encode(example, Precision::polyline6),
+                    "_izlhA~rlgdF_{geC~ywl@_kwzCn`{nI");
+  check_equal(geometry::polyline::decode("_p~iF~ps|U_ulLnnqC_mqNvxq`@"),
+              example);
+  check_equal(geometry::polyline::decode("_izlhA~rlgdF_{geC~ywl@_kwzCn`{nI",
+                                         Precision::polyline6),
+              example);
+
+  BOOST_CHECK(geometry::polyline::encode({}).empty());
+  BOOST_CHECK(geometry::polyline::decode("").empty());
+}
+
+BOOST_AUTO_TEST_CASE(round_trip) {
+  std::mt19937 generator(42);
+  // long routes with small steps, mixed with jumps across the globe
+  std::uniform_int_distribution<std::int32_t> step(-500, 500);
+  std::uniform_int_distribution<std::int32_t> latitude(-9000000, 9000000);
+  std::uniform_int_distribution<std::int32_t> longitude(-18000000, 18000000);
+  std::vector<std::int32_t> latitudes, longitudes;
+  for (int coordinate = 0; coordinate < 5000; ++coordinate) {
+    if (coordinate % 1000 == 0) {
+      latitudes.push_back(latitude(generator));
+      longitudes.push_back(longitude(generator));
+    } else {
+      latitudes.push_back(latitudes.back() + step(generator));
+      longitudes.push_back(longitudes.back() + step(generator));
+    }
+  }
+  // extreme values of the fixed representation
+  latitudes.push_back(INT32_MAX);
+  longitudes.push_back(INT32_MIN);
+  latitudes.push_back(INT32_MIN);
+  longitudes.push_back(0);
+
+  for (auto const precision : {Precision::polyline5, Precision::polyline6}) {
+    std::vector<char> encoded(
+        geometry::polyline::max_encoded_size(latitudes.size()));
+    auto const size = geometry::polyline::encode(
+        latitudes.size(), latitudes.data(), longitudes.data(), encoded.data(),
+        precision);
+    BOOST_CHECK_LE(size, encoded.size());
+
+    std::vector<std::int32_t> decoded_latitudes(size / 2),
+        decoded_longitudes(size / 2);
+    auto const count = geometry::polyline::decode(
+        encoded.data(), size, decoded_latitudes.data(),
+        decoded_longitudes.data(), precision);
+    BOOST_REQUIRE_EQUAL(count, latitudes.size());
+    decoded_latitudes.resize(count);
+    decoded_longitudes.resize(count);
+    BOOST_CHECK(decoded_latitudes == latitudes);
+    BOOST_CHECK(decoded_longitudes == longitudes);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(precision_six) {
+  // values between two fixed coordinates round to the closest one
+  BOOST_CHECK_EQUAL(geometry::polyline::encode({make_coordinate(0.00001, 0)},
+                                               Precision::polyline6),
+                    "S?");
+  auto const rounded = geometry::polyline::decode("u@t@", Precision::polyline6);
+  BOOST_REQUIRE_EQUAL(rounded.size(), 1);
+  // 0.000027 and -0.000027 in polyline6
+  BOOST_CHECK_EQUAL(rounded[0].latitude.base(), 3);
+  BOOST_CHECK_EQUAL(rounded[0].longitude.base(), -3);
+}
+
+BOOST_AUTO_TEST_CASE(malformed) {
+  // a latitude without longitude, a value without end and a space
+  BOOST_CHECK_THROW(geometry::polyline::decode("_p~iF"), std::invalid_argument);
+  BOOST_CHECK_THROW(geometry::polyline::decode("_p~iF~ps|"),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(geometry::polyline::decode("_p~iF ps|U"),
+                    std::invalid_argument);
+}
@@ -32,3 +32,18 @@ BOOST_AUTO_TEST_CASE(mercator_projection) {
   BOOST_CHECK_CLOSE(224.0, geometry::coordinate::to_floating(c2m.longitude),
                     0.001);
 }
+
+BOOST_AUTO_TEST_CASE(inverse_mercator_projection) {
+  for (auto const coordinate :
+       {make_coordinate(0, 0), make_coordinate(45, 135),
+        make_coordinate(-33.9, 18.4), make_coordinate(70.5, -179.9)}) {
+    auto const back =
+        geometry::projectWebMercWgs(geometry::projectWgsWebMerc(coordinate));
+    BOOST_CHECK_CLOSE(geometry::coordinate::to_floating(back.latitude),
+                      geometry::coordinate::to_floating(coordinate.latitude),
+                      0.01);
+    BOOST_CHECK_CLOSE(geometry::coordinate::to_floating(back.longitude),
+                      geometry::coordinate::to_floating(coordinate.longitude),
+                      0.01);
+  }
+}
@@ -0,0 +1,96 @@
+#include "graph/async_loader.hpp"
+#include "graph/decorator.hpp"
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "io/section.hpp"
+#include "io/wrappers.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE AsyncLoader
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+struct Edge {
+  NodeID source, target;
+  int weight;
+};
+
+using CostGraph = graph::edge::CostDecorator<int, graph::ForwardStar>;
+using DataCostGraph = graph::edge::DataDecorator<int, CostGraph>;
+using AnnotatedGraph = graph::edge::ByteDecorator<DataCostGraph>;
+
+namespace {
+void store_graph(std::string const &path) {
+  std::vector<Edge> edges;
+  for (NodeID node = 0; node < 1000; ++node) {
+    edges.push_back({node, (node + 1) % 1000, static_cast<int>(node)});
+    edges.push_back({node, (node * 7) % 1000, static_cast<int>(2 * node)});
+  }
+
+  AnnotatedGraph graph(
+      graph::ForwardStarFactory::produce_directed_from_edges(1000, edges));
+  graph::DecoratorFactory factory;
+  factory.decorate_layers(
+      graph, edges,
+      factory.layer<CostGraph>([](auto const &edge) { return edge.weight; }),
+      factory.layer<DataCostGraph>(
+          [](auto const &edge) { return -edge.weight; }),
+      factory.layer<AnnotatedGraph>([](auto const &edge) {
+        return io::SerialisableContainer<std::string>(
+            std::to_string(edge.source));
+      }));
+
+  io::SectionWriter writer(path);
+  graph.serialise(writer);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(load_layers) {
+  store_graph("async.sgr");
+
+  for (std::size_t threads : {1, 4}) {
+    graph::AsyncLoader<AnnotatedGraph> loader("async.sgr", threads);
+    BOOST_CHECK_EQUAL(loader.progress().total_layers, 4);
+
+    auto const &routing_graph = loader.wait_for<CostGraph>();
+    BOOST_CHECK_EQUAL(routing_graph.number_of_nodes(), 1000);
+    BOOST_CHECK_EQUAL(routing_graph.number_of_edges(), 2000);
+    // the edges of node 1 have weights 1 and 2
+    BOOST_CHECK_EQUAL(routing_graph.cost(2) + routing_graph.cost(3), 3);
+    BOOST_CHECK(loader.progress().loaded_layers >= 2);
+
+    auto const &graph = loader.wait();
+    BOOST_CHECK_EQUAL(loader.progress().loaded_layers, 4);
+    for (EdgeID edge = 0; edge < graph.number_of_edges(); ++edge) {
+      BOOST_CHECK_EQUAL(graph.data(edge), -graph.cost(edge));
+      // edges are sorted by their source, two per node
+      BOOST_CHECK_EQUAL(graph.bytes(edge), std::to_string(edge / 2));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(missing_layers) {
+  {
+    std::vector<Edge> edges = {{0, 1, 5}};
+    CostGraph graph(
+        graph::ForwardStarFactory::produce_directed_from_edges(2, edges));
+    graph::DecoratorFactory().decorate(
+        graph, edges, [](auto const &edge) { return edge.weight; });
+    io::SectionWriter writer("async_costs.sgr");
+    graph.serialise(writer);
+  }
+
+  // the available layers can be used, waiting for the others fails
+  graph::AsyncLoader<AnnotatedGraph> loader("async_costs.sgr", 2);
+  BOOST_CHECK_EQUAL(loader.wait_for<CostGraph>().cost(0), 5);
+  BOOST_CHECK_THROW(loader.wait_for<DataCostGraph>(), std::out_of_range);
+  BOOST_CHECK_THROW(loader.wait(), std::out_of_range);
+}
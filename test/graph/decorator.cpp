@@ -4,11 +4,14 @@
 #include "graph/forward_star_factory.hpp"
 #include "graph/id.hpp"
 #include "io/file.hpp"
+#include "io/section.hpp"
 #include "io/wrappers.hpp"
 #include "log/logger.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <exception>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -81,3 +84,77 @@ BOOST_AUTO_TEST_CASE(check_annotations) {
 
   // query and verify all annotations for the graph
 }
+
+// decorating in parallel and in a single pass yields the serial decoration
+BOOST_AUTO_TEST_CASE(parallel_layers) {
+  std::vector<Edge> edges;
+  NodeID const number_of_nodes = 1000;
+  for (int i = 0; i < 100000; ++i)
+    edges.push_back(
+        {static_cast<NodeID>((std::uint64_t(i) * 7919) % number_of_nodes),
+         static_cast<NodeID>((std::uint64_t(i) * 104729) % number_of_nodes),
+         {i},
+         {2 * i}});
+
+  DataCostGraph serial(graph::ForwardStarFactory::produce_directed_from_edges(
+      number_of_nodes, edges));
+  graph::DecoratorFactory serial_factory(1);
+  serial_factory.decorate<CostGraph>(
+      serial, edges, [](auto const &edge) { return edge.cost; });
+  serial_factory.decorate<DataCostGraph>(
+      serial, edges, [](auto const &edge) { return edge.data; });
+
+  DataCostGraph parallel(
+      graph::ForwardStarFactory::produce_directed_from_edges(number_of_nodes,
+                                                             edges));
+  graph::DecoratorFactory parallel_factory(4);
+  parallel_factory.decorate_layers(
+      parallel, edges,
+      parallel_factory.layer<CostGraph>(
+          [](auto const &edge) { return edge.cost; }),
+      parallel_factory.layer<DataCostGraph>(
+          [](auto const &edge) { return edge.data; }));
+
+  BOOST_CHECK_EQUAL(parallel.number_of_edges(), edges.size());
+  for (EdgeID eid = 0; eid < edges.size(); ++eid) {
+    BOOST_CHECK_EQUAL(serial.cost(eid).weight, parallel.cost(eid).weight);
+    BOOST_CHECK_EQUAL(serial.data(eid).data, parallel.data(eid).data);
+    // edges are sorted by source when creating the graph
+    BOOST_CHECK_EQUAL(parallel.cost(eid).weight, 2 * edges[eid].data.data);
+  }
+}
+
+// sectioned files can be read as any prefix of the decorator stack
+BOOST_AUTO_TEST_CASE(sectioned_annotations) {
+  auto const graph = make_graph();
+  {
+    io::SectionWriter writer("decorated_graph.sgr");
+    graph.serialise(writer);
+  }
+
+  io::SectionReader reader("decorated_graph.sgr");
+  BOOST_CHECK(reader.contains("forward_star.offsets"));
+  BOOST_CHECK(reader.contains("cost.1"));
+  BOOST_CHECK(reader.contains("data.2"));
+  BOOST_CHECK(reader.contains("bytes.3"));
+
+  AnnotatedGraph read_graph;
+  read_graph.deserialise(reader);
+
+  // only the topology and the costs, skipping data and byte strings
+  CostGraph cost_graph;
+  cost_graph.deserialise(reader);
+
+  BOOST_CHECK_EQUAL(cost_graph.number_of_nodes(), graph.number_of_nodes());
+  BOOST_CHECK_EQUAL(cost_graph.number_of_edges(), graph.number_of_edges());
+  for (EdgeID eid = 0; eid < graph.number_of_edges(); ++eid) {
+    BOOST_CHECK_EQUAL(graph.cost(eid).weight, read_graph.cost(eid).weight);
+    BOOST_CHECK_EQUAL(graph.cost(eid).weight, cost_graph.cost(eid).weight);
+    BOOST_CHECK_EQUAL(graph.data(eid).data, read_graph.data(eid).data);
+    BOOST_CHECK_EQUAL(graph.bytes(eid), read_graph.bytes(eid));
+  }
+
+  // a data decorator is not stored directly on top of the forward star
+  graph::edge::DataDecorator<Data, graph::ForwardStar> data_graph;
+  BOOST_CHECK_THROW(data_graph.deserialise(reader), std::out_of_range);
+}
@@ -0,0 +1,131 @@
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/profile.hpp"
+#include "graph/routing.hpp"
+#include "graph/time_dependent.hpp"
+#include "io/file.hpp"
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Profile
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+std::uint32_t const hour = 60 * 60;
+}
+
+BOOST_AUTO_TEST_CASE(interpolation) {
+  graph::ProfileTable profiles;
+  BOOST_CHECK_EQUAL(profiles.size(), 1);
+  BOOST_CHECK_EQUAL(
+      profiles.travel_time(graph::ProfileTable::free_flow, 100, 8 * hour), 100);
+
+  // twice as slow at noon
+  auto const profile = profiles.add({1.0, 2.0});
+  BOOST_CHECK_EQUAL(profiles.travel_time(profile, 100, 0), 100);
+  BOOST_CHECK_EQUAL(profiles.travel_time(profile, 100, 6 * hour), 150);
+  BOOST_CHECK_EQUAL(profiles.travel_time(profile, 100, 12 * hour), 200);
+  // towards the first sample of the next day
+  BOOST_CHECK_EQUAL(profiles.travel_time(profile, 100, 18 * hour), 150);
+  BOOST_CHECK_EQUAL(profiles.travel_time(profile, 100, 30 * hour), 150);
+  BOOST_CHECK_EQUAL(profiles.travel_time(profile, 0, 12 * hour), 0);
+}
+
+BOOST_AUTO_TEST_CASE(shared_profiles) {
+  graph::ProfileTable profiles;
+  auto const first = profiles.add({1.0, 1.5, 2.0, 1.5});
+  auto const second = profiles.add({1.2, 1.2});
+  BOOST_CHECK_NE(first, second);
+  BOOST_CHECK_EQUAL(profiles.add({1.0, 1.5, 2.0, 1.5}), first);
+  BOOST_CHECK_EQUAL(profiles.add({1.0}), graph::ProfileTable::free_flow);
+  BOOST_CHECK_EQUAL(profiles.size(), 3);
+
+  BOOST_CHECK_THROW(profiles.add({}), std::invalid_argument);
+  BOOST_CHECK_THROW(profiles.add({1.0, 0.0}), std::invalid_argument);
+  BOOST_CHECK_THROW(profiles.add({1.0, 70.0}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(batch_evaluation) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> factor(0.8, 4.0);
+  std::uniform_int_distribution<std::size_t> samples(1, 96);
+  graph::ProfileTable profiles;
+  for (int profile = 0; profile < 50; ++profile) {
+    std::vector<double> factors(samples(generator));
+    for (auto &value : factors)
+      value = factor(generator);
+    profiles.add(factors);
+  }
+
+  std::uniform_int_distribution<graph::ProfileID> profile(
+      0, profiles.size() - 1);
+  std::uniform_int_distribution<std::uint32_t> time(0, 5000);
+  std::vector<graph::ProfileID> ids(1000);
+  std::vector<std::uint32_t> static_times(ids.size()), result(ids.size());
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    ids[i] = profile(generator);
+    static_times[i] = time(generator);
+  }
+
+  std::uniform_int_distribution<std::uint32_t> departure(0, 3 * 24 * hour);
+  for (int round = 0; round < 20; ++round) {
+    auto const at = departure(generator);
+    profiles.travel_times(ids.size(), ids.data(), static_times.data(), at,
+                          result.data());
+    for (std::size_t i = 0; i < ids.size(); ++i)
+      BOOST_CHECK_EQUAL(result[i],
+                        profiles.travel_time(ids[i], static_times[i], at));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(decorated_graph) {
+  struct Edge {
+    NodeID source, target;
+    graph::WeightTimeDistance cost;
+    graph::ProfileID profile;
+  };
+  graph::ProfileTable profiles;
+  auto const rush_hour = profiles.add({1.0, 1.0, 3.0, 1.0});
+  std::vector<Edge> edges{
+      {0, 1, {10, 100, 1000}, rush_hour},
+      {1, 2, {10, 100, 1000}, graph::ProfileTable::free_flow}};
+
+  graph::TimeDependentGraph graph =
+      graph::ForwardStarFactory::produce_directed_from_edges(3, edges);
+  graph::DecoratorFactory factory;
+  factory.decorate_layers(
+      graph, edges,
+      factory.layer<graph::RoutingGraph>(
+          [](auto const &edge) { return edge.cost; }),
+      factory.layer<graph::TimeDependentGraph>(
+          [](auto const &edge) { return edge.profile; }));
+  factory.attach_profiles(graph, std::move(profiles));
+
+  BOOST_CHECK_EQUAL(graph.travel_time(0, 0), 100);
+  BOOST_CHECK_EQUAL(graph.travel_time(0, 12 * hour), 300);
+  BOOST_CHECK_EQUAL(graph.travel_time(1, 12 * hour), 100);
+
+  io::File out_file("profiles.tdgr", io::mode::mWRITE | io::mode::mBINARY |
+                                         io::mode::mVERSIONED);
+  graph.serialise(out_file);
+  out_file.close();
+
+  graph::TimeDependentGraph read_graph;
+  io::File in_file("profiles.tdgr",
+                   io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  read_graph.deserialise(in_file);
+  BOOST_CHECK_EQUAL(read_graph.profile_id(0), rush_hour);
+  BOOST_CHECK_EQUAL(read_graph.cost(1).distance, 1000);
+  BOOST_CHECK_EQUAL(read_graph.travel_time(0, 12 * hour), 300);
+  // the restored table still deduplicates
+  auto table = read_graph.profiles();
+  BOOST_CHECK_EQUAL(table.add({1.0, 1.0, 3.0, 1.0}), rush_hour);
+}
@@ -0,0 +1,173 @@
+#include "algorithm/dijkstra.hpp"
+#include "fixture/graph.hpp"
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+#include "graph/traffic_overlay.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE TrafficOverlay
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+struct Edge {
+  NodeID source, target;
+  std::uint32_t time;
+};
+
+using Overlay = graph::TrafficOverlay<graph::RoutingGraph>;
+using Location = algorithm::Location<graph::WeightTimeDistance>;
+
+graph::WeightTimeDistance uniform(std::uint32_t const value) {
+  return {value, value, value};
+}
+
+// travel times are used as all costs, see test::make_graph
+graph::RoutingGraph make_graph(std::size_t const number_of_nodes,
+                               std::vector<Edge> &edges) {
+  return test::make_graph<graph::RoutingGraph>(
+      number_of_nodes, edges,
+      [](auto const &edge) { return uniform(edge.time); });
+}
+
+// the costs of the graph below the overlay
+graph::WeightTimeDistance const &base_cost(Overlay const &overlay,
+                                           EdgeID const eid) {
+  return static_cast<graph::RoutingGraph const &>(overlay).cost(eid);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(updates_and_folds) {
+  std::vector<Edge> edges{{0, 1, 10}, {1, 2, 20}, {2, 0, 30}};
+  Overlay overlay(make_graph(3, edges));
+  BOOST_CHECK(!overlay.overridden(1));
+  BOOST_CHECK_EQUAL(overlay.cost(1).time, 20);
+
+  overlay.update(1, uniform(200));
+  overlay.update(1, uniform(250));
+  BOOST_CHECK(overlay.overridden(1));
+  BOOST_CHECK_EQUAL(overlay.overrides(), 1);
+  BOOST_CHECK_EQUAL(overlay.cost(1).time, 250);
+  BOOST_CHECK_EQUAL(base_cost(overlay, 1).time, 20);
+  BOOST_CHECK_EQUAL(overlay.cost(0).time, 10);
+
+  overlay.fold();
+  BOOST_CHECK(!overlay.overridden(1));
+  BOOST_CHECK_EQUAL(overlay.overrides(), 0);
+  BOOST_CHECK_EQUAL(overlay.cost(1).time, 250);
+  BOOST_CHECK_EQUAL(base_cost(overlay, 1).time, 250);
+
+  BOOST_CHECK_THROW(overlay.update(3, uniform(1)), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(full_overlays_fold) {
+  std::vector<Edge> edges;
+  for (NodeID node = 0; node < 100; ++node)
+    edges.push_back({node, (node + 1) % 100, 1});
+  Overlay overlay(make_graph(100, edges), 8);
+
+  for (EdgeID eid = 0; eid < 100; ++eid) {
+    overlay.update(eid, uniform(eid + 2));
+    BOOST_CHECK_LE(overlay.overrides(), 8);
+  }
+  for (EdgeID eid = 0; eid < 100; ++eid)
+    BOOST_CHECK_EQUAL(overlay.cost(eid).weight, eid + 2);
+  overlay.fold();
+  for (EdgeID eid = 0; eid < 100; ++eid)
+    BOOST_CHECK_EQUAL(base_cost(overlay, eid).weight, eid + 2);
+}
+
+BOOST_AUTO_TEST_CASE(zero_capacity) {
+  std::vector<Edge> edges{{0, 1, 10}};
+  BOOST_CHECK_THROW(Overlay(make_graph(2, edges), 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(routes_follow_traffic) {
+  //  0 - (10) - 1 - (10) - 2
+  //   \                   /
+  //    ------- (30) ------
+  std::vector<Edge> edges{{0, 1, 10}, {1, 2, 10}, {0, 2, 30}};
+  Overlay overlay(make_graph(3, edges));
+  algorithm::Dijkstra<Overlay> dijkstra(overlay);
+  auto const free_flow =
+      dijkstra(Location{0, uniform(0)}, Location{2, uniform(0)});
+  BOOST_REQUIRE_EQUAL(free_flow.segments.size(), 2);
+
+  // a jam on the middle edge
+  for (EdgeID eid = 0; eid < edges.size(); ++eid)
+    if (edges[eid].source == 1)
+      overlay.update(eid, uniform(100));
+  auto const jammed =
+      dijkstra(Location{0, uniform(0)}, Location{2, uniform(0)});
+  BOOST_REQUIRE_EQUAL(jammed.segments.size(), 1);
+  BOOST_CHECK_EQUAL(jammed.segments[0].weight_at_end.time, 30);
+
+  overlay.fold();
+  auto const folded =
+      dijkstra(Location{0, uniform(0)}, Location{2, uniform(0)});
+  BOOST_CHECK_EQUAL(folded.segments.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_readers) {
+  // the costs of an edge are always eid + k * stride, with equal members, so
+  // torn or stale reads show up as mismatches
+  std::uint32_t const stride = 10000;
+  std::size_t const number_of_nodes = 2000;
+  std::vector<Edge> edges;
+  for (NodeID node = 0; node < number_of_nodes; ++node)
+    edges.push_back({node, (node + 1) % number_of_nodes, 0});
+  auto graph = make_graph(number_of_nodes, edges);
+  for (EdgeID eid = 0; eid < edges.size(); ++eid)
+    graph.cost(eid) = uniform(eid);
+  Overlay overlay(std::move(graph), 256);
+
+  std::atomic<bool> done(false);
+  std::atomic<std::size_t> mismatches(0);
+  std::vector<std::thread> readers;
+  for (int reader = 0; reader < 4; ++reader)
+    readers.emplace_back([&, reader]() {
+      std::mt19937 generator(reader);
+      std::uniform_int_distribution<EdgeID> edge(0, edges.size() - 1);
+      while (!done.load()) {
+        auto const reading = overlay.reader();
+        for (int lookup = 0; lookup < 1000; ++lookup) {
+          auto const eid = edge(generator);
+          auto const cost = overlay.cost(eid);
+          if (cost.weight != cost.time || cost.time != cost.distance ||
+              cost.weight % stride != eid)
+            ++mismatches;
+        }
+      }
+    });
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<EdgeID> edge(0, edges.size() - 1);
+  std::vector<std::uint32_t> expected(edges.size());
+  for (EdgeID eid = 0; eid < edges.size(); ++eid)
+    expected[eid] = eid;
+  for (int round = 1; round <= 200; ++round) {
+    for (int update = 0; update < 100; ++update) {
+      auto const eid = edge(generator);
+      expected[eid] = eid + round * stride;
+      overlay.update(eid, uniform(expected[eid]));
+    }
+    if (round % 20 == 0)
+      overlay.fold();
+  }
+  done = true;
+  for (auto &reader : readers)
+    reader.join();
+
+  BOOST_CHECK_EQUAL(mismatches.load(), 0);
+  for (EdgeID eid = 0; eid < edges.size(); ++eid)
+    BOOST_CHECK_EQUAL(overlay.cost(eid).weight, expected[eid]);
+}
@@ -0,0 +1,184 @@
+#include "graph/decorator.hpp"
+#include "graph/id_mapping.hpp"
+#include "graph/routing.hpp"
+#include "importer/importer.hpp"
+#include "importer/osm_xml.hpp"
+#include "importer/profile.hpp"
+#include "io/file.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Importer
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+// three nodes along the equator, one north of the first
+char const *const extract = R"(<?xml version="1.0" encoding="UTF-8"?>
+<osm version="0.6" generator="test">
+  <!-- <node id="5" lat="1" lon="1"/> -->
+  <node id="1" lat="0.0" lon="0.0"/>
+  <node id="2" lat="0.0" lon="0.01"/>
+  <node id="3" lat="0.0" lon="0.02">
+    <tag k="name" v="Tom &amp; Jerry"/>
+  </node>
+  <node id="4" lat="0.01" lon="0.0"/>
+  <way id="10">
+    <nd ref="1"/>
+    <nd ref="2"/>
+    <nd ref="3"/>
+    <tag k="highway" v="primary"/>
+  </way>
+  <way id="11">
+    <nd ref="1"/>
+    <nd ref="4"/>
+    <nd ref="4"/>
+    <tag k="highway" v="residential"/>
+    <tag k="oneway" v="yes"/>
+  </way>
+  <way id="12">
+    <nd ref="2"/>
+    <nd ref="4"/>
+    <tag k="highway" v="footway"/>
+  </way>
+  <way id="13">
+    <nd ref="3"/>
+    <nd ref="99"/>
+    <tag k="highway" v="primary"/>
+  </way>
+  <relation id="20">
+    <member type="way" ref="10" role=""/>
+  </relation>
+</osm>
+)";
+} // namespace
+
+BOOST_AUTO_TEST_CASE(parse_xml) {
+  std::istringstream input(extract);
+  importer::OSMXMLParser parser(input);
+
+  std::vector<importer::OSMNode> nodes;
+  std::vector<importer::OSMWay> ways;
+  parser.parse([&](auto const &node) { nodes.push_back(node); },
+               [&](auto const &way) { ways.push_back(way); });
+
+  BOOST_CHECK_EQUAL(nodes.size(), 4);
+  BOOST_CHECK_EQUAL(nodes[1].id, 2);
+  BOOST_CHECK_EQUAL(nodes[1].coordinate.longitude,
+                    geometry::FixedWGSLongitude{
+                        geometry::coordinate::to_fixed(0.01)});
+
+  BOOST_CHECK_EQUAL(ways.size(), 4);
+  BOOST_CHECK_EQUAL(ways[0].id, 10);
+  BOOST_CHECK_EQUAL(ways[0].nodes.size(), 3);
+  BOOST_CHECK_EQUAL(ways[0].nodes[2], 3);
+  BOOST_CHECK_EQUAL(*importer::find_tag(ways[1].tags, "oneway"), "yes");
+  BOOST_CHECK(!importer::find_tag(ways[1].tags, "name"));
+}
+
+BOOST_AUTO_TEST_CASE(car_profile) {
+  importer::CarProfile profile;
+  BOOST_CHECK(!profile.evaluate({{"highway", "footway"}}));
+  BOOST_CHECK(!profile.evaluate({{"name", "Main Street"}}));
+  BOOST_CHECK(!profile.evaluate({{"highway", "primary"}, {"access", "no"}}));
+
+  auto const primary = profile.evaluate({{"highway", "primary"}});
+  BOOST_CHECK(primary);
+  BOOST_CHECK_EQUAL(primary->speed, 50);
+  BOOST_CHECK(primary->forward && primary->backward);
+  BOOST_CHECK_EQUAL(primary->road_class, "primary");
+
+  auto const limited =
+      profile.evaluate({{"highway", "primary"}, {"maxspeed", "30"}});
+  BOOST_CHECK_EQUAL(limited->speed, 30);
+  // limits are converted into km/h, unknown values are ignored
+  auto const speed_limit = [&](std::string const &maxspeed) {
+    return profile.evaluate({{"highway", "motorway"}, {"maxspeed", maxspeed}})
+        ->speed;
+  };
+  BOOST_CHECK_CLOSE(speed_limit("30 mph"), 48.28032, 1e-6);
+  BOOST_CHECK_CLOSE(speed_limit("40mph"), 64.37376, 1e-6);
+  BOOST_CHECK_CLOSE(speed_limit("10 knots"), 18.52, 1e-6);
+  BOOST_CHECK_EQUAL(speed_limit("70 km/h"), 70);
+  BOOST_CHECK_EQUAL(speed_limit("60;40"), 60);
+  BOOST_CHECK_EQUAL(speed_limit("none"), 90);
+  BOOST_CHECK_EQUAL(speed_limit("DE:urban"), 90);
+  BOOST_CHECK_EQUAL(speed_limit("50 furlongs"), 90);
+
+  auto const reverse =
+      profile.evaluate({{"highway", "residential"}, {"oneway", "-1"}});
+  BOOST_CHECK(!reverse->forward && reverse->backward);
+
+  auto const motorway = profile.evaluate({{"highway", "motorway"}});
+  BOOST_CHECK(motorway->forward && !motorway->backward);
+}
+
+BOOST_AUTO_TEST_CASE(import_extract) {
+  // the result must not depend on the number of threads or batches
+  for (std::size_t threads : {1, 3}) {
+    std::istringstream input(extract);
+    importer::ImportGraph builder;
+    importer::ImportOptions options;
+    options.threads = threads;
+    options.batch_size = 1;
+    auto const statistics =
+        importer::import_osm(input, builder, importer::CarProfile(), options);
+    BOOST_CHECK_EQUAL(statistics.nodes, 4);
+    BOOST_CHECK_EQUAL(statistics.ways, 3);
+    // two bidirectional segments and a oneway, way 13 leaves the extract. The
+    // repeated node of way 11 adds no self-loop
+    BOOST_CHECK_EQUAL(statistics.edges, 5);
+
+    builder.build_annotated_graph_and_store<graph::WeightTimeDistance>(
+        "import.gr");
+    builder.store_id_mapping("import.map");
+
+    graph::edge::DictionaryDecorator<std::string, graph::RoutingGraph> graph;
+    {
+      io::File in("import.gr",
+                  io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+      graph.deserialise(in);
+    }
+    graph::IDMapping mapping;
+    {
+      io::File in("import.map",
+                  io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+      mapping.deserialise(in);
+    }
+    BOOST_CHECK_EQUAL(graph.number_of_nodes(), 4);
+    BOOST_CHECK_EQUAL(graph.number_of_edges(), 5);
+
+    auto const node_1 = *mapping.node_id(1);
+    auto const node_2 = *mapping.node_id(2);
+    auto const node_4 = *mapping.node_id(4);
+
+    // the oneway can only be used from 1 to 4
+    BOOST_CHECK_EQUAL(graph.edges(node_1).size(), 2);
+    BOOST_CHECK_EQUAL(graph.edges(node_4).size(), 0);
+    BOOST_CHECK_EQUAL(graph.edges(node_2).size(), 2);
+
+    for (auto edge = graph.edges_begin(node_1); edge != graph.edges_end(node_1);
+         ++edge) {
+      auto const id = graph.edge_id(edge);
+      // 0.01 degrees along the equator/meridian ~1112m
+      BOOST_CHECK_CLOSE(graph.cost(id).distance / 10.0, 1112.2, 0.1);
+      if (*edge == node_2) {
+        BOOST_CHECK_EQUAL(graph.payload(id), "primary");
+        // 50 km/h
+        BOOST_CHECK_EQUAL(graph.cost(id).time, 801);
+      } else {
+        BOOST_CHECK_EQUAL(*edge, node_4);
+        BOOST_CHECK_EQUAL(graph.payload(id), "residential");
+        // 30 km/h
+        BOOST_CHECK_EQUAL(graph.cost(id).time, 1335);
+      }
+      BOOST_CHECK_EQUAL(graph.cost(id).weight, graph.cost(id).time);
+    }
+  }
+}
@@ -0,0 +1,191 @@
+#include "io/block_codec.hpp"
+#include "io/exceptions.hpp"
+#include "io/file.hpp"
+#include "io/section.hpp"
+#include "io/wrappers.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE BlockCodec
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+template <typename container_type>
+container_type roundtrip(container_type const &values,
+                         std::size_t const threads) {
+  {
+    io::File out("block_codec.tmp", io::mode::mWRITE | io::mode::mBINARY);
+    out.set_threads(threads);
+    out.write_compressed_container(values);
+  }
+  container_type result;
+  io::File in("block_codec.tmp", io::mode::mREAD | io::mode::mBINARY);
+  in.set_threads(threads);
+  in.read_compressed_container(result);
+  return result;
+}
+
+template <typename container_type>
+std::uint64_t compressed_size(container_type const &values) {
+  io::File out("block_codec.tmp", io::mode::mWRITE | io::mode::mBINARY);
+  out.write_compressed_container(values);
+  return out.tell();
+}
+
+template <typename container_type>
+void check_roundtrip(container_type const &values) {
+  for (std::size_t threads : {1, 3, 8}) {
+    auto const result = roundtrip(values, threads);
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(),
+                                  result.begin(), result.end());
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(sequences) {
+  std::mt19937_64 generator(42);
+
+  // sizes around (multiples of) the block size
+  for (std::size_t size : {0, 1, 2, 1023, 1024, 1025, 5000, 100000}) {
+    std::vector<std::uint64_t> offsets(size);
+    std::vector<std::uint64_t> targets(size);
+    std::vector<std::uint64_t> full_range(size);
+    std::vector<std::uint32_t> constant(size, 7);
+    std::vector<std::int32_t> signed_values(size);
+    std::uint64_t offset = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      offset += generator() % 6;
+      offsets[i] = offset;
+      targets[i] = generator() % 1000000;
+      full_range[i] = generator();
+      signed_values[i] = static_cast<std::int32_t>(generator() % 2001) - 1000;
+    }
+    // extreme values need the full width of differences
+    if (size > 2) {
+      full_range[0] = 0;
+      full_range[1] = std::numeric_limits<std::uint64_t>::max();
+      signed_values[0] = std::numeric_limits<std::int32_t>::min();
+      signed_values[1] = std::numeric_limits<std::int32_t>::max();
+    }
+
+    check_roundtrip(offsets);
+    check_roundtrip(targets);
+    check_roundtrip(full_range);
+    check_roundtrip(constant);
+    check_roundtrip(signed_values);
+  }
+  std::remove("block_codec.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(compression) {
+  std::mt19937_64 generator(7);
+  std::vector<std::uint64_t> offsets(1 << 16);
+  std::vector<std::uint64_t> targets(1 << 16);
+  std::uint64_t offset = 0;
+  for (std::size_t i = 0; i < offsets.size(); ++i) {
+    offset += generator() % 8;
+    offsets[i] = offset;
+    targets[i] = generator() % (1 << 20);
+  }
+  auto const raw_size = offsets.size() * sizeof(std::uint64_t);
+
+  // three bits per offset, twenty bits per target, plus framing
+  BOOST_CHECK_LT(compressed_size(offsets), raw_size / 16);
+  BOOST_CHECK_LT(compressed_size(targets), raw_size / 3 + raw_size / 50);
+  BOOST_CHECK_LT(compressed_size(std::vector<std::uint64_t>(1 << 16, 1)),
+                 raw_size / 100);
+  std::remove("block_codec.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(corrupted_blocks) {
+  std::vector<std::uint32_t> values = {1, 5, 9, 13};
+  std::vector<char> block;
+  io::BlockCodec<std::uint32_t>::encode_block(values.data(), values.size(),
+                                              block);
+
+  std::vector<std::uint32_t> result(values.size());
+  io::BlockCodec<std::uint32_t>::decode_block(block.data(), block.size(),
+                                              values.size(), result.data());
+  BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), result.begin(),
+                                result.end());
+
+  BOOST_CHECK_THROW(io::BlockCodec<std::uint32_t>::decode_block(
+                        block.data(), block.size() - 1, values.size(),
+                        result.data()),
+                    io::InvalidFormat);
+  block[0] = 5;
+  BOOST_CHECK_THROW(io::BlockCodec<std::uint32_t>::decode_block(
+                        block.data(), block.size(), values.size(),
+                        result.data()),
+                    io::InvalidFormat);
+  BOOST_CHECK_THROW(io::BlockCodec<std::uint32_t>::encode_block(
+                        values.data(), 0, block),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(compressed_mode) {
+  std::vector<std::uint64_t> numbers(3000);
+  for (std::size_t i = 0; i < numbers.size(); ++i)
+    numbers[i] = 3 * i;
+  std::vector<io::SerialisableContainer<std::string>> strings = {{"a"},
+                                                                 {"bc"}};
+
+  {
+    io::File out("compressed_mode.tmp", io::mode::mWRITE | io::mode::mBINARY |
+                                            io::mode::mCOMPRESSED);
+    BOOST_CHECK(out.compressed());
+    out.write_container(numbers);
+    out.write_container(strings);
+    BOOST_CHECK_LT(out.tell(), numbers.size());
+  }
+
+  std::vector<std::uint64_t> read_numbers;
+  std::vector<io::SerialisableContainer<std::string>> read_strings;
+  io::File in("compressed_mode.tmp", io::mode::mREAD | io::mode::mBINARY |
+                                         io::mode::mCOMPRESSED);
+  in.read_container(read_numbers);
+  in.read_container(read_strings);
+  BOOST_CHECK(numbers == read_numbers);
+  BOOST_CHECK_EQUAL(read_strings.size(), strings.size());
+  BOOST_CHECK_EQUAL(read_strings[1].wrapped_object, "bc");
+  std::remove("compressed_mode.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(block_packed_sections) {
+  std::vector<std::uint64_t> numbers(5000);
+  for (std::size_t i = 0; i < numbers.size(); ++i)
+    numbers[i] = i / 3;
+  std::vector<io::SerialisableContainer<std::string>> strings = {{"x"}};
+
+  {
+    io::SectionWriter writer("packed_sections.tmp", 64,
+                             io::Encoding::BLOCK_PACKED);
+    writer.write("numbers", numbers);
+    writer.write("strings", strings);
+  }
+
+  io::SectionReader reader("packed_sections.tmp");
+  reader.set_threads(4);
+  BOOST_CHECK(reader.section("numbers").encoding ==
+              io::Encoding::BLOCK_PACKED);
+  BOOST_CHECK_LT(reader.section("numbers").size,
+                 numbers.size() * sizeof(std::uint64_t) / 8);
+
+  std::vector<std::uint64_t> read_numbers;
+  reader.read("numbers", read_numbers);
+  BOOST_CHECK(numbers == read_numbers);
+  std::vector<io::SerialisableContainer<std::string>> read_strings;
+  reader.read("strings", read_strings);
+  BOOST_CHECK_EQUAL(read_strings.front().wrapped_object, "x");
+  reader.verify_all(2);
+  std::remove("packed_sections.tmp");
+}
@@ -0,0 +1,127 @@
+#include "io/chunked_writer.hpp"
+#include "io/file.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE ChunkedWriter
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+std::string contents(std::string const &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+struct Cost {
+  std::uint32_t weight;
+  float time;
+};
+
+void write_and_read(io::mode::Enum const mode) {
+  // spans multiple chunks and a partial block
+  std::uint64_t const size = 3 * (1 << 16) + 17;
+  {
+    io::File out("chunked.tmp", io::mode::mWRITE | io::mode::mBINARY | mode);
+    io::ChunkedWriter<std::uint64_t> numbers(out);
+    std::vector<std::uint64_t> batch;
+    // alternate between single values and batches of different sizes
+    for (std::uint64_t i = 0; i < size; ++i) {
+      if (i % 1000 == 0) {
+        numbers.append(batch.data(), batch.size());
+        batch.clear();
+        numbers.push_back(i * i);
+      } else {
+        batch.push_back(i * i);
+      }
+    }
+    numbers.append(batch.data(), batch.size());
+    BOOST_CHECK_EQUAL(numbers.size(), size);
+    numbers.finish();
+
+    { io::ChunkedWriter<std::uint32_t> empty(out); }
+
+    io::ChunkedWriter<Cost> costs(out);
+    costs.push_back({1, 0.5});
+    costs.push_back({2, 1.5});
+    costs.finish();
+    out.write_pod(std::uint32_t(42));
+  }
+
+  io::File in("chunked.tmp", io::mode::mREAD | io::mode::mBINARY | mode);
+  std::vector<std::uint64_t> numbers;
+  in.read_container(numbers);
+  BOOST_CHECK_EQUAL(numbers.size(), size);
+  bool ordered = true;
+  for (std::uint64_t i = 0; i < numbers.size(); ++i)
+    ordered = ordered && numbers[i] == i * i;
+  BOOST_CHECK(ordered);
+
+  std::vector<std::uint32_t> empty = {1};
+  in.read_container(empty);
+  BOOST_CHECK(empty.empty());
+
+  std::vector<Cost> costs;
+  in.read_container(costs);
+  BOOST_CHECK_EQUAL(costs.size(), 2);
+  BOOST_CHECK_EQUAL(costs[1].weight, 2);
+  BOOST_CHECK_EQUAL(costs[1].time, 1.5);
+
+  std::uint32_t trailer = 0;
+  in.read_pod(trailer);
+  BOOST_CHECK_EQUAL(trailer, 42);
+  std::remove("chunked.tmp");
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(raw) { write_and_read(0); }
+
+BOOST_AUTO_TEST_CASE(compressed) { write_and_read(io::mode::mCOMPRESSED); }
+
+BOOST_AUTO_TEST_CASE(matches_write_container) {
+  std::vector<std::uint32_t> values(5000);
+  for (std::uint32_t i = 0; i < values.size(); ++i)
+    values[i] = i * 7 % 1000;
+
+  for (auto const mode : {io::mode::Enum(0), io::mode::mCOMPRESSED}) {
+    {
+      io::File out("streamed.tmp",
+                   io::mode::mWRITE | io::mode::mBINARY | mode);
+      io::ChunkedWriter<std::uint32_t> writer(out);
+      writer.append(values.data(), values.size());
+    }
+    {
+      io::File out("written.tmp", io::mode::mWRITE | io::mode::mBINARY | mode);
+      out.write_container(values);
+    }
+    BOOST_CHECK(contents("streamed.tmp") == contents("written.tmp"));
+  }
+  std::remove("streamed.tmp");
+  std::remove("written.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(no_checksums) {
+  io::File out("checksummed.tmp", io::mode::mWRITE | io::mode::mBINARY);
+  out.start_checksum();
+  BOOST_CHECK_THROW(io::ChunkedWriter<std::uint64_t> writer(out),
+                    std::logic_error);
+  out.stop_checksum();
+  std::remove("checksummed.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(no_append) {
+  io::File out("appended.tmp", io::mode::mAPPEND | io::mode::mBINARY);
+  BOOST_CHECK_THROW(io::ChunkedWriter<std::uint64_t> writer(out),
+                    std::logic_error);
+  out.close();
+  std::remove("appended.tmp");
+}
@@ -0,0 +1,45 @@
+#include "io/crc32c.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE CRC32C
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+BOOST_AUTO_TEST_CASE(known_values) {
+  std::string const check = "123456789";
+  BOOST_CHECK_EQUAL(io::crc32c(check.data(), check.size()), 0xe3069283);
+  BOOST_CHECK_EQUAL(io::crc32c_portable(check.data(), check.size()),
+                    0xe3069283);
+  BOOST_CHECK_EQUAL(io::crc32c(nullptr, 0), 0);
+
+  // 32 bytes of zeros, from RFC 3720 (iSCSI)
+  std::vector<std::uint8_t> zeros(32, 0);
+  BOOST_CHECK_EQUAL(io::crc32c(zeros.data(), zeros.size()), 0x8a9136aa);
+}
+
+// hardware, portable and chained computations agree for all lengths and
+// alignments
+BOOST_AUTO_TEST_CASE(consistency) {
+  std::vector<std::uint8_t> data(1000);
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<std::uint8_t>(i * 31 + 7);
+
+  for (std::size_t offset = 0; offset < 8; ++offset) {
+    for (std::size_t size = 0; size + offset <= data.size(); size += 37) {
+      auto const expected = io::crc32c_portable(data.data() + offset, size);
+      BOOST_CHECK_EQUAL(io::crc32c(data.data() + offset, size), expected);
+
+      auto const split = size / 3;
+      auto const chained = io::crc32c(
+          data.data() + offset + split, size - split,
+          io::crc32c(data.data() + offset, split));
+      BOOST_CHECK_EQUAL(chained, expected);
+    }
+  }
+}
@@ -1,13 +1,18 @@
 #include "io/file.hpp"
+#include "container/default_init_allocator.hpp"
 #include "io/exceptions.hpp"
 #include "io/serialisable.hpp"
 #include "log/logger.hpp"
 #include "version.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
 #include <exception>
 #include <fstream>
+#include <iterator>
 #include <sstream>
+#include <string>
 #include <vector>
 
 // make sure we get a new main function here
@@ -27,9 +32,10 @@ BOOST_AUTO_TEST_CASE(version_mismatch) {
     std::uint32_t major;
     std::uint32_t minor;
     std::uint32_t patch;
+    std::uint32_t flags;
   };
 
-  VersionHeader header = {version_major, version_minor, version_patch};
+  VersionHeader header = {version_major, version_minor, version_patch, 0};
   std::ofstream ofs("exact.tmp", std::ios::binary);
   ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
   ofs.close();
@@ -98,6 +104,109 @@ BOOST_AUTO_TEST_CASE(version_mismatch) {
   BOOST_CHECK(oss3.str().size() > 0);
 }
 
+BOOST_AUTO_TEST_CASE(format_flags) {
+  std::vector<std::uint32_t> data(1000);
+  for (std::uint32_t i = 0; i < data.size(); ++i)
+    data[i] = 3 * i;
+  {
+    io::File out("compressed.tmp", io::mode::mWRITE | io::mode::mBINARY |
+                                       io::mode::mVERSIONED |
+                                       io::mode::mCOMPRESSED);
+    out.write_container(data);
+  }
+  {
+    io::File out("raw.tmp",
+                 io::mode::mWRITE | io::mode::mBINARY | io::mode::mVERSIONED);
+    out.write_container(data);
+  }
+
+  // readers switch to the mode recorded in the file
+  io::File in("compressed.tmp",
+              io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+  BOOST_CHECK(in.compressed());
+  std::vector<std::uint32_t> read;
+  in.read_container(read);
+  BOOST_CHECK(read == data);
+
+  BOOST_CHECK_THROW(io::File("raw.tmp", io::mode::mREAD | io::mode::mBINARY |
+                                            io::mode::mVERSIONED |
+                                            io::mode::mCOMPRESSED),
+                    io::InvalidFormat);
+
+  // unknown flags
+  {
+    std::fstream file("raw.tmp",
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(3 * sizeof(std::uint32_t));
+    std::uint32_t const flags = 1 << 31;
+    file.write(reinterpret_cast<char const *>(&flags), sizeof(flags));
+  }
+  BOOST_CHECK_THROW(io::File("raw.tmp", io::mode::mREAD | io::mode::mBINARY |
+                                            io::mode::mVERSIONED),
+                    io::InvalidFormat);
+  std::remove("compressed.tmp");
+  std::remove("raw.tmp");
+}
+
+namespace {
+std::string contents(std::string const &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), {});
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(trailing_checksum) {
+  std::vector<std::uint64_t> data(1000);
+  for (std::uint64_t i = 0; i < data.size(); ++i)
+    data[i] = i * i;
+  auto const write = [&data] {
+    io::File out("checksummed.tmp", io::mode::mWRITE | io::mode::mBINARY |
+                                        io::mode::mVERSIONED);
+    out.write_pod(std::uint64_t(0));
+    out.write_pod_container(data);
+    // patching a value recomputes the checksum on closing
+    out.seek(out.tell() - data.size() * sizeof(std::uint64_t) -
+             2 * sizeof(std::uint64_t));
+    out.write_pod(std::uint64_t(42));
+  };
+  auto const read = [&data] {
+    io::File in("checksummed.tmp",
+                io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+    std::uint64_t value = 0;
+    in.read_pod(value);
+    BOOST_CHECK_EQUAL(value, 42);
+    std::vector<std::uint64_t> read_data;
+    in.read_pod_container(read_data);
+    BOOST_CHECK(read_data == data);
+  };
+  write();
+  BOOST_CHECK_NO_THROW(read());
+
+  // a flipped bit is detected once all data has been read
+  auto const written = contents("checksummed.tmp");
+  auto flipped = written;
+  flipped[flipped.size() / 2] ^= 0x10;
+  std::ofstream("checksummed.tmp", std::ios::binary) << flipped;
+  BOOST_CHECK_THROW(read(), io::ChecksumMismatch);
+
+  // as is a truncated file, before reading beyond its end
+  std::ofstream("checksummed.tmp", std::ios::binary)
+      << written.substr(0, written.size() - 100);
+  BOOST_CHECK_THROW(read(), io::ChecksumMismatch);
+
+  // opting out
+  {
+    io::File out("checksummed.tmp", io::mode::mWRITE | io::mode::mBINARY |
+                                        io::mode::mVERSIONED |
+                                        io::mode::mNO_CHECKSUM);
+    out.write_pod_container(data);
+  }
+  BOOST_CHECK_EQUAL(contents("checksummed.tmp").size(),
+                    4 * sizeof(std::uint32_t) + sizeof(std::uint64_t) +
+                        data.size() * sizeof(std::uint64_t));
+  std::remove("checksummed.tmp");
+}
+
 BOOST_AUTO_TEST_CASE(unversioned_vector_reading) {
   // plain data, no versioning happening
   std::vector<int> data = {42, 1, 42, 1, 42};
@@ -174,3 +283,34 @@ BOOST_AUTO_TEST_CASE(serialisable_vectors) {
     }
   }
 }
+
+// containers larger than a read chunk, with and without initialisation
+BOOST_AUTO_TEST_CASE(chunked_pod_vectors) {
+  std::vector<std::uint64_t> data(300000);
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = i * i;
+  std::string text(3000000, 'x');
+  text[2999999] = 'y';
+  {
+    io::File file("chunked.tmp", io::mode::mWRITE | io::mode::mBINARY);
+    file.write_container(data);
+    file.write_container(data);
+    file.write_pod_container(text);
+  }
+
+  io::File file("chunked.tmp", io::mode::mREAD | io::mode::mBINARY);
+  std::vector<std::uint64_t> values = {1, 2, 3};
+  file.read_container(values);
+  BOOST_CHECK(values == data);
+
+  std::vector<std::uint64_t,
+              container::DefaultInitAllocator<std::uint64_t>>
+      uninitialised;
+  file.read_container(uninitialised);
+  BOOST_CHECK(std::equal(data.begin(), data.end(), uninitialised.begin(),
+                         uninitialised.end()));
+
+  std::string read_text;
+  file.read_pod_container(read_text);
+  BOOST_CHECK(read_text == text);
+}
@@ -0,0 +1,150 @@
+#include "io/exceptions.hpp"
+#include "io/file.hpp"
+#include "io/section.hpp"
+#include "io/wrappers.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Section
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+BOOST_AUTO_TEST_CASE(seek_and_tell) {
+  {
+    io::File out("seek.tmp", io::mode::mWRITE | io::mode::mBINARY);
+    BOOST_CHECK_EQUAL(out.tell(), 0);
+    for (std::uint32_t i = 0; i < 10; ++i)
+      out.write_pod(i);
+    BOOST_CHECK_EQUAL(out.tell(), 10 * sizeof(std::uint32_t));
+    BOOST_CHECK_EQUAL(out.size(), 10 * sizeof(std::uint32_t));
+  }
+
+  io::File in("seek.tmp", io::mode::mREAD | io::mode::mBINARY);
+  in.seek(7 * sizeof(std::uint32_t));
+  std::uint32_t value = 0;
+  in.read_pod(value);
+  BOOST_CHECK_EQUAL(value, 7);
+  BOOST_CHECK_EQUAL(in.tell(), 8 * sizeof(std::uint32_t));
+  in.seek(0);
+  in.read_pod(value);
+  BOOST_CHECK_EQUAL(value, 0);
+}
+
+BOOST_AUTO_TEST_CASE(write_and_read_sections) {
+  std::vector<std::uint64_t> numbers = {1, 2, 3, 4, 5};
+  std::vector<io::SerialisableContainer<std::string>> strings = {
+      {"hello"}, {""}, {"world"}};
+  std::vector<char> empty;
+
+  {
+    io::SectionWriter writer("sections.tmp", 128);
+    writer.write("numbers", numbers);
+    writer.write("empty", empty);
+    writer.write("strings", strings);
+    auto &file = writer.begin("raw");
+    file.write_pod(std::uint32_t(42));
+    writer.end();
+    BOOST_CHECK_THROW(writer.begin("numbers"), std::invalid_argument);
+    writer.finish();
+    BOOST_CHECK_THROW(writer.begin("late"), std::logic_error);
+  }
+
+  io::SectionReader reader("sections.tmp");
+  BOOST_CHECK_EQUAL(reader.sections().size(), 4);
+  for (auto const &section : reader.sections())
+    BOOST_CHECK_EQUAL(section.offset % 128, 0);
+  BOOST_CHECK(reader.contains("strings"));
+  BOOST_CHECK(!reader.contains("missing"));
+  BOOST_CHECK_EQUAL(reader.section("raw").size, sizeof(std::uint32_t));
+  BOOST_CHECK_EQUAL(reader.section("numbers").size,
+                    sizeof(std::uint64_t) * (1 + numbers.size()));
+
+  // sections can be read in any order
+  std::vector<io::SerialisableContainer<std::string>> read_strings;
+  reader.read("strings", read_strings);
+  BOOST_CHECK_EQUAL(read_strings.size(), 3);
+  BOOST_CHECK_EQUAL(read_strings[2].wrapped_object, "world");
+
+  std::vector<std::uint64_t> read_numbers;
+  reader.read("numbers", read_numbers);
+  BOOST_CHECK_EQUAL_COLLECTIONS(read_numbers.begin(), read_numbers.end(),
+                                numbers.begin(), numbers.end());
+
+  std::uint32_t raw = 0;
+  reader.open("raw").read_pod(raw);
+  BOOST_CHECK_EQUAL(raw, 42);
+
+  BOOST_CHECK_THROW(reader.open("missing"), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(reject_unsectioned_files) {
+  {
+    io::File out("plain.tmp",
+                 io::mode::mWRITE | io::mode::mBINARY | io::mode::mVERSIONED);
+    out.write_container(std::vector<std::uint64_t>(10, 7));
+  }
+  BOOST_CHECK_THROW(io::SectionReader("plain.tmp"), io::InvalidFormat);
+
+  {
+    io::File out("short.tmp",
+                 io::mode::mWRITE | io::mode::mBINARY | io::mode::mVERSIONED);
+  }
+  BOOST_CHECK_THROW(io::SectionReader("short.tmp"), io::InvalidFormat);
+}
+
+BOOST_AUTO_TEST_CASE(detect_corruption) {
+  std::vector<std::uint32_t> numbers(100000);
+  for (std::uint32_t i = 0; i < numbers.size(); ++i)
+    numbers[i] = i;
+  {
+    io::SectionWriter writer("corrupt.tmp");
+    writer.write("first", numbers);
+    writer.write("second", numbers);
+    writer.write("third", numbers);
+  }
+
+  std::uint64_t offset = 0;
+  {
+    io::SectionReader reader("corrupt.tmp");
+    BOOST_CHECK(reader.verify("second"));
+    BOOST_CHECK_NO_THROW(reader.verify_all(3));
+    offset = reader.section("second").offset;
+    BOOST_CHECK_EQUAL(reader.section("first").checksum,
+                      reader.section("third").checksum);
+  }
+
+  // flip a single bit in the middle of the second section
+  {
+    std::fstream file("corrupt.tmp",
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(offset + 1000);
+    char byte = 0;
+    file.read(&byte, 1);
+    byte ^= 0x10;
+    file.seekp(offset + 1000);
+    file.write(&byte, 1);
+  }
+
+  io::SectionReader reader("corrupt.tmp");
+  BOOST_CHECK(reader.verify("first"));
+  BOOST_CHECK(!reader.verify("second"));
+  BOOST_CHECK_THROW(reader.verify_all(3), io::ChecksumMismatch);
+
+  std::vector<std::uint32_t> read_numbers;
+  reader.read("first", read_numbers);
+  BOOST_CHECK_EQUAL(read_numbers.size(), numbers.size());
+  BOOST_CHECK_THROW(reader.read("second", read_numbers),
+                    io::ChecksumMismatch);
+
+  // without verification, the corrupted data is read as is
+  io::SectionReader unchecked("corrupt.tmp", 0, false);
+  BOOST_CHECK_NO_THROW(unchecked.read("second", read_numbers));
+  BOOST_CHECK(read_numbers != numbers);
+}
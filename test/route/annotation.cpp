@@ -0,0 +1,174 @@
+#include "algorithm/dijkstra.hpp"
+#include "container/dictionary.hpp"
+#include "graph/decorator.hpp"
+#include "graph/decorator_factory.hpp"
+#include "graph/forward_star_factory.hpp"
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+#include "route/annotation.hpp"
+#include "route/route.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE Annotation
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+// counts allocations, to check that annotating does not allocate
+namespace {
+std::size_t allocations = 0;
+}
+
+void *operator new(std::size_t const size) {
+  ++allocations;
+  if (auto memory = std::malloc(size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+namespace {
+using NamedGraph =
+    graph::edge::DictionaryDecorator<std::string, graph::RoutingGraph>;
+
+struct Edge {
+  NodeID source, target;
+  container::DictionaryID name;
+};
+
+// a path 0 -> 1 -> ... along the named edges
+NamedGraph make_path(std::vector<std::string> const &names) {
+  container::Dictionary<std::string> dictionary;
+  std::vector<Edge> edges;
+  for (NodeID node = 0; node < names.size(); ++node)
+    edges.push_back({node, node + 1, dictionary.intern(names[node])});
+  NamedGraph graph = graph::ForwardStarFactory::produce_directed_from_edges(
+      names.size() + 1, edges);
+  graph::DecoratorFactory factory;
+  factory.decorate<graph::RoutingGraph>(graph, edges, [](auto const &) {
+    return graph::WeightTimeDistance{1, 1, 1};
+  });
+  factory.decorate<NamedGraph>(
+      graph, edges, [](auto const &edge) { return edge.name; },
+      std::move(dictionary));
+  return graph;
+}
+
+route::Route<int> route_along(std::size_t const segments) {
+  route::Route<int> route;
+  for (EdgeID eid = 0; eid < segments; ++eid)
+    route.segments.push_back({static_cast<int>(eid + 1), eid});
+  return route;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(json_runs) {
+  auto const graph = make_path({"Main", "Main", "Elm", "Main", "Main"});
+  algorithm::Dijkstra<graph::RoutingGraph> dijkstra(graph);
+  using Location = algorithm::Location<graph::WeightTimeDistance>;
+  auto const route = dijkstra(Location{0, {0, 0, 0}}, Location{5, {0, 0, 0}});
+  BOOST_REQUIRE_EQUAL(route.segments.size(), 5);
+
+  char memory[256];
+  route::OutputBuffer buffer(memory, sizeof(memory));
+  route::JsonAnnotationWriter writer(buffer);
+  auto const names = route::annotate(
+      route, [&](EdgeID eid) -> auto const & { return graph.payload(eid); },
+      writer);
+  BOOST_CHECK_EQUAL(names, 3);
+  BOOST_CHECK_EQUAL(buffer.view(), "[{\"segments\":2,\"value\":\"Main\"},"
+                                   "{\"segments\":1,\"value\":\"Elm\"},"
+                                   "{\"segments\":2,\"value\":\"Main\"}]");
+
+  // payloads by value, e.g. whether the street is a main street
+  buffer.clear();
+  auto const main_streets = route::annotate(
+      route, [&](EdgeID eid) { return graph.payload(eid) == "Main"; }, writer);
+  BOOST_CHECK_EQUAL(main_streets, 3);
+  BOOST_CHECK_EQUAL(buffer.view(), "[{\"segments\":2,\"value\":true},"
+                                   "{\"segments\":1,\"value\":false},"
+                                   "{\"segments\":2,\"value\":true}]");
+
+  buffer.clear();
+  BOOST_CHECK_EQUAL(route::annotate(route::Route<int>{},
+                                    [](EdgeID) { return 1; }, writer),
+                    0);
+  BOOST_CHECK_EQUAL(buffer.view(), "[]");
+}
+
+BOOST_AUTO_TEST_CASE(binary_runs) {
+  std::vector<std::string> const names = {"A", "A", "A", "Bb"};
+  char memory[64];
+  route::OutputBuffer buffer(memory, sizeof(memory));
+  route::BinaryAnnotationWriter writer(buffer);
+  route::annotate(
+      route_along(4), [&](EdgeID eid) -> auto const & { return names[eid]; },
+      writer);
+  BOOST_CHECK_EQUAL(buffer.view(), std::string("\x03\x01"
+                                               "A"
+                                               "\x01\x02"
+                                               "Bb"));
+
+  std::vector<std::uint16_t> const classes = {7, 7, 300, 300};
+  buffer.clear();
+  route::annotate(
+      route_along(4), [&](EdgeID eid) -> auto const & { return classes[eid]; },
+      writer);
+  BOOST_REQUIRE_EQUAL(buffer.size(), 6);
+  BOOST_CHECK_EQUAL(memory[0], 2);
+  BOOST_CHECK_EQUAL(memory[3], 2);
+  std::uint16_t second;
+  std::memcpy(&second, memory + 4, sizeof(second));
+  BOOST_CHECK_EQUAL(second, 300);
+}
+
+BOOST_AUTO_TEST_CASE(escaping_and_overflow) {
+  std::vector<std::string> const names = {"say \"hi\"\\\n"};
+  char memory[64];
+  route::OutputBuffer buffer(memory, sizeof(memory));
+  route::JsonAnnotationWriter writer(buffer);
+  route::annotate(
+      route_along(1), [&](EdgeID eid) -> auto const & { return names[eid]; },
+      writer);
+  BOOST_CHECK_EQUAL(buffer.view(), "[{\"segments\":1,\"value\":"
+                                   "\"say \\\"hi\\\"\\\\\\u000a\"}]");
+  BOOST_CHECK(!buffer.overflowed());
+
+  char small[16];
+  route::OutputBuffer small_buffer(small, sizeof(small));
+  route::JsonAnnotationWriter small_writer(small_buffer);
+  route::annotate(
+      route_along(1), [&](EdgeID eid) -> auto const & { return names[eid]; },
+      small_writer);
+  BOOST_CHECK(small_buffer.overflowed());
+  BOOST_CHECK_LE(small_buffer.size(), sizeof(small));
+}
+
+BOOST_AUTO_TEST_CASE(no_allocations) {
+  std::vector<std::string> names;
+  for (int street = 0; street < 100; ++street)
+    names.push_back("A street with a name too long for small strings " +
+                    std::to_string(street));
+  auto const route = route_along(10000);
+  std::vector<char> memory(1 << 20);
+  route::OutputBuffer buffer(memory.data(), memory.size());
+  route::JsonAnnotationWriter writer(buffer);
+
+  auto const before = allocations;
+  auto const runs = route::annotate(
+      route,
+      [&](EdgeID eid) -> auto const & { return names[eid / 100]; }, writer);
+  BOOST_CHECK_EQUAL(allocations, before);
+  BOOST_CHECK_EQUAL(runs, 100);
+  BOOST_CHECK(!buffer.overflowed());
+}
@@ -0,0 +1,101 @@
+#include "graph/id.hpp"
+#include "graph/routing.hpp"
+#include "route/compact_route.hpp"
+#include "route/route.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE CompactRoute
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+template <typename weight_type>
+void check_equal(route::Route<weight_type> const &lhs,
+                 route::Route<weight_type> const &rhs) {
+  BOOST_REQUIRE_EQUAL(lhs.segments.size(), rhs.segments.size());
+  for (std::size_t index = 0; index < lhs.segments.size(); ++index) {
+    BOOST_CHECK_EQUAL(lhs.segments[index].edge_id, rhs.segments[index].edge_id);
+    BOOST_CHECK(lhs.segments[index].weight_at_end ==
+                rhs.segments[index].weight_at_end);
+  }
+}
+
+// a long route along edges with close IDs
+route::Route<int> random_route(std::mt19937 &generator,
+                               std::size_t const length) {
+  std::uniform_int_distribution<int> step(-50, 50);
+  std::uniform_int_distribution<int> weight(1, 100);
+  route::Route<int> route;
+  EdgeID edge = 1000000;
+  int total = 0;
+  for (std::size_t segment = 0; segment < length; ++segment) {
+    edge += step(generator);
+    total += weight(generator);
+    route.segments.push_back({total, edge});
+  }
+  return route;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(round_trip) {
+  std::mt19937 generator(42);
+  auto const route = random_route(generator, 5000);
+  route::CompactRoute<int> const compact(route);
+  BOOST_CHECK_EQUAL(compact.size(), route.segments.size());
+  check_equal(compact.decode(), route);
+  // two bytes per difference for most segments
+  BOOST_CHECK_LT(compact.bytes().size(), 4 * route.segments.size() + 8);
+
+  std::size_t visited = 0;
+  compact.for_each([&](auto const &segment) {
+    BOOST_CHECK_EQUAL(segment.edge_id, route.segments[visited].edge_id);
+    ++visited;
+  });
+  BOOST_CHECK_EQUAL(visited, route.segments.size());
+}
+
+BOOST_AUTO_TEST_CASE(extreme_values) {
+  route::Route<std::int64_t> route;
+  auto const max_edge = std::numeric_limits<EdgeID>::max();
+  auto const min_weight = std::numeric_limits<std::int64_t>::min();
+  auto const max_weight = std::numeric_limits<std::int64_t>::max();
+  route.segments = {{0, max_edge}, {min_weight, 0}, {max_weight, max_edge},
+                    {-1, 1}};
+  check_equal(route::CompactRoute<std::int64_t>(route).decode(), route);
+
+  route::CompactRoute<int> empty(route::Route<int>{});
+  BOOST_CHECK(empty.empty());
+  BOOST_CHECK(empty.decode().segments.empty());
+}
+
+BOOST_AUTO_TEST_CASE(other_weights) {
+  route::Route<graph::WeightTimeDistance> routing;
+  routing.segments = {{{10, 12, 100}, 5}, {{15, 20, 180}, 6}};
+  check_equal(route::CompactRoute<graph::WeightTimeDistance>(routing).decode(),
+              routing);
+
+  route::Route<double> verbatim;
+  verbatim.segments = {{0.5, 3}, {1.25, 2}};
+  check_equal(route::CompactRoute<double>(verbatim).decode(), verbatim);
+}
+
+BOOST_AUTO_TEST_CASE(reuse) {
+  std::mt19937 generator(7);
+  route::CompactRoute<int> compact(random_route(generator, 100));
+  auto const short_route = random_route(generator, 10);
+  compact.encode(short_route);
+  BOOST_CHECK_EQUAL(compact.size(), 10);
+
+  route::Route<int> decoded = random_route(generator, 50);
+  auto const capacity = decoded.segments.capacity();
+  compact.decode(decoded);
+  check_equal(decoded, short_route);
+  BOOST_CHECK_EQUAL(decoded.segments.capacity(), capacity);
+}
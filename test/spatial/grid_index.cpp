@@ -0,0 +1,269 @@
+#include "spatial/grid_index.hpp"
+#include "builder/graph.hpp"
+#include "geometry/coordinate.hpp"
+#include "graph/forward_star.hpp"
+#include "graph/routing.hpp"
+#include "io/file.hpp"
+#include "io/section.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// make sure we get a new main function here
+#define BOOST_TEST_MODULE GridIndex
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+using namespace project_x;
+
+namespace {
+geometry::WGS84FixedCoorinate make_coordinate(std::int32_t const latitude,
+                                              std::int32_t const longitude) {
+  return {geometry::FixedWGSLatitude{latitude},
+          geometry::FixedWGSLongitude{longitude}};
+}
+
+struct Network {
+  std::vector<geometry::WGS84FixedCoorinate> coordinates;
+  std::vector<spatial::IndexedEdge> edges;
+};
+
+// short random segments around a center, as in a road network
+Network random_network(std::mt19937 &generator, std::int32_t const latitude,
+                       std::int32_t const longitude) {
+  std::uniform_int_distribution<std::int32_t> position(-20000, 20000);
+  std::uniform_int_distribution<std::int32_t> offset(-800, 800);
+  Network network;
+  for (std::uint64_t edge = 0; edge < 2000; ++edge) {
+    auto const lat = latitude + position(generator);
+    auto const lon = longitude + position(generator);
+    network.coordinates.push_back(make_coordinate(lat, lon));
+    network.coordinates.push_back(
+        make_coordinate(lat + offset(generator), lon + offset(generator)));
+    network.edges.push_back({edge, 2 * edge, 2 * edge + 1});
+  }
+  return network;
+}
+
+std::vector<spatial::Candidate>
+brute_force(Network const &network,
+            geometry::WGS84FixedCoorinate const coordinate,
+            std::size_t const k) {
+  // cells this large hold all edges (one per quadrant), the search visits
+  // every edge
+  spatial::GridIndex const all(network.coordinates, network.edges, 1,
+                               1 << 30);
+  BOOST_CHECK_LE(all.number_of_cells(), 4);
+  return all.nearest(coordinate, k);
+}
+
+void check_equal(std::vector<spatial::Candidate> const &lhs,
+                 std::vector<spatial::Candidate> const &rhs) {
+  BOOST_REQUIRE_EQUAL(lhs.size(), rhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    BOOST_CHECK_EQUAL(lhs[i].edge, rhs[i].edge);
+    BOOST_CHECK_CLOSE(lhs[i].distance, rhs[i].distance, 1e-9);
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(snapping) {
+  // a single edge along the equator, from 0.0 to 0.01 degrees longitude
+  spatial::GridIndex const index(
+      {make_coordinate(0, 0), make_coordinate(0, 1000)}, {{7, 0, 1}}, 2, 100);
+  BOOST_CHECK_EQUAL(index.number_of_edges(), 1);
+  BOOST_CHECK_EQUAL(index.number_of_cells(), 11);
+
+  auto const candidates = index.nearest(make_coordinate(50, 250), 3);
+  BOOST_REQUIRE_EQUAL(candidates.size(), 1);
+  auto const &candidate = candidates.front();
+  BOOST_CHECK_EQUAL(candidate.edge, 7);
+  BOOST_CHECK_EQUAL(candidate.source, 0);
+  BOOST_CHECK_EQUAL(candidate.target, 1);
+  BOOST_CHECK_EQUAL(candidate.projected.latitude.base(), 0);
+  BOOST_CHECK_EQUAL(candidate.projected.longitude.base(), 250);
+  BOOST_CHECK_CLOSE(candidate.ratio, 0.25, 1e-9);
+  // 0.0005 degrees latitude
+  BOOST_CHECK_CLOSE(candidate.distance, 55.6, 0.5);
+
+  // beyond the ends, the closest point is the node itself
+  auto const before = index.nearest(make_coordinate(0, -300), 1).front();
+  BOOST_CHECK_EQUAL(before.ratio, 0.0);
+  BOOST_CHECK_EQUAL(before.projected.longitude.base(), 0);
+
+  BOOST_CHECK(index.nearest(make_coordinate(50, 250), 1, 10.0).empty());
+  BOOST_CHECK(index.nearest(make_coordinate(50, 250), 0).empty());
+  BOOST_CHECK(spatial::GridIndex().nearest(make_coordinate(0, 0), 1).empty());
+  BOOST_CHECK_THROW(spatial::GridIndex({make_coordinate(0, 0)}, {{0, 0, 1}}),
+                    std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(matches_brute_force) {
+  std::mt19937 generator(42);
+  // around the origin, cells with negative rows and columns are involved
+  for (auto const center :
+       {make_coordinate(0, 0), make_coordinate(5250000, 1340000),
+        make_coordinate(-3390000, -7060000)}) {
+    auto const network = random_network(
+        generator, center.latitude.base(), center.longitude.base());
+    for (std::int32_t cell_size : {150, 1000, 7000}) {
+      spatial::GridIndex const index(network.coordinates, network.edges, 4,
+                                     cell_size);
+      std::uniform_int_distribution<std::int32_t> position(-30000, 30000);
+      for (int query = 0; query < 20; ++query) {
+        auto const coordinate =
+            make_coordinate(center.latitude.base() + position(generator),
+                            center.longitude.base() + position(generator));
+        for (std::size_t k : {1, 5, 20})
+          check_equal(index.nearest(coordinate, k),
+                      brute_force(network, coordinate, k));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(max_distance) {
+  std::mt19937 generator(7);
+  auto const network = random_network(generator, 0, 0);
+  spatial::GridIndex const index(network.coordinates, network.edges);
+  auto const coordinate = make_coordinate(1234, -4321);
+
+  auto const candidates = index.nearest(coordinate, 5000, 2000.0);
+  BOOST_CHECK(!candidates.empty());
+  BOOST_CHECK_LT(candidates.size(), network.edges.size());
+  for (auto const &candidate : candidates)
+    BOOST_CHECK_LE(candidate.distance, 2000.0);
+  BOOST_CHECK(std::is_sorted(candidates.begin(), candidates.end(),
+                             [](auto const &lhs, auto const &rhs) {
+                               return lhs.distance < rhs.distance;
+                             }));
+
+  // every edge closer than the limit is found
+  auto const all = index.nearest(coordinate, network.edges.size());
+  BOOST_CHECK_EQUAL(all.size(), network.edges.size());
+  auto const within = std::count_if(
+      all.begin(), all.end(),
+      [](auto const &candidate) { return candidate.distance <= 2000.0; });
+  BOOST_CHECK_EQUAL(candidates.size(), within);
+}
+
+BOOST_AUTO_TEST_CASE(batches) {
+  std::mt19937 generator(3);
+  auto const network = random_network(generator, 100000, 100000);
+  std::vector<geometry::WGS84FixedCoorinate> queries;
+  std::uniform_int_distribution<std::int32_t> position(70000, 130000);
+  for (int query = 0; query < 100; ++query)
+    queries.push_back(
+        make_coordinate(position(generator), position(generator)));
+
+  // building on a different number of threads results in the same index
+  spatial::GridIndex const sequential(network.coordinates, network.edges, 1);
+  spatial::GridIndex const parallel(network.coordinates, network.edges, 5);
+  BOOST_CHECK_EQUAL(sequential.number_of_cells(), parallel.number_of_cells());
+
+  auto const results = parallel.nearest(queries, 3, 5000.0, 4);
+  BOOST_REQUIRE_EQUAL(results.size(), queries.size());
+  for (std::size_t query = 0; query < queries.size(); ++query)
+    check_equal(results[query], sequential.nearest(queries[query], 3, 5000.0));
+}
+
+BOOST_AUTO_TEST_CASE(serialisation) {
+  std::mt19937 generator(11);
+  auto const network = random_network(generator, -100000, 200000);
+  spatial::GridIndex const index(network.coordinates, network.edges);
+  auto const query = make_coordinate(-101000, 199000);
+  auto const expected = index.nearest(query, 10);
+
+  for (auto const mode : {io::mode::Enum(0), io::mode::mCOMPRESSED}) {
+    {
+      io::File out("grid_index.tmp",
+                   io::mode::mWRITE | io::mode::mBINARY | mode);
+      index.serialise(out);
+    }
+    spatial::GridIndex read;
+    io::File in("grid_index.tmp", io::mode::mREAD | io::mode::mBINARY | mode);
+    read.deserialise(in);
+    BOOST_CHECK_EQUAL(read.number_of_cells(), index.number_of_cells());
+    check_equal(read.nearest(query, 10), expected);
+  }
+
+  {
+    io::SectionWriter writer("grid_index.tmp");
+    index.serialise(writer);
+  }
+  io::SectionReader reader("grid_index.tmp");
+  BOOST_CHECK(reader.contains("spatial_index.cell_edges"));
+  spatial::GridIndex read;
+  read.deserialise(reader);
+  check_equal(read.nearest(query, 10), expected);
+  std::remove("grid_index.tmp");
+}
+
+BOOST_AUTO_TEST_CASE(locations) {
+  spatial::Candidate candidate;
+  candidate.source = 3;
+  candidate.target = 4;
+  candidate.ratio = 0.25;
+
+  auto const source = spatial::source_location(candidate, std::uint32_t(100));
+  BOOST_CHECK_EQUAL(source.node, 4);
+  BOOST_CHECK_EQUAL(source.offset, 75);
+  auto const target = spatial::target_location(candidate, 100.0);
+  BOOST_CHECK_EQUAL(target.node, 3);
+  BOOST_CHECK_CLOSE(target.offset, 25.0, 1e-9);
+
+  auto const cost = spatial::source_location(
+      candidate, graph::WeightTimeDistance{100, 40, 10});
+  BOOST_CHECK_EQUAL(cost.offset.weight, 75);
+  BOOST_CHECK_EQUAL(cost.offset.time, 30);
+  BOOST_CHECK_EQUAL(cost.offset.distance, 8);
+}
+
+BOOST_AUTO_TEST_CASE(built_by_builder) {
+  using Edge = builder::Edge<std::uint32_t>;
+  builder::Graph<Edge> builder;
+  builder.add_edge(30, 10, 1u);
+  builder.add_edge(10, 20, 2u);
+  builder.add_edge(20, 30, 3u);
+  builder.add_edge(10, 30, 4u);
+
+  std::vector<std::uint64_t> const ids = {10, 20, 30, 40};
+  std::vector<geometry::WGS84FixedCoorinate> const coordinates = {
+      make_coordinate(0, 0), make_coordinate(0, 1000),
+      make_coordinate(1000, 1000), make_coordinate(5000, 5000)};
+  BOOST_CHECK_THROW(builder.build_spatial_index_and_store("index.tmp"),
+                    std::logic_error);
+  builder.add_coordinates(ids.size(), ids.data(), coordinates.data());
+  builder.build_spatial_index_and_store("index.tmp", 2);
+  builder.build_graph_and_store("graph.tmp");
+
+  spatial::GridIndex index;
+  {
+    io::File in("index.tmp",
+                io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+    index.deserialise(in);
+  }
+  graph::ForwardStar graph;
+  {
+    io::File in("graph.tmp",
+                io::mode::mREAD | io::mode::mBINARY | io::mode::mVERSIONED);
+    graph.deserialise(in);
+  }
+  BOOST_CHECK_EQUAL(index.number_of_edges(), graph.number_of_edges());
+
+  // the edge between 10 and 20 (nodes 1 and 2) runs along the equator, its ID
+  // matches the stored graph
+  auto const candidate = index.nearest(make_coordinate(-10, 500), 1).front();
+  BOOST_CHECK_EQUAL(candidate.source, 1);
+  BOOST_CHECK_EQUAL(candidate.target, 2);
+  BOOST_CHECK_EQUAL(candidate.edge,
+                    graph.edge_id(graph.edges_begin(candidate.source)));
+  BOOST_CHECK_EQUAL(*(graph.edges_begin() + candidate.edge), 2);
+  BOOST_CHECK_CLOSE(candidate.ratio, 0.5, 1e-9);
+  std::remove("index.tmp");
+  std::remove("graph.tmp");
+}